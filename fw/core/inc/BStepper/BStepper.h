@@ -28,6 +28,22 @@ class BStepper {
     Translator::Pinout ph;
   };
 
+  /* DMA design forces to use advanced timers, which are 16 bit only */
+  using TimRegType = uint16_t;
+  using TimRCRType = uint8_t;
+
+  /* Register image of a rotation, ready to be loaded into the timer */
+  struct Plan {
+    TimRegType psc;
+    TimRegType arr;
+    TimRCRType rcr;        /* RCR loaded before starting */
+    TimRCRType hw_reps;    /* Repetitions after the software-counted ones */
+    StepCountType sw_reps; /* Software-counted repetitions (0 if none) */
+    StepCountType steps;   /* 0 for an invalid plan */
+    Direction direction;
+    StepType type;
+  };
+
   BStepper(GPIO_TypeDef *gpio, TIM_TypeDef *tim, DMA_TypeDef *dma);
   void handler();
 
@@ -44,14 +60,17 @@ class BStepper {
   void enable() const;
   void disable() const;
 
+  /* A rotation is in progress */
+  bool isBusy() const;
+
+  bool compile(StepCountType steps, SpeedType milli_rev_per_minute, Direction d,
+               Plan &p, StepType t = FULL) const;
+
   bool rotate(StepCountType steps, SpeedType milli_rev_per_minute, Direction d,
               bool block = false, StepType t = FULL);
+  bool rotate(const Plan &p, bool block = false);
 
  private:
-  /* DMA design forces to use advanced timers, which are 16 bit only */
-  using TimRegType = uint16_t;
-  using TimRCRType = uint8_t;
-
   bool calcTimeBase(SpeedType milli_rev_per_minute, StepType t, TimRegType &psc,
                     TimRegType &arr) const;
 
@@ -8,6 +8,8 @@
 #ifndef CALLBACKUTILS_HPP
 #define CALLBACKUTILS_HPP
 
+#include "ramfunc.h"
+
 template <typename Fn> struct ICallback;
 
 template <typename R, typename... Args>
@@ -30,8 +32,10 @@ template <typename R, typename... Args>
 struct FnCallback<R(Args...)> : ICallback<R(Args...)> {
   using Fn = R (*)(Args...);
   explicit FnCallback(Fn fn = nullptr) : _fn(fn) {}
-  bool empty() const override { return !_fn; }
-  R operator()(Args... args) const override { return (*_fn)(args...); }
+
+  /* Invoked by interrupt handlers */
+  RAMFUNC bool empty() const override { return !_fn; }
+  RAMFUNC R operator()(Args... args) const override { return (*_fn)(args...); }
 
 private:
   Fn _fn;
@@ -47,8 +51,10 @@ struct MemFnCallback<C, R(Args...)> : ICallback<R(Args...)> {
   using MemFn = R (C::*)(Args...);
   explicit MemFnCallback(C *that = nullptr, MemFn mem_fn = nullptr)
       : _that(that), _mem_fn(mem_fn) {}
-  bool empty() const override { return !_that || !_mem_fn; }
-  R operator()(Args... args) const override {
+
+  /* Invoked by interrupt handlers */
+  RAMFUNC bool empty() const override { return !_that || !_mem_fn; }
+  RAMFUNC R operator()(Args... args) const override {
     return (_that->*_mem_fn)(args...);
   }
 
@@ -0,0 +1,35 @@
+/**
+ * @file     FixedString.hpp
+ * @author   Fabio Scatozza <s315216@studenti.polito.it>
+ * @date     18.10.2026
+ * @brief    String literal usable as a non-type template argument
+ */
+
+#ifndef FIXEDSTRING_HPP
+#define FIXEDSTRING_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <string_view>
+
+template <std::size_t N>
+struct FixedString {
+  /* Implicit: "name" deduces FixedString<5> */
+  constexpr FixedString(const char (&s)[N]) { std::copy_n(s, N, str); }
+
+  constexpr std::size_t size() const { return N - 1; }
+  constexpr const char *c_str() const { return str; }
+  constexpr std::string_view view() const { return {str, N - 1}; }
+
+  template <std::size_t M>
+  constexpr FixedString<N + M - 1> operator+(const FixedString<M> &rhs) const {
+    char s[N + M - 1]{};
+    std::copy_n(str, N - 1, s);
+    std::copy_n(rhs.str, M, s + N - 1);
+    return s;
+  }
+
+  char str[N]{};
+};
+
+#endif // FIXEDSTRING_HPP
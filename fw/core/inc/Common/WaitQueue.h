@@ -0,0 +1,41 @@
+/**
+ * @file     WaitQueue.h
+ * @author   Fabio Scatozza <s315216@studenti.polito.it>
+ * @date     18.10.2026
+ *
+ * Sleep in thread mode until an ISR signals an event. The only waiter is the
+ * thread mode itself: a wakeup posted while it is not sleeping is kept, and
+ * consumed by the next sleep(), so none is lost.
+ */
+
+#ifndef WAITQUEUE_H
+#define WAITQUEUE_H
+
+#include "ramfunc.h"
+#include "stm32f4xx.h"
+
+class WaitQueue {
+public:
+  /* From ISRs */
+  RAMFUNC void wake() { _pending = true; }
+
+  /* Sleep (WFI) through interrupts not posting a wakeup */
+  void sleep() {
+    /* Interrupts masked between the check and WFI, which still wakes on
+     * them: they are served right after */
+    __disable_irq();
+    while (!_pending) {
+      __WFI();
+      __enable_irq();
+      __ISB();
+      __disable_irq();
+    }
+    _pending = false;
+    __enable_irq();
+  }
+
+private:
+  volatile bool _pending = false;
+};
+
+#endif // WAITQUEUE_H
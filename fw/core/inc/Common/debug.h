@@ -8,26 +8,50 @@
 #define DEBUG_H
 
 #include <cinttypes>
-#include <cstdarg>
 #include <cstdio>
 #include <source_location>
 
-/* Injects std::source_location::current() at the callee site */
+#include "Format.hpp"
+#include "uio.h"
+
+/*
+ * Injects std::source_location::current() at the callee site. fmt is a
+ * string literal, parsed at compile time (see Format.hpp)
+ */
 #define PRINTD(fmt, ...)                                                       \
-  print_impl(std::source_location::current(), stdout, fmt, ##__VA_ARGS__)
+  print_impl<fmt>(std::source_location::current(), stdout, ##__VA_ARGS__)
 #define PRINTE(fmt, ...)                                                       \
-  print_impl(std::source_location::current(), stderr, fmt, ##__VA_ARGS__)
+  print_impl<fmt>(std::source_location::current(), stderr, ##__VA_ARGS__)
+
+template <FixedString FMT, typename... Args>
+inline void print_impl([[maybe_unused]] const std::source_location &loc,
+                       [[maybe_unused]] FILE *stream,
+                       [[maybe_unused]] const Args &...args) {
+  static constexpr auto LINE =
+      FixedString("%s: line %" PRIuLEAST32 ":\r\n%s:\r\n\t") + FMT +
+      FixedString("\r\n\n");
 
-constexpr void print_impl(const std::source_location &loc, FILE *stream,
-                           const char *fmt, ...) {
 #if defined(DEBUG) && (PRINT_ENABLE != 0U)
-  fprintf(stream, "%s: line %" PRIuLEAST32 ":\r\n%s:\r\n\t", loc.file_name(),
-          loc.line(), loc.function_name());
-  va_list args;
-  va_start(args, fmt);
-  vfprintf(stream, fmt, args);
-  fprintf(stream, "\r\n\n");
-  va_end(args);
+  /* Format straight into the buffer lent by the driver, if it fits */
+  void *loan;
+  fflush(stream);
+  if (auto size = writebuf_acquire(fileno(stream), &loan, BUFSIZ); size > 0) {
+    const auto len =
+        fmt::format<LINE>(static_cast<char *>(loan), size, loc.file_name(),
+                          loc.line(), loc.function_name(), args...);
+    if (len <= static_cast<size_t>(size)) {
+      writebuf_commit(fileno(stream), len);
+      return;
+    }
+    writebuf_commit(fileno(stream), 0);
+  }
+
+  fmt::print<LINE>(stream, loc.file_name(), loc.line(), loc.function_name(),
+                   args...);
+#else
+  /* Checked against the arguments all the same */
+  static_cast<void>(fmt::maxLength<LINE, const char *, uint_least32_t,
+                                   const char *, Args...>());
 #endif // DEBUG
 }
 
@@ -0,0 +1,24 @@
+/**
+ * @file     dwt.h
+ * @author   Fabio Scatozza <s315216@studenti.polito.it>
+ * @date     18.10.2026
+ */
+
+#ifndef DWT_H
+#define DWT_H
+
+#include "stm32f4xx.h"
+
+namespace dwt {
+
+/* Start the free-running core cycle counter */
+void init();
+
+inline uint32_t getCycles() { return DWT->CYCCNT; }
+
+/* Elapsed time since start, assuming fewer than 2^32 cycles have passed */
+uint32_t toMicros(uint32_t start);
+
+} // namespace dwt
+
+#endif // DWT_H
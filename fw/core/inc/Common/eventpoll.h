@@ -8,8 +8,14 @@
 #ifndef EVENTPOLL_H
 #define EVENTPOLL_H
 
+#include <stdint.h>
 #include <types.h>
 
+/* Valid opcodes to issue to epoll_ctl() */
+#define EPOLL_CTL_ADD 1
+#define EPOLL_CTL_DEL 2
+#define EPOLL_CTL_MOD 3
+
 /* Epoll event masks */
 #define EPOLLIN		(__poll_t)0x00000001
 #define EPOLLPRI	(__poll_t)0x00000002
@@ -24,5 +30,29 @@
 #define EPOLLMSG	(__poll_t)0x00000400
 #define EPOLLRDHUP	(__poll_t)0x00002000
 
+/* Set the One Shot behaviour for the target file descriptor */
+#define EPOLLONESHOT	((__poll_t)(1U << 30))
+
+/* Set the Edge Triggered behaviour for the target file descriptor */
+#define EPOLLET		((__poll_t)(1U << 31))
+
+struct epoll_event {
+  __poll_t events;
+  uint64_t data;
+};
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Implemented in syscalls.cpp */
+int epoll_create1(int flags);
+int epoll_ctl(int epfd, int op, int fd, struct epoll_event *event);
+int epoll_wait(int epfd, struct epoll_event *events, int maxevents,
+               int timeout);
+
+#ifdef __cplusplus
+}
+#endif
 
 #endif //EVENTPOLL_H
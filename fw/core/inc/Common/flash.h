@@ -9,6 +9,8 @@
 
 #include "stm32f4xx.h"
 #include <cstddef>
+#include <cstring>
+#include <type_traits>
 
 namespace flash {
 
@@ -108,9 +110,27 @@ inline bool setParallelism(const PSize &p) {
 void setSector(const Sector &s);
 
 void setOperation(const Op &op);
+/* Wait for the end of the operation, running from RAM */
 void startErase();
 void clearOperation();
 
+/* Write the low size bytes of data at addr, and wait for the end of the
+ * operation. The operation must be PG, with parallelism matching size */
+void programAt(uintptr_t addr, uint32_t data, size_t size);
+
+/* Program t over dst, which must be in flash */
+template <typename T>
+void program(const T &dst, const T &t) {
+  static_assert(sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4);
+  static_assert(std::is_trivially_copyable_v<T>);
+
+  uint32_t data = 0;
+  std::memcpy(&data, &t, sizeof(T));
+
+  setParallelism(t);
+  programAt(reinterpret_cast<uintptr_t>(&dst), data, sizeof(T));
+}
+
 } // namespace flash
 
 #endif // FLASH_H
@@ -0,0 +1,44 @@
+/**
+ * @file     fmstats.h
+ * @author   Fabio Scatozza <s315216@studenti.polito.it>
+ * @date     18.10.2026
+ *
+ * Layout of the "stats" node of the FileManager, built with the FM_STATS
+ * option: one struct fm_node_stats per node, in the order they are
+ * registered, so that a single fread() of the file size dumps them all.
+ * fmap() with PROT_READ exposes the live table instead, without copies.
+ * Opening it with O_TRUNC clears the counters.
+ */
+
+#ifndef FMSTATS_H
+#define FMSTATS_H
+
+#include <stdint.h>
+
+/* System calls accounted to the nodes */
+#define FM_STATS_OPEN   0
+#define FM_STATS_READ   1 /* readv() included */
+#define FM_STATS_WRITE  2 /* writev() included */
+#define FM_STATS_POLL   3 /* On behalf of select() */
+#define FM_STATS_SELECT 4 /* Whole select() calls watching the node */
+#define FM_STATS_NOPS   5
+
+#define FM_STATS_NBINS    32
+#define FM_STATS_NAME_LEN 16
+
+struct fm_op_stats {
+  uint32_t calls;
+  uint32_t errors; /* Negative returns, but -EAGAIN; POLLERR for polls */
+  uint32_t eagain; /* -EAGAIN; for select(), returns with the node not ready */
+  uint32_t max_cycles;
+  uint64_t bytes;
+  /* hist[i] counts the latencies in [2^(i - 1), 2^i) core cycles */
+  uint32_t hist[FM_STATS_NBINS];
+};
+
+struct fm_node_stats {
+  char name[FM_STATS_NAME_LEN]; /* Null-terminated, possibly truncated */
+  struct fm_op_stats ops[FM_STATS_NOPS];
+};
+
+#endif // FMSTATS_H
@@ -0,0 +1,84 @@
+/**
+ * @file     ioctl.h
+ * @author   Fabio Scatozza <s315216@studenti.polito.it>
+ * @date     18.10.2026
+ * @see      https://github.com/torvalds/linux/blob/master/include/uapi/asm-generic/ioctl.h
+ *
+ * Request codes carry the direction and the size of the argument, which is
+ * passed by pointer. Each driver owns a type letter.
+ */
+
+#ifndef IOCTL_H
+#define IOCTL_H
+
+#include <stdint.h>
+
+#ifndef _IOC
+#define _IOC_NRBITS	8
+#define _IOC_TYPEBITS	8
+#define _IOC_SIZEBITS	14
+
+#define _IOC_NRSHIFT	0
+#define _IOC_TYPESHIFT	(_IOC_NRSHIFT + _IOC_NRBITS)
+#define _IOC_SIZESHIFT	(_IOC_TYPESHIFT + _IOC_TYPEBITS)
+#define _IOC_DIRSHIFT	(_IOC_SIZESHIFT + _IOC_SIZEBITS)
+
+#define _IOC_NONE	0U
+#define _IOC_WRITE	1U
+#define _IOC_READ	2U
+
+#define _IOC(dir, type, nr, size)                                              \
+  (((dir) << _IOC_DIRSHIFT) | ((type) << _IOC_TYPESHIFT) |                     \
+   ((nr) << _IOC_NRSHIFT) | ((size) << _IOC_SIZESHIFT))
+
+#define _IO(type, nr)		_IOC(_IOC_NONE, (type), (nr), 0)
+#define _IOR(type, nr, arg)	_IOC(_IOC_READ, (type), (nr), sizeof(arg))
+#define _IOW(type, nr, arg)	_IOC(_IOC_WRITE, (type), (nr), sizeof(arg))
+#define _IOWR(type, nr, arg)                                                   \
+  _IOC(_IOC_READ | _IOC_WRITE, (type), (nr), sizeof(arg))
+
+#define _IOC_DIR(nr)	(((nr) >> _IOC_DIRSHIFT) & ((1U << 2) - 1))
+#define _IOC_TYPE(nr)	(((nr) >> _IOC_TYPESHIFT) & ((1U << _IOC_TYPEBITS) - 1))
+#define _IOC_NR(nr)	(((nr) >> _IOC_NRSHIFT) & ((1U << _IOC_NRBITS) - 1))
+#define _IOC_SIZE(nr)	(((nr) >> _IOC_SIZESHIFT) & ((1U << _IOC_SIZEBITS) - 1))
+#endif
+
+/* UartTx: baud rate [bit/s] */
+#define UART_IOC_GBAUD	_IOR('U', 1, uint32_t)
+#define UART_IOC_SBAUD	_IOW('U', 2, uint32_t)
+
+/* SSegDisplay: scroll timing, applied to an ongoing scroll as well */
+struct sseg_scroll {
+  uint32_t delay_ms;
+  uint32_t min_times;
+};
+
+#define SSEG_IOC_GSCROLL	_IOR('S', 1, struct sseg_scroll)
+#define SSEG_IOC_SSCROLL	_IOW('S', 2, struct sseg_scroll)
+
+/* Keyboard: upper bound to the SPI clock [Hz] */
+#define KBD_IOC_SFCLK	_IOW('K', 1, uint32_t)
+
+/* LTC2308: upper bound to the SPI clock [Hz], and conversion options */
+struct adc_cfg {
+  uint8_t single_ended; /* Or differential */
+  uint8_t channel;      /* Positive input, 0 to 7 */
+  uint8_t unipolar;     /* Or bipolar */
+  uint8_t low_power;    /* Sleep between read() calls */
+};
+
+#define ADC_IOC_SFCLK	_IOW('A', 1, uint32_t)
+#define ADC_IOC_SCFG	_IOW('A', 2, struct adc_cfg)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Implemented in syscalls.cpp */
+int ioctl(int fd, unsigned long request, ...);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IOCTL_H
@@ -0,0 +1,64 @@
+/**
+ * @file     ioring.h
+ * @author   Fabio Scatozza <s315216@studenti.polito.it>
+ * @date     18.10.2026
+ * @see      https://github.com/torvalds/linux/blob/master/include/uapi/linux/io_uring.h
+ *
+ * Asynchronous I/O (non-standard), after io_uring: read and write requests
+ * are queued with io_ring_submit(), and their results reaped later with
+ * io_ring_wait(), oldest first as they complete. A request that would block
+ * is retried when its node notifies, e.g. from the transfer-complete
+ * interrupt, while the caller goes on. Requests on the same file descriptor
+ * are carried out in submission order; each is a single read() or write(),
+ * so counts may be short. The buffer must stay valid until the completion is
+ * reaped.
+ */
+
+#ifndef IORING_H
+#define IORING_H
+
+#include <stdint.h>
+
+/* In-flight requests, completed or not, until they are reaped */
+#define IORING_ENTRIES 8
+
+#define IORING_OP_NOP   0
+#define IORING_OP_READ  1
+#define IORING_OP_WRITE 2
+
+/* Submission queue entry */
+struct io_sqe {
+  uint8_t opcode;
+  int32_t fd;
+  void *buf;
+  uint32_t len;
+  uint64_t user_data; /* Returned with the completion */
+};
+
+/* Completion queue entry */
+struct io_cqe {
+  uint64_t user_data;
+  int32_t res; /* As returned by read() or write(), -errno on error */
+};
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Implemented in syscalls.cpp */
+
+/* Queue up to nr requests: returns how many were, EBUSY if the ring is full */
+int io_ring_submit(const struct io_sqe *sqes, unsigned nr);
+
+/*
+ * Reap up to max completions, waiting for at least min of them, bounded by
+ * those in flight, for timeout ms (negative blocks indefinitely)
+ */
+int io_ring_wait(struct io_cqe *cqes, unsigned min, unsigned max,
+                 int timeout);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IORING_H
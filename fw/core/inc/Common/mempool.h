@@ -0,0 +1,41 @@
+/**
+ * @file     mempool.h
+ * @author   Fabio Scatozza <s315216@studenti.polito.it>
+ * @date     18.10.2026
+ *
+ * Deterministic RAM layout. The stdio buffers and the driver objects, holding
+ * their DMA staging buffers, are statically allocated in the POOL, which the
+ * linker sizes and zero fills with .bss. What is left for newlib (FILE
+ * structures, dtoa) comes from a heap arena of HEAP_SIZE bytes, rather than
+ * growing towards the stack; the stack takes the remaining RAM, and the link
+ * fails unless it is at least MIN_STACK_SIZE (see stm32f401xe.ld).
+ * Both record their high-water marks: the heap through _sbrk(), the stack by
+ * painting it at reset and finding the deepest overwritten word.
+ */
+
+#ifndef MEMPOOL_H
+#define MEMPOOL_H
+
+#include <cstddef>
+
+#define POOL [[gnu::section(".bss.pool")]]
+
+namespace mempool {
+
+/* From Reset_Handler, before anything is pushed beyond its frame */
+void paintStack();
+
+/* Move the heap end, as _sbrk(): nullptr past the arena */
+void *sbrk(ptrdiff_t incr);
+
+size_t poolSize();
+size_t heapSize();
+size_t stackSize();
+
+/* Deepest use since reset */
+size_t heapHighWater();
+size_t stackHighWater();
+
+} // namespace mempool
+
+#endif // MEMPOOL_H
@@ -0,0 +1,38 @@
+/**
+ * @file     mman.h
+ * @author   Fabio Scatozza <s315216@studenti.polito.it>
+ * @date     18.10.2026
+ * @see      https://github.com/torvalds/linux/blob/master/include/uapi/asm-generic/mman-common.h
+ *
+ * Memory-resident content of a node (non-standard), after mmap(2): fmap()
+ * returns its address in *addr, and its length. The content is mapped in
+ * place, thus it is live, and the mapping stays valid until the file
+ * descriptor is closed. PROT_WRITE is granted only by nodes whose content can
+ * be safely modified by the caller.
+ */
+
+#ifndef MMAN_H
+#define MMAN_H
+
+#include <sys/types.h>
+
+#if __has_include(<sys/mman.h>)
+#include <sys/mman.h>
+#else
+#define PROT_NONE  0x0
+#define PROT_READ  0x1
+#define PROT_WRITE 0x2
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Implemented in syscalls.cpp */
+ssize_t fmap(int fd, int prot, void **addr);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MMAN_H
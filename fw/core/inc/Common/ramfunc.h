@@ -0,0 +1,18 @@
+/**
+ * @file     ramfunc.h
+ * @author   Fabio Scatozza <s315216@studenti.polito.it>
+ * @date     18.10.2026
+ *
+ * The flash has a single bank: instruction fetches and data reads stall while
+ * it is programmed or erased. Code that must keep running meanwhile is placed
+ * in .ramfunc, which the startup copies to SRAM, next to the relocated vector
+ * table. Whatever it calls must be RAMFUNC as well, or inlined (the LL and
+ * CMSIS helpers are, with optimizations enabled).
+ */
+
+#ifndef RAMFUNC_H
+#define RAMFUNC_H
+
+#define RAMFUNC [[gnu::section(".ramfunc")]]
+
+#endif // RAMFUNC_H
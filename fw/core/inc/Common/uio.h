@@ -0,0 +1,48 @@
+/**
+ * @file     uio.h
+ * @author   Fabio Scatozza <s315216@studenti.polito.it>
+ * @date     18.10.2026
+ * @see      https://github.com/torvalds/linux/blob/master/include/uapi/linux/uio.h
+ */
+
+#ifndef UIO_H
+#define UIO_H
+
+#include <stddef.h>
+#include <sys/types.h>
+
+#if __has_include(<sys/uio.h>)
+#include <sys/uio.h>
+#else
+struct iovec {
+  void *iov_base; /* BSD uses caddr_t (1003.1g requires void *) */
+  size_t iov_len; /* Must be size_t (1003.1g) */
+};
+#endif
+
+#ifndef UIO_MAXIOV
+#define UIO_MAXIOV 1024
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Implemented in syscalls.cpp */
+ssize_t readv(int fd, const struct iovec *iov, int iovcnt);
+ssize_t writev(int fd, const struct iovec *iov, int iovcnt);
+
+/*
+ * Zero-copy writes (non-standard): the driver lends up to count bytes of its
+ * transfer buffer, which the caller fills in place, then transfers the first
+ * count bytes with writebuf_commit(). The loan ends with the commit, or with
+ * any other write to the file
+ */
+ssize_t writebuf_acquire(int fd, void **buf, size_t count);
+ssize_t writebuf_commit(int fd, size_t count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // UIO_H
@@ -7,12 +7,18 @@
 #ifndef USART_H
 #define USART_H
 
+#include "stm32f4xx_ll_rcc.h"
 #include "stm32f4xx_ll_usart.h"
 
 namespace usart {
 
 void enableClock(USART_TypeDef *usart);
 
+uint32_t getAPBClockFreq(const USART_TypeDef *usart,
+                         LL_RCC_ClocksTypeDef *clocks = nullptr);
+
+IRQn_Type getIRQn(const USART_TypeDef *usart);
+
 }
 
 #endif //USART_H
@@ -0,0 +1,92 @@
+/**
+ * @file     EpItem.h
+ * @author   Fabio Scatozza <s315216@studenti.polito.it>
+ * @date     18.10.2026
+ *
+ * Interest of an epoll instance in an open file. The item is chained to the
+ * watched node, which queues it on the ready list of the instance when it
+ * notifies a readiness change (from interrupt context), so that waiting
+ * costs O(ready) rather than O(watched).
+ */
+
+#ifndef EPITEM_H
+#define EPITEM_H
+
+#include <eventpoll.h>
+
+#include "ramfunc.h"
+#include "stm32f4xx.h"
+
+class IFile;
+struct OFile;
+struct EpReadyList;
+
+struct EpItem {
+  IFile *file; /* nullptr if the item is free */
+  OFile *ofile;
+  int fd;
+  epoll_event event;
+
+  EpReadyList *rdl;
+  EpItem *next_watch; /* Chain of the items of the node */
+  EpItem *next_ready;
+  volatile bool ready; /* On the ready list */
+};
+
+struct EpReadyList {
+  /* From ISRs as well: no-op if the item is already queued */
+  RAMFUNC void push(EpItem &item) {
+    const auto primask = __get_PRIMASK();
+    __disable_irq();
+
+    if (!item.ready) {
+      item.ready = true;
+      item.next_ready = nullptr;
+      if (tail)
+        tail->next_ready = &item;
+      else
+        head = &item;
+      tail = &item;
+    }
+
+    __set_PRIMASK(primask);
+  }
+
+  /*
+   * Detach the whole list. Read next_ready before clearing ready, as the item
+   * may be queued again right after
+   */
+  EpItem *take() {
+    const auto primask = __get_PRIMASK();
+    __disable_irq();
+    auto first = head;
+    head = nullptr;
+    tail = nullptr;
+    __set_PRIMASK(primask);
+    return first;
+  }
+
+  void remove(EpItem &item) {
+    const auto primask = __get_PRIMASK();
+    __disable_irq();
+    if (item.ready) {
+      EpItem *prev = nullptr;
+      for (auto it = head; it != &item; prev = it, it = it->next_ready);
+
+      if (prev)
+        prev->next_ready = item.next_ready;
+      else
+        head = item.next_ready;
+      if (tail == &item) tail = prev;
+      item.ready = false;
+    }
+    __set_PRIMASK(primask);
+  }
+
+  bool empty() const { return !head; }
+
+  EpItem *volatile head = nullptr;
+  EpItem *volatile tail = nullptr;
+};
+
+#endif // EPITEM_H
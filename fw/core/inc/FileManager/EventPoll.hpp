@@ -0,0 +1,68 @@
+/**
+ * @file     EventPoll.hpp
+ * @author   Fabio Scatozza <s315216@studenti.polito.it>
+ * @date     18.10.2026
+ * @see      https://github.com/torvalds/linux/blob/master/fs/eventpoll.c
+ *
+ * Persistent interest list of an epoll instance. Watched nodes queue their
+ * items on the ready list as they notify(); the items are then re-polled,
+ * to report the current readiness, only while queued. Nodes that cannot
+ * notify, having a pollPeriod(), are kept queued and re-polled at each wait,
+ * therefore edge triggering reduces to level triggering for them.
+ */
+
+#ifndef EVENTPOLL_HPP
+#define EVENTPOLL_HPP
+
+#include <array>
+#include <chrono>
+
+#include "EpItem.h"
+#include "IFile.h"
+
+template <size_t NMAX_ITEMS>
+class EventPoll : public IFile {
+ public:
+  /* A single open file per instance */
+  int open(OFile &ofile) override;
+  /* Drops the interest list */
+  int close(OFile &ofile) override;
+  /* Readable while items are queued */
+  __poll_t poll(OFile &ofile) override;
+
+  bool inUse() const;
+
+  /**
+   * @brief Add, modify or remove the interest in an open file
+   * @param op EPOLL_CTL_ADD, EPOLL_CTL_MOD, EPOLL_CTL_DEL
+   * @param fd Identifies the item, with file and ofile it refers to
+   * @param event Ignored by EPOLL_CTL_DEL
+   * @return 0, or -EINVAL, -EEXIST, -ENOENT, -ENOSPC, -EFAULT
+   */
+  int ctl(int op, int fd, IFile &file, OFile &ofile, const epoll_event *event);
+
+  /* The fd is being closed */
+  void forget(int fd);
+
+  /* Report up to maxevents ready items, in O(ready) */
+  int harvest(epoll_event *events, int maxevents);
+
+  /* Shortest pollPeriod() of the watched nodes, or 0 */
+  std::chrono::microseconds period() const;
+
+ private:
+  static constexpr __poll_t EP_PRIVATE_BITS = EPOLLONESHOT | EPOLLET;
+
+  EpItem *_find(int fd);
+  void _drop(EpItem &item);
+  void _updatePeriod();
+
+  std::array<EpItem, NMAX_ITEMS> _items{};
+  EpReadyList _rdl;
+  std::chrono::microseconds _period{};
+  bool _in_use = false;
+};
+
+#include "EventPoll.tpp"
+
+#endif  // EVENTPOLL_HPP
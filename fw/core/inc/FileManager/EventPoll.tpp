@@ -0,0 +1,167 @@
+/**
+ * @file     EventPoll.tpp
+ * @author   Fabio Scatozza <s315216@studenti.polito.it>
+ * @date     18.10.2026
+ */
+
+#ifndef EVENTPOLL_TPP
+#define EVENTPOLL_TPP
+
+#include <algorithm>
+#include <cerrno>
+
+template <size_t NMAX_ITEMS>
+int EventPoll<NMAX_ITEMS>::open([[maybe_unused]] OFile &ofile) {
+  if (_in_use) return -EBUSY;
+
+  _in_use = true;
+  return 0;
+}
+
+template <size_t NMAX_ITEMS>
+int EventPoll<NMAX_ITEMS>::close([[maybe_unused]] OFile &ofile) {
+  for (auto &item : _items)
+    if (item.file) _drop(item);
+
+  _period = {};
+  _in_use = false;
+  return 0;
+}
+
+template <size_t NMAX_ITEMS>
+__poll_t EventPoll<NMAX_ITEMS>::poll([[maybe_unused]] OFile &ofile) {
+  return _rdl.empty() ? 0 : (EPOLLIN | EPOLLRDNORM);
+}
+
+template <size_t NMAX_ITEMS>
+bool EventPoll<NMAX_ITEMS>::inUse() const {
+  return _in_use;
+}
+
+template <size_t NMAX_ITEMS>
+int EventPoll<NMAX_ITEMS>::ctl(int op, int fd, IFile &file, OFile &ofile,
+                               const epoll_event *event) {
+  /* An instance cannot watch itself */
+  if (&file == this) return -EINVAL;
+
+  auto item = _find(fd);
+
+  switch (op) {
+    case EPOLL_CTL_ADD: {
+      if (item) return -EEXIST;
+      if (!event) return -EFAULT;
+
+      auto free_it = std::find_if(_items.begin(), _items.end(),
+                                  [](const EpItem &it) { return !it.file; });
+      if (free_it == _items.end()) return -ENOSPC;
+
+      item = &*free_it;
+      *item = {.file = &file, .ofile = &ofile, .fd = fd, .event = *event,
+               .rdl = &_rdl};
+      item->event.events |= EPOLLERR | EPOLLHUP;
+      file.watch(*item);
+      _updatePeriod();
+
+      /* The current readiness is reported by the next wait */
+      _rdl.push(*item);
+      return 0;
+    }
+
+    case EPOLL_CTL_MOD:
+      if (!item) return -ENOENT;
+      if (!event) return -EFAULT;
+
+      item->event = *event;
+      item->event.events |= EPOLLERR | EPOLLHUP;
+      _rdl.push(*item);
+      return 0;
+
+    case EPOLL_CTL_DEL:
+      if (!item) return -ENOENT;
+
+      _drop(*item);
+      _updatePeriod();
+      return 0;
+
+    default:
+      return -EINVAL;
+  }
+}
+
+template <size_t NMAX_ITEMS>
+void EventPoll<NMAX_ITEMS>::forget(int fd) {
+  if (auto item = _find(fd)) {
+    _drop(*item);
+    _updatePeriod();
+  }
+}
+
+template <size_t NMAX_ITEMS>
+int EventPoll<NMAX_ITEMS>::harvest(epoll_event *events, int maxevents) {
+  auto n = 0;
+
+  /* Items queued again meanwhile are left for the next harvest */
+  for (auto item = _rdl.take(); item;) {
+    auto &it = *item;
+    item = it.next_ready;
+    it.ready = false;
+
+    /* Cleared by EPOLLONESHOT, once reported */
+    const auto events_mask = it.event.events & ~EP_PRIVATE_BITS;
+    const auto revents =
+        events_mask ? it.file->poll(*it.ofile) & events_mask : 0;
+
+    /* Nodes that cannot notify are sampled at every wait */
+    bool requeue = events_mask && it.file->pollPeriod().count() > 0;
+
+    if (revents && n < maxevents) {
+      events[n++] = {.events = revents, .data = it.event.data};
+
+      if (it.event.events & EPOLLONESHOT) {
+        it.event.events &= EP_PRIVATE_BITS;
+        requeue = false;
+      } else if (!(it.event.events & EPOLLET))
+        /* Level triggered: until poll() reports otherwise */
+        requeue = true;
+    } else if (revents)
+      /* Not reported yet */
+      requeue = true;
+
+    if (requeue) _rdl.push(it);
+  }
+
+  return n;
+}
+
+template <size_t NMAX_ITEMS>
+std::chrono::microseconds EventPoll<NMAX_ITEMS>::period() const {
+  return _period;
+}
+
+template <size_t NMAX_ITEMS>
+EpItem *EventPoll<NMAX_ITEMS>::_find(int fd) {
+  auto it = std::find_if(_items.begin(), _items.end(), [fd](const EpItem &i) {
+    return i.file && i.fd == fd;
+  });
+  return it == _items.end() ? nullptr : &*it;
+}
+
+template <size_t NMAX_ITEMS>
+void EventPoll<NMAX_ITEMS>::_drop(EpItem &item) {
+  item.file->unwatch(item);
+  _rdl.remove(item);
+  item.file = nullptr;
+}
+
+template <size_t NMAX_ITEMS>
+void EventPoll<NMAX_ITEMS>::_updatePeriod() {
+  _period = {};
+  for (const auto &item : _items) {
+    if (!item.file) continue;
+
+    const auto p = item.file->pollPeriod();
+    if (p.count() > 0 && (!_period.count() || p < _period)) _period = p;
+  }
+}
+
+#endif  // EVENTPOLL_TPP
@@ -12,35 +12,104 @@
 #include <unistd.h>
 
 #include <array>
+#include <bit>
+#include <chrono>
 #include <cstdarg>
+#include <functional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
 
+#include "CallbackUtils.hpp"
+#include "EventPoll.hpp"
+#include "FixedString.hpp"
 #include "IFile.h"
+#include "Pipe.hpp"
+#include "WaitQueue.h"
+#include "ioring.h"
+#include "mman.h"
+
+#ifdef FM_STATS
+#include "FmStats.hpp"
+#include "dwt.h"
+#endif
 
 #define NRESERVED_FD (STDERR_FILENO + 1)
+#define NMAX_EPOLL 2
+#define NMAX_PIPE 2
+#define PIPE_SIZE 128
 #define VALID_OPEN_FLAGS            \
   ((O_RDONLY | O_WRONLY | O_RDWR) | \
    (O_TRUNC | O_APPEND | O_NONBLOCK | O_BINARY))
 
-/* Binds a filename to a resource with IFile interface */
+/*
+ * Binds a filename to a resource with IFile interface, or to its concrete
+ * driver type, for the static dispatch of NodeDrivers
+ */
+template <FixedString NAME, typename DRIVER = IFile>
 struct Node {
-  const char *const name;
-  IFile &cdev;
+  static constexpr auto name = NAME;
+  using Driver = DRIVER;
+  Driver &cdev;
+};
+
+/*
+ * Filenames of the nodes, in the order they are registered: the file
+ * operations are dispatched through the IFile vtable
+ */
+template <FixedString... NAMES>
+struct NodeNames {
+  static constexpr size_t size = sizeof...(NAMES);
+  static constexpr std::array<const char *, size> names{NAMES.c_str()...};
+
+  template <typename... Args>
+  static constexpr bool matches =
+      std::is_same_v<NodeNames<Args::name...>, NodeNames>;
+};
+
+/*
+ * Nodes with their concrete driver types, in the order they are registered:
+ * the file operations are dispatched with a jump table generated at compile
+ * time, whose entries call the driver without the vtable, so that short
+ * driver paths are inlined
+ */
+template <typename... Nodes>
+struct NodeDrivers : NodeNames<Nodes::name...> {
+  using Drivers = std::tuple<typename Nodes::Driver...>;
+
+  template <typename... Args>
+  static constexpr bool matches =
+      std::is_same_v<NodeDrivers<Node<Args::name, typename Args::Driver>...>,
+                     NodeDrivers>;
 };
 
-template <size_t N_NODES, int NMAX_FD = N_NODES + NRESERVED_FD>
+template <typename HwAlarm, typename Names,
+          int NMAX_FD = Names::size + NRESERVED_FD + NMAX_EPOLL +
+                        2 * NMAX_PIPE>
 class FileManager {
+  static constexpr size_t N_NODES = Names::size;
+
  public:
-  /* Construct NodeTable, inferring N_NODES */
+  /*
+   * Construct NodeTable, in the order of Names. The alarm bounds the sleep of
+   * select(), which is woken up by the nodes through notify()
+   */
   template <typename... Args>
-  constexpr explicit FileManager(const Args &...args);
+  explicit FileManager(HwAlarm &hw_alarm, const Args &...args);
 
   /* Fill _files[fd] and invoke open() for standard streams */
   int stdStreamAttach(int fd, const char *name, int flags = 0);
+  template <FixedString NAME>
+  int stdStreamAttach(int fd, int flags = 0);
 
   /* System calls */
   int open(const char *name, int flags, mode_t mode = 0);
   int close(int fd);
 
+  /* Node resolved at compile time */
+  template <FixedString NAME>
+  int open(int flags, mode_t mode = 0);
+
   int stat(const char *name, struct stat *st);
   int fstat(int fd, struct stat *st);
   static int link(const char *old_name, const char *new_name);
@@ -49,12 +118,38 @@ class FileManager {
   off_t lseek(int fd, off_t offset, int whence);
   int read(int fd, void *buf, size_t count);
   int write(int fd, const void *buf, size_t count);
+  int readv(int fd, const iovec *iov, int iovcnt);
+  int writev(int fd, const iovec *iov, int iovcnt);
+
+  /* Zero-copy writes into the buffer lent by the driver */
+  int writeBufAcquire(int fd, void **buf, size_t count);
+  int writeBufCommit(int fd, size_t count);
+
+  /* In-place access to memory-resident content, see mman.h */
+  int fmap(int fd, int prot, void **addr);
 
   int vfcntl(int fd, int cmd, va_list vlist);
+  int vioctl(int fd, unsigned long request, va_list vlist);
   int select(int n, fd_set *inp, fd_set *outp, fd_set *exp, timeval *tvp);
 
+  /* Persistent interest lists, see epoll(7) */
+  int epollCreate(int flags);
+  int epollCtl(int epfd, int op, int fd, epoll_event *event);
+  int epollWait(int epfd, epoll_event *events, int maxevents, int timeout);
+
+  /* fds[0] is the read end, fds[1] the write end. Flags: O_NONBLOCK */
+  int pipe(int fds[2], int flags = 0);
+
+  /* Asynchronous reads and writes, see ioring.h */
+  int ioSubmit(const io_sqe *sqes, unsigned nr);
+  int ioWait(io_cqe *cqes, unsigned min, unsigned max, int timeout);
+
  private:
-  using NodeTable = std::array<Node, N_NODES>;
+  struct NodeEntry {
+    const char *name;
+    IFile &cdev;
+  };
+  using NodeTable = std::array<NodeEntry, N_NODES>;
 
   struct OFileEntry {
     typename NodeTable::const_pointer node;
@@ -62,15 +157,172 @@ class FileManager {
   };
   using OFileTable = std::array<OFileEntry, NMAX_FD>;
 
+  /*
+   * Perfect hash of the filenames, generated at compile time: a lookup is one
+   * hash, one probe of the slots and one strcmp. Half the slots are left
+   * empty, so that a seed is found quickly
+   */
+  static constexpr size_t HASH_SIZE = std::bit_ceil(2 * N_NODES);
+  static constexpr uint8_t EMPTY_SLOT = 0xFF;
+  static constexpr uint32_t MAX_SEED = 1U << 12;
+
+  struct HashTable {
+    uint32_t seed;
+    std::array<uint8_t, HASH_SIZE> slots; /* Index in NodeTable */
+  };
+
+  static constexpr uint32_t hash(const char *name, uint32_t seed);
+  static consteval bool hasDuplicates();
+  static consteval HashTable makeHashTable();
+  template <FixedString NAME>
+  static consteval size_t indexOf();
+
+  static constexpr HashTable _hash = makeHashTable();
+
   typename NodeTable::const_pointer _getNode(const char *name) const;
+  int _stdStreamAttach(int fd, typename NodeTable::const_pointer node,
+                       int flags);
+  int _open(typename NodeTable::const_pointer node, int flags);
+  int _checkIov(const iovec *iov, int iovcnt) const;
+  bool _isDriver(typename NodeTable::const_pointer node) const;
+  ino_t _inode(typename NodeTable::const_pointer node) const;
+
+  /* Invoke fn, timing it on behalf of node if FM_STATS */
+  template <typename Fn>
+  auto _account(typename NodeTable::const_pointer node, size_t op, Fn &&fn);
+
+  /* File operations bound to the concrete driver D, without the vtable */
+  template <typename D>
+  struct DirectCall {
+    D &cdev;
+
+    int open(OFile &ofile) { return cdev.D::open(ofile); }
+    int close(OFile &ofile) { return cdev.D::close(ofile); }
+    off_t llseek(OFile &ofile, off_t offset, int whence) {
+      return cdev.D::llseek(ofile, offset, whence);
+    }
+    ssize_t read(OFile &ofile, char *buf, size_t count, off_t &pos) {
+      return cdev.D::read(ofile, buf, count, pos);
+    }
+    ssize_t write(OFile &ofile, const char *buf, size_t count, off_t &pos) {
+      return cdev.D::write(ofile, buf, count, pos);
+    }
+    __poll_t poll(OFile &ofile) { return cdev.D::poll(ofile); }
+    int ioctl(OFile &ofile, unsigned long request, void *arg) {
+      return cdev.D::ioctl(ofile, request, arg);
+    }
+    ssize_t readv(OFile &ofile, const iovec *iov, int iovcnt, off_t &pos) {
+      return cdev.D::readv(ofile, iov, iovcnt, pos);
+    }
+    ssize_t writev(OFile &ofile, const iovec *iov, int iovcnt, off_t &pos) {
+      return cdev.D::writev(ofile, iov, iovcnt, pos);
+    }
+    ssize_t acquire(OFile &ofile, char *&buf, size_t count) {
+      return cdev.D::acquire(ofile, buf, count);
+    }
+    ssize_t commit(OFile &ofile, size_t count, off_t &pos) {
+      return cdev.D::commit(ofile, count, pos);
+    }
+    ssize_t mmap(OFile &ofile, int prot, void *&addr) {
+      return cdev.D::mmap(ofile, prot, addr);
+    }
+  };
+
+  template <typename Fn, size_t... I>
+  static constexpr auto _makeJumpTable(std::index_sequence<I...>);
+
+  /* Invoke fn on the driver of node, as IFile& or as DirectCall */
+  template <typename Fn>
+  decltype(auto) _dispatch(typename NodeTable::const_pointer node, Fn &&fn);
+
+  /* Epoll instances are opened as anonymous nodes */
+  using EventPollType = EventPoll<NMAX_FD>;
+  using EpNodeTable = std::array<NodeEntry, NMAX_EPOLL>;
+
+  template <size_t... I>
+  EpNodeTable _makeEpNodes(std::index_sequence<I...>);
+  bool _isEventPoll(typename NodeTable::const_pointer node) const;
+  EventPollType *_getEventPoll(int epfd);
+
+  /* And so are pipes */
+  using PipeType = Pipe<PIPE_SIZE>;
+  using PipeNodeTable = std::array<NodeEntry, NMAX_PIPE>;
+
+  template <size_t... I>
+  PipeNodeTable _makePipeNodes(std::index_sequence<I...>);
+  bool _isPipe(typename NodeTable::const_pointer node) const;
+
+  /* Timeout on the steady clock of the timer, which keeps counting in WFI */
+  class Deadline {
+   public:
+    using Clock = typename HwAlarm::SteadyClock;
+    static constexpr uint64_t NONE = UINT64_MAX;
+
+    explicit Deadline(uint64_t us)
+        : _now(Clock::now()),
+          _at(us == NONE ? Clock::time_point::max()
+                         : _now + std::chrono::microseconds(us)) {}
+
+    bool expired() {
+      _now = Clock::now();
+      return _now >= _at;
+    }
+
+    /* As of the last check */
+    typename HwAlarm::NanoSeconds remaining() const {
+      if (_at == Clock::time_point::max()) return HwAlarm::NanoSeconds::max();
+      if (_now >= _at) return HwAlarm::NanoSeconds::zero();
+      return std::chrono::duration_cast<typename HwAlarm::NanoSeconds>(_at -
+                                                                       _now);
+    }
+
+   private:
+    typename Clock::time_point _now;
+    typename Clock::time_point _at;
+  };
+
+  using CallbackType =
+      MemFnCallback<FileManager, typename HwAlarm::ICallbackType::FnType>;
+
+  /* Requests of the I/O ring, from submission until reaped */
+  struct IoEntry {
+    enum State : uint8_t { FREE, PENDING, DONE } state;
+    uint32_t seq; /* Submission order */
+    io_sqe sqe;
+    int32_t res;
+  };
+
+  /* Issue the pending requests that can proceed without blocking */
+  void _ioAdvance();
+  bool _ioIssue(IoEntry &entry);
+
+  /* Sleep until notified, or for at most t. False if not slept */
+  bool _sleep(const typename HwAlarm::NanoSeconds &t);
+  RAMFUNC void _timeout();
 
   NodeTable _nodes;
+  std::array<EventPollType, NMAX_EPOLL> _ep;
+  EpNodeTable _ep_nodes;
+  std::array<PipeType, NMAX_PIPE> _pipes;
+  PipeNodeTable _pipe_nodes;
+#ifdef FM_STATS
+  FmStats<N_NODES> _stats;
+  NodeEntry _stats_node;
+#endif
   OFileTable _files;
+  std::array<IoEntry, IORING_ENTRIES> _io{};
+  uint32_t _io_seq = 0;
+
+  HwAlarm &_hw_alarm;
+  CallbackType _timeout_cb;
+  typename HwAlarm::VirtualAlarm _timeout_alarm;
+  WaitQueue _wq;
 };
 
-/* Infers N_NODES from ctor arguments */
-template <typename... Args>
-FileManager(const Args &...args) -> FileManager<sizeof...(args)>;
+/* Infers the filenames from ctor arguments */
+template <typename HwAlarm, FixedString... NAMES>
+FileManager(HwAlarm &hw_alarm, const Node<NAMES> &...args)
+    -> FileManager<HwAlarm, NodeNames<NAMES...>>;
 
 #include "FileManager.tpp"
 
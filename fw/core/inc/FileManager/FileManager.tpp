@@ -10,62 +10,287 @@
 #define FILEMANAGER_TPP
 
 #include <eventpoll.h>
+#include <fmstats.h>
 
 #include <algorithm>
 #include <cerrno>
 #include <cstring>
+#include <limits>
+#include <string_view>
+#include <type_traits>
 
-template <size_t N_NODES, int NMAX_FD>
+template <typename HwAlarm, typename Names, int NMAX_FD>
 template <typename... Args>
-constexpr FileManager<N_NODES, NMAX_FD>::FileManager(const Args &...args)
-    : _nodes{args...}, _files{} {
+FileManager<HwAlarm, Names, NMAX_FD>::FileManager(HwAlarm &hw_alarm,
+                                                  const Args &...args)
+    : _nodes{NodeEntry{Args::name.c_str(), args.cdev}...},
+      _ep{},
+      _ep_nodes{_makeEpNodes(std::make_index_sequence<NMAX_EPOLL>{})},
+      _pipes{},
+      _pipe_nodes{_makePipeNodes(std::make_index_sequence<NMAX_PIPE>{})},
+#ifdef FM_STATS
+      _stats(Names::names),
+      _stats_node{"stats", _stats},
+#endif
+      _files{},
+      _hw_alarm(hw_alarm),
+      _timeout_cb(this, &FileManager::_timeout),
+      _timeout_alarm(&_timeout_cb) {
   static_assert(sizeof...(args) > 0, "NodeTable is empty");
-  static_assert(N_NODES == sizeof...(args), "Mismatched number of nodes");
+  static_assert(Names::template matches<Args...>, "Mismatched nodes");
   static_assert(NMAX_FD > NRESERVED_FD, "OFileTable is too small");
+  static_assert(!hasDuplicates(), "Duplicate filenames");
+  static_assert(_hash.seed != MAX_SEED, "No perfect hash of the filenames");
+#ifdef FM_STATS
+  static_assert(indexOf<"stats">() == N_NODES, "Filename reserved to stats");
+#endif
+
+  /* Readiness changes are notified to select() */
+  for (auto &node : _nodes) node.cdev.setWaitQueue(&_wq);
+  for (auto &pipe : _pipes) pipe.setWaitQueue(&_wq);
 }
 
-template <size_t N_NODES, int NMAX_FD>
-typename std::array<Node, N_NODES>::const_pointer
-FileManager<N_NODES, NMAX_FD>::_getNode(const char *name) const {
-  auto it = std::find_if(_nodes.begin(), _nodes.end(), [&](const Node &node) {
-    return !strcmp(name, node.name);
-  });
-  return it == _nodes.cend() ? nullptr : &(*it);
+/* FNV-1a, with a final mix to spread the low bits */
+template <typename HwAlarm, typename Names, int NMAX_FD>
+constexpr uint32_t FileManager<HwAlarm, Names, NMAX_FD>::hash(const char *name,
+                                                              uint32_t seed) {
+  uint32_t h = 2166136261U ^ seed;
+  while (*name) h = (h ^ static_cast<uint8_t>(*name++)) * 16777619U;
+
+  h ^= h >> 16;
+  h *= 0x7feb352dU;
+  return h ^ (h >> 15);
 }
 
-template <size_t N_NODES, int NMAX_FD>
-int FileManager<N_NODES, NMAX_FD>::stdStreamAttach(int fd, const char *name,
-                                                   int flags) {
-  /* Only for standard streams */
-  if (fd < 0 || fd >= NRESERVED_FD) return -EBADF;
+template <typename HwAlarm, typename Names, int NMAX_FD>
+consteval bool FileManager<HwAlarm, Names, NMAX_FD>::hasDuplicates() {
+  for (size_t i = 0; i < N_NODES; ++i)
+    for (size_t j = i + 1; j < N_NODES; ++j)
+      if (std::string_view(Names::names[i]) == Names::names[j]) return true;
+  return false;
+}
+
+template <typename HwAlarm, typename Names, int NMAX_FD>
+consteval auto FileManager<HwAlarm, Names, NMAX_FD>::makeHashTable()
+    -> HashTable {
+  static_assert(N_NODES < EMPTY_SLOT, "Too many nodes");
+  if (hasDuplicates()) return {MAX_SEED, {}};
+
+  for (uint32_t seed = 0; seed < MAX_SEED; ++seed) {
+    HashTable t{seed, {}};
+    t.slots.fill(EMPTY_SLOT);
+
+    bool collision = false;
+    for (size_t i = 0; !collision && i < N_NODES; ++i) {
+      auto &slot = t.slots[hash(Names::names[i], seed) & (HASH_SIZE - 1)];
+      collision = (slot != EMPTY_SLOT);
+      slot = i;
+    }
+
+    if (!collision) return t;
+  }
+
+  return {MAX_SEED, {}};
+}
+
+template <typename HwAlarm, typename Names, int NMAX_FD>
+template <FixedString NAME>
+consteval size_t FileManager<HwAlarm, Names, NMAX_FD>::indexOf() {
+  size_t i = 0;
+  while (i < N_NODES && std::string_view(Names::names[i]) != NAME.view()) ++i;
+  return i;
+}
 
+template <typename HwAlarm, typename Names, int NMAX_FD>
+auto FileManager<HwAlarm, Names, NMAX_FD>::_getNode(const char *name) const ->
+    typename NodeTable::const_pointer {
+  const auto idx = _hash.slots[hash(name, _hash.seed) & (HASH_SIZE - 1)];
+  if (idx == EMPTY_SLOT || strcmp(name, _nodes[idx].name)) {
+#ifdef FM_STATS
+    if (!strcmp(name, _stats_node.name)) return &_stats_node;
+#endif
+    return nullptr;
+  }
+
+  return &_nodes[idx];
+}
+
+template <typename HwAlarm, typename Names, int NMAX_FD>
+int FileManager<HwAlarm, Names, NMAX_FD>::stdStreamAttach(int fd,
+                                                          const char *name,
+                                                          int flags) {
   auto node = _getNode(name);
   if (!node) return -ENOENT;
 
+  return _stdStreamAttach(fd, node, flags);
+}
+
+template <typename HwAlarm, typename Names, int NMAX_FD>
+template <FixedString NAME>
+int FileManager<HwAlarm, Names, NMAX_FD>::stdStreamAttach(int fd, int flags) {
+  constexpr auto idx = indexOf<NAME>();
+  static_assert(idx < N_NODES, "No such node");
+
+  return _stdStreamAttach(fd, &_nodes[idx], flags);
+}
+
+template <typename HwAlarm, typename Names, int NMAX_FD>
+template <typename Fn, size_t... I>
+constexpr auto FileManager<HwAlarm, Names, NMAX_FD>::_makeJumpTable(
+    std::index_sequence<I...>) {
+  using R = std::invoke_result_t<Fn &, IFile &>;
+  using Drivers = typename Names::Drivers;
+
+  return std::array<R (*)(IFile &, Fn &), N_NODES>{
+      [](IFile &cdev, Fn &fn) -> R {
+        using D = std::tuple_element_t<I, Drivers>;
+        return fn(DirectCall<D>{static_cast<D &>(cdev)});
+      }...};
+}
+
+template <typename HwAlarm, typename Names, int NMAX_FD>
+template <typename Fn>
+decltype(auto) FileManager<HwAlarm, Names, NMAX_FD>::_dispatch(
+    typename NodeTable::const_pointer node, Fn &&fn) {
+  if constexpr (requires { typename Names::Drivers; }) {
+    using FnType = std::remove_reference_t<Fn>;
+    static constexpr auto table =
+        _makeJumpTable<FnType>(std::make_index_sequence<N_NODES>{});
+
+    /* Epoll instances, pipes and stats are not in the table */
+    if (_isDriver(node))
+      return table[std::distance(_nodes.cbegin(), node)](node->cdev, fn);
+  }
+
+  return fn(node->cdev);
+}
+
+template <typename HwAlarm, typename Names, int NMAX_FD>
+bool FileManager<HwAlarm, Names, NMAX_FD>::_isDriver(
+    typename NodeTable::const_pointer node) const {
+  /* total order, the tables are unrelated arrays */
+  constexpr std::less<> lt;
+  return !lt(node, _nodes.data()) && lt(node, _nodes.data() + N_NODES);
+}
+
+template <typename HwAlarm, typename Names, int NMAX_FD>
+ino_t FileManager<HwAlarm, Names, NMAX_FD>::_inode(
+    typename NodeTable::const_pointer node) const {
+  if (_isDriver(node)) return std::distance(_nodes.cbegin(), node);
+  if (_isEventPoll(node))
+    return N_NODES + std::distance(_ep_nodes.cbegin(), node);
+  if (_isPipe(node))
+    return N_NODES + NMAX_EPOLL + std::distance(_pipe_nodes.cbegin(), node);
+
+  /* Stats */
+  return N_NODES + NMAX_EPOLL + NMAX_PIPE;
+}
+
+template <typename HwAlarm, typename Names, int NMAX_FD>
+template <typename Fn>
+auto FileManager<HwAlarm, Names, NMAX_FD>::_account(
+    [[maybe_unused]] typename NodeTable::const_pointer node,
+    [[maybe_unused]] size_t op, Fn &&fn) {
+#ifdef FM_STATS
+  if (_isDriver(node)) {
+    const auto start = dwt::getCycles();
+    const auto ret = fn();
+    _stats.record(std::distance(_nodes.cbegin(), node), op, ret,
+                  dwt::getCycles() - start);
+    return ret;
+  }
+#endif
+
+  return fn();
+}
+
+template <typename HwAlarm, typename Names, int NMAX_FD>
+template <size_t... I>
+auto FileManager<HwAlarm, Names, NMAX_FD>::_makeEpNodes(
+    std::index_sequence<I...>) -> EpNodeTable {
+  return {NodeEntry{"eventpoll", _ep[I]}...};
+}
+
+template <typename HwAlarm, typename Names, int NMAX_FD>
+bool FileManager<HwAlarm, Names, NMAX_FD>::_isEventPoll(
+    typename NodeTable::const_pointer node) const {
+  /* total order, the tables are unrelated arrays */
+  constexpr std::less<> lt;
+  return !lt(node, _ep_nodes.data()) && lt(node, _ep_nodes.data() + NMAX_EPOLL);
+}
+
+template <typename HwAlarm, typename Names, int NMAX_FD>
+auto FileManager<HwAlarm, Names, NMAX_FD>::_getEventPoll(int epfd)
+    -> EventPollType * {
+  if (!_isEventPoll(_files[epfd].node)) return nullptr;
+  return &_ep[std::distance(_ep_nodes.cbegin(), _files[epfd].node)];
+}
+
+template <typename HwAlarm, typename Names, int NMAX_FD>
+template <size_t... I>
+auto FileManager<HwAlarm, Names, NMAX_FD>::_makePipeNodes(
+    std::index_sequence<I...>) -> PipeNodeTable {
+  return {NodeEntry{"pipe", _pipes[I]}...};
+}
+
+template <typename HwAlarm, typename Names, int NMAX_FD>
+bool FileManager<HwAlarm, Names, NMAX_FD>::_isPipe(
+    typename NodeTable::const_pointer node) const {
+  /* total order, the tables are unrelated arrays */
+  constexpr std::less<> lt;
+  return !lt(node, _pipe_nodes.data()) && lt(node, _pipe_nodes.data() + NMAX_PIPE);
+}
+
+template <typename HwAlarm, typename Names, int NMAX_FD>
+int FileManager<HwAlarm, Names, NMAX_FD>::_stdStreamAttach(
+    int fd, typename NodeTable::const_pointer node, int flags) {
+  /* Only for standard streams */
+  if (fd < 0 || fd >= NRESERVED_FD) return -EBADF;
+
   _files[fd] = {.node = node,
                 .ofile = {.mode = (fd == STDIN_FILENO) ? FREAD : FWRITE,
                           .flags = flags & ~O_ACCMODE,
                           .pos = 0}};
 
   /* Invoke driver's open() and free _files' entry in case of error */
-  auto ret = _files[fd].node->cdev.open(_files[fd].ofile);
+  auto ret = _account(node, FM_STATS_OPEN, [&] {
+    return _dispatch(node, [&](auto &&cdev) {
+      return cdev.open(_files[fd].ofile);
+    });
+  });
   if (ret < 0) _files[fd].node = nullptr;
 
   return ret;
 }
 
-template <size_t N_NODES, int NMAX_FD>
-int FileManager<N_NODES, NMAX_FD>::open(const char *name, int flags,
-                                        [[maybe_unused]] mode_t mode) {
+template <typename HwAlarm, typename Names, int NMAX_FD>
+int FileManager<HwAlarm, Names, NMAX_FD>::open(const char *name, int flags,
+                                               [[maybe_unused]] mode_t mode) {
+  auto node = _getNode(name);
+  if (!node) return -ENOENT;
+
+  return _open(node, flags);
+}
+
+template <typename HwAlarm, typename Names, int NMAX_FD>
+template <FixedString NAME>
+int FileManager<HwAlarm, Names, NMAX_FD>::open(int flags,
+                                               [[maybe_unused]] mode_t mode) {
+  constexpr auto idx = indexOf<NAME>();
+  static_assert(idx < N_NODES, "No such node");
+
+  return _open(&_nodes[idx], flags);
+}
+
+template <typename HwAlarm, typename Names, int NMAX_FD>
+int FileManager<HwAlarm, Names, NMAX_FD>::_open(
+    typename NodeTable::const_pointer node, int flags) {
   /* File creation is not supported */
   flags &= ~O_CREAT;
 
   /* Fail if unsupported flags are set */
   if (flags & ~VALID_OPEN_FLAGS) return -EINVAL;
 
-  auto node = _getNode(name);
-  if (!node) return -ENOENT;
-
   /* Look for a free fd past the reserved ones */
   auto it = std::find_if(_files.begin() + NRESERVED_FD, _files.end(),
                          [](const OFileEntry &entry) { return !entry.node; });
@@ -79,7 +304,9 @@ int FileManager<N_NODES, NMAX_FD>::open(const char *name, int flags,
       }};
 
   /* Invoke driver's open() and free _files' entry in case of error */
-  auto ret = it->node->cdev.open(it->ofile);
+  auto ret = _account(node, FM_STATS_OPEN, [&] {
+    return _dispatch(node, [&](auto &&cdev) { return cdev.open(it->ofile); });
+  });
   if (ret < 0) {
     it->node = nullptr;
     return ret;
@@ -89,79 +316,206 @@ int FileManager<N_NODES, NMAX_FD>::open(const char *name, int flags,
   return std::distance(_files.begin(), it);
 }
 
-template <size_t N_NODES, int NMAX_FD>
-int FileManager<N_NODES, NMAX_FD>::close(int fd) {
+template <typename HwAlarm, typename Names, int NMAX_FD>
+int FileManager<HwAlarm, Names, NMAX_FD>::close(int fd) {
   if (fd < 0 || fd >= NMAX_FD || !_files[fd].node) return -EBADF;
 
-  auto ret = _files[fd].node->cdev.close(_files[fd].ofile);
+  /* Interest lists refer to the open file */
+  for (auto &ep : _ep)
+    if (ep.inUse()) ep.forget(fd);
+
+  /* So do the requests of the I/O ring */
+  for (auto &entry : _io) {
+    if (entry.state == IoEntry::PENDING && entry.sqe.fd == fd) {
+      entry.res = -ECANCELED;
+      entry.state = IoEntry::DONE;
+    }
+  }
+
+  auto ret = _dispatch(_files[fd].node, [&](auto &&cdev) {
+    return cdev.close(_files[fd].ofile);
+  });
   _files[fd].node = nullptr;
 
   return ret;
 }
 
-template <size_t N_NODES, int NMAX_FD>
-int FileManager<N_NODES, NMAX_FD>::stat(const char *name, struct stat *st) {
+template <typename HwAlarm, typename Names, int NMAX_FD>
+int FileManager<HwAlarm, Names, NMAX_FD>::stat(const char *name,
+                                               struct stat *st) {
   auto node = _getNode(name);
   if (!node) return -ENOENT;
 
-  st->st_ino = std::distance(_nodes.cbegin(), node);
+  st->st_ino = _inode(node);
   st->st_mode = S_IFCHR;
   st->st_nlink = 1;
   return 0;
 }
 
-template <size_t N_NODES, int NMAX_FD>
-int FileManager<N_NODES, NMAX_FD>::fstat(int fd, struct stat *st) {
+template <typename HwAlarm, typename Names, int NMAX_FD>
+int FileManager<HwAlarm, Names, NMAX_FD>::fstat(int fd, struct stat *st) {
   if (fd < 0 || fd >= NMAX_FD || !_files[fd].node) return -EBADF;
 
-  st->st_ino = std::distance(_nodes.cbegin(), _files[fd].node);
-  st->st_mode = S_IFCHR;
+  st->st_ino = _inode(_files[fd].node);
+  st->st_mode = _isPipe(_files[fd].node) ? S_IFIFO : S_IFCHR;
   st->st_nlink = 1;
   return 0;
 }
 
-template <size_t N_NODES, int NMAX_FD>
-int FileManager<N_NODES, NMAX_FD>::link([[maybe_unused]] const char *old_name,
-                                        [[maybe_unused]] const char *new_name) {
+template <typename HwAlarm, typename Names, int NMAX_FD>
+int FileManager<HwAlarm, Names, NMAX_FD>::link(
+    [[maybe_unused]] const char *old_name,
+    [[maybe_unused]] const char *new_name) {
   return -ENOSYS;
 }
 
-template <size_t N_NODES, int NMAX_FD>
-int FileManager<N_NODES, NMAX_FD>::unlink([[maybe_unused]] const char *name) {
+template <typename HwAlarm, typename Names, int NMAX_FD>
+int FileManager<HwAlarm, Names, NMAX_FD>::unlink(
+    [[maybe_unused]] const char *name) {
   return -ENOSYS;
 }
 
-template <size_t N_NODES, int NMAX_FD>
-off_t FileManager<N_NODES, NMAX_FD>::lseek(int fd, off_t offset, int whence) {
+template <typename HwAlarm, typename Names, int NMAX_FD>
+off_t FileManager<HwAlarm, Names, NMAX_FD>::lseek(int fd, off_t offset,
+                                                  int whence) {
   if (fd < 0 || fd >= NMAX_FD || !_files[fd].node) return -EBADF;
 
-  return _files[fd].node->cdev.llseek(_files[fd].ofile, offset, whence);
+  return _dispatch(_files[fd].node, [&](auto &&cdev) {
+    return cdev.llseek(_files[fd].ofile, offset, whence);
+  });
 }
 
-template <size_t N_NODES, int NMAX_FD>
-int FileManager<N_NODES, NMAX_FD>::read(int fd, void *buf, size_t count) {
+template <typename HwAlarm, typename Names, int NMAX_FD>
+int FileManager<HwAlarm, Names, NMAX_FD>::read(int fd, void *buf,
+                                               size_t count) {
   if (fd < 0 || fd >= NMAX_FD || !_files[fd].node ||
       !(_files[fd].ofile.mode & FREAD))
     return -EBADF;
 
-  return _files[fd].node->cdev.read(_files[fd].ofile, static_cast<char *>(buf),
-                                    count, _files[fd].ofile.pos);
+  return _account(_files[fd].node, FM_STATS_READ, [&] {
+    return _dispatch(_files[fd].node, [&](auto &&cdev) {
+      return cdev.read(_files[fd].ofile, static_cast<char *>(buf), count,
+                       _files[fd].ofile.pos);
+    });
+  });
 }
 
-template <size_t N_NODES, int NMAX_FD>
-int FileManager<N_NODES, NMAX_FD>::write(int fd, const void *buf,
-                                         size_t count) {
+template <typename HwAlarm, typename Names, int NMAX_FD>
+int FileManager<HwAlarm, Names, NMAX_FD>::write(int fd, const void *buf,
+                                                size_t count) {
   if (fd < 0 || fd >= NMAX_FD || !_files[fd].node ||
       !(_files[fd].ofile.mode & FWRITE))
     return -EBADF;
 
-  return _files[fd].node->cdev.write(_files[fd].ofile,
-                                     static_cast<const char *>(buf), count,
-                                     _files[fd].ofile.pos);
+  return _account(_files[fd].node, FM_STATS_WRITE, [&] {
+    return _dispatch(_files[fd].node, [&](auto &&cdev) {
+      return cdev.write(_files[fd].ofile, static_cast<const char *>(buf),
+                        count, _files[fd].ofile.pos);
+    });
+  });
 }
 
-template <size_t N_NODES, int NMAX_FD>
-int FileManager<N_NODES, NMAX_FD>::vfcntl(int fd, int cmd, va_list vlist) {
+template <typename HwAlarm, typename Names, int NMAX_FD>
+int FileManager<HwAlarm, Names, NMAX_FD>::_checkIov(const iovec *iov,
+                                                    int iovcnt) const {
+  if (iovcnt < 0 || iovcnt > UIO_MAXIOV || (iovcnt && !iov)) return -EINVAL;
+
+  /* The total length must fit the return */
+  constexpr auto MAX = static_cast<size_t>(std::numeric_limits<ssize_t>::max());
+  size_t total = 0;
+  for (auto i = 0; i < iovcnt; ++i) {
+    if (iov[i].iov_len > MAX - total) return -EINVAL;
+    total += iov[i].iov_len;
+  }
+
+  return 0;
+}
+
+template <typename HwAlarm, typename Names, int NMAX_FD>
+int FileManager<HwAlarm, Names, NMAX_FD>::readv(int fd, const iovec *iov,
+                                                int iovcnt) {
+  if (fd < 0 || fd >= NMAX_FD || !_files[fd].node ||
+      !(_files[fd].ofile.mode & FREAD))
+    return -EBADF;
+
+  if (auto ret = _checkIov(iov, iovcnt); ret < 0) return ret;
+
+  return _account(_files[fd].node, FM_STATS_READ, [&] {
+    return _dispatch(_files[fd].node, [&](auto &&cdev) {
+      return cdev.readv(_files[fd].ofile, iov, iovcnt, _files[fd].ofile.pos);
+    });
+  });
+}
+
+template <typename HwAlarm, typename Names, int NMAX_FD>
+int FileManager<HwAlarm, Names, NMAX_FD>::writev(int fd, const iovec *iov,
+                                                 int iovcnt) {
+  if (fd < 0 || fd >= NMAX_FD || !_files[fd].node ||
+      !(_files[fd].ofile.mode & FWRITE))
+    return -EBADF;
+
+  if (auto ret = _checkIov(iov, iovcnt); ret < 0) return ret;
+
+  return _account(_files[fd].node, FM_STATS_WRITE, [&] {
+    return _dispatch(_files[fd].node, [&](auto &&cdev) {
+      return cdev.writev(_files[fd].ofile, iov, iovcnt, _files[fd].ofile.pos);
+    });
+  });
+}
+
+template <typename HwAlarm, typename Names, int NMAX_FD>
+int FileManager<HwAlarm, Names, NMAX_FD>::writeBufAcquire(int fd, void **buf,
+                                                          size_t count) {
+  if (fd < 0 || fd >= NMAX_FD || !_files[fd].node ||
+      !(_files[fd].ofile.mode & FWRITE))
+    return -EBADF;
+
+  if (!buf) return -EFAULT;
+
+  char *loan = nullptr;
+  const auto ret = _dispatch(_files[fd].node, [&](auto &&cdev) {
+    return cdev.acquire(_files[fd].ofile, loan, count);
+  });
+
+  if (ret >= 0) *buf = loan;
+  return ret;
+}
+
+template <typename HwAlarm, typename Names, int NMAX_FD>
+int FileManager<HwAlarm, Names, NMAX_FD>::writeBufCommit(int fd, size_t count) {
+  if (fd < 0 || fd >= NMAX_FD || !_files[fd].node ||
+      !(_files[fd].ofile.mode & FWRITE))
+    return -EBADF;
+
+  return _dispatch(_files[fd].node, [&](auto &&cdev) {
+    return cdev.commit(_files[fd].ofile, count, _files[fd].ofile.pos);
+  });
+}
+
+template <typename HwAlarm, typename Names, int NMAX_FD>
+int FileManager<HwAlarm, Names, NMAX_FD>::fmap(int fd, int prot, void **addr) {
+  if (fd < 0 || fd >= NMAX_FD || !_files[fd].node) return -EBADF;
+  if (!addr) return -EFAULT;
+  if (prot & ~(PROT_READ | PROT_WRITE)) return -EINVAL;
+
+  /* The mapping cannot grant more than the open file does */
+  const auto mode = _files[fd].ofile.mode;
+  if (((prot & PROT_READ) && !(mode & FREAD)) ||
+      ((prot & PROT_WRITE) && !(mode & FWRITE)))
+    return -EACCES;
+
+  void *map = nullptr;
+  const auto ret = _dispatch(_files[fd].node, [&](auto &&cdev) {
+    return cdev.mmap(_files[fd].ofile, prot, map);
+  });
+
+  if (ret >= 0) *addr = map;
+  return ret;
+}
+
+template <typename HwAlarm, typename Names, int NMAX_FD>
+int FileManager<HwAlarm, Names, NMAX_FD>::vfcntl(int fd, int cmd,
+                                                 va_list vlist) {
   if (fd < 0 || fd >= NMAX_FD || !_files[fd].node) return -EBADF;
 
   auto &ofile = _files[fd].ofile;
@@ -189,23 +543,69 @@ int FileManager<N_NODES, NMAX_FD>::vfcntl(int fd, int cmd, va_list vlist) {
   }
 }
 
-template <size_t N_NODES, int NMAX_FD>
-int FileManager<N_NODES, NMAX_FD>::select(int n, fd_set *inp, fd_set *outp,
-                                          fd_set *exp, timeval *tvp) {
+template <typename HwAlarm, typename Names, int NMAX_FD>
+int FileManager<HwAlarm, Names, NMAX_FD>::vioctl(int fd, unsigned long request,
+                                                 va_list vlist) {
+  if (fd < 0 || fd >= NMAX_FD || !_files[fd].node) return -EBADF;
+
+  /* The argument, if any, is passed by pointer */
+  auto arg = _IOC_SIZE(request) ? va_arg(vlist, void *) : nullptr;
+  if (_IOC_SIZE(request) && !arg) return -EFAULT;
+
+  return _dispatch(_files[fd].node, [&](auto &&cdev) {
+    return cdev.ioctl(_files[fd].ofile, request, arg);
+  });
+}
+
+template <typename HwAlarm, typename Names, int NMAX_FD>
+RAMFUNC void FileManager<HwAlarm, Names, NMAX_FD>::_timeout() {
+  _wq.wake();
+}
+
+template <typename HwAlarm, typename Names, int NMAX_FD>
+bool FileManager<HwAlarm, Names, NMAX_FD>::_sleep(
+    const typename HwAlarm::NanoSeconds &t) {
+  /* Longer waits are split, and the caller polls in between */
+  if (_hw_alarm.setAlarm(std::min(t, _hw_alarm.maxDelay()), _timeout_alarm) !=
+      HwAlarm::STARTED)
+    return false;
+
+  _wq.sleep();
+
+  /* Woken up by a node */
+  _hw_alarm.setAlarm(_timeout_alarm, 0);
+  return true;
+}
+
+template <typename HwAlarm, typename Names, int NMAX_FD>
+int FileManager<HwAlarm, Names, NMAX_FD>::select(int n, fd_set *inp,
+                                                 fd_set *outp, fd_set *exp,
+                                                 timeval *tvp) {
+  using NanoSeconds = typename HwAlarm::NanoSeconds;
+
+  /* No EPOLLNVAL: a closed descriptor fails the call with -EBADF */
   constexpr auto POLLIN_SET =
-      EPOLLRDNORM | EPOLLRDBAND | EPOLLIN | EPOLLHUP | EPOLLERR | EPOLLNVAL;
-  constexpr auto POLLOUT_SET =
-      EPOLLWRBAND | EPOLLWRNORM | EPOLLOUT | EPOLLERR | EPOLLNVAL;
-  constexpr auto POLLEX_SET = EPOLLPRI | EPOLLNVAL;
+      EPOLLRDNORM | EPOLLRDBAND | EPOLLIN | EPOLLHUP | EPOLLERR;
+  constexpr auto POLLOUT_SET = EPOLLWRBAND | EPOLLWRNORM | EPOLLOUT | EPOLLERR;
+  constexpr auto POLLEX_SET = EPOLLPRI;
 
-  /* Support for blocking indefinitely or not at all */
-  bool timed_out = false;
-  if (tvp && !((timed_out = (tvp->tv_sec == 0) && (tvp->tv_usec == 0))))
-    return -ENOTSUP;
+  constexpr time_t NMAX_SEC = 1000000000; /* Keeps the deadline in range */
 
   if (n < 0) return -EINVAL;
   if (n > NMAX_FD) n = NMAX_FD;
 
+  if (tvp && (tvp->tv_sec < 0 || tvp->tv_usec < 0 || tvp->tv_usec >= 1000000))
+    return -EINVAL;
+
+  /* A NULL timeout blocks indefinitely, a zero one doesn't block */
+  Deadline deadline(
+      !tvp ? Deadline::NONE
+           : std::min(tvp->tv_sec, NMAX_SEC) * 1000000ULL + tvp->tv_usec);
+
+#ifdef FM_STATS
+  const auto start = dwt::getCycles();
+#endif
+
   /*
    * A set of file descriptors is represented with the `fd_set` type.
    * The inclusion of a file descriptor in the set corresponds to setting a bit
@@ -234,7 +634,8 @@ int FileManager<N_NODES, NMAX_FD>::select(int n, fd_set *inp, fd_set *outp,
   /*
    * The readiness of a file descriptor is investigated with a VFS operation
    *   `__poll_t (*poll) (struct file *, struct poll_table_struct *)`
-   * Monitoring of such readiness is implemented with a polling loop
+   * Between polls, the core sleeps until a node notifies a change, a node
+   * that cannot notify is due for sampling, or the timeout expires
    */
   while (true) {
     auto inp_ = inp ? inp->__fds_bits : nullptr;
@@ -245,6 +646,9 @@ int FileManager<N_NODES, NMAX_FD>::select(int n, fd_set *inp, fd_set *outp,
     auto routp = ret_out.__fds_bits;
     auto rexp = ret_ex.__fds_bits;
 
+    /* Shortest sampling period among the polled nodes */
+    auto wait = NanoSeconds::max();
+
     /* Over bitmaps */
     for (auto i = 0; i < n; ++rinp, ++routp, ++rexp) {
       constexpr int bitmap_nbits = sizeof(fd_mask) * 8;
@@ -261,15 +665,20 @@ int FileManager<N_NODES, NMAX_FD>::select(int n, fd_set *inp, fd_set *outp,
         fd_mask bit_sel = 1;
         for (auto j = 0; i < n && j < bitmap_nbits; ++j, ++i, bit_sel <<= 1) {
           if (all & bit_sel) {
+            /* As in Linux, rather than reporting POLLNVAL */
+            if (!_files[i].node) return -EBADF;
+
             /*
              * Bind to driver's file operation, which returns the ready state
              * for reading, writing, and exceptional conditions.
              * Based on this information, the return bitmaps and the total bit
              * set count are updated.
              */
-            const auto mask = !_files[i].node
-                                  ? EPOLLNVAL
-                                  : _files[i].node->cdev.poll(_files[i].ofile);
+            const auto mask = _account(_files[i].node, FM_STATS_POLL, [&] {
+              return _dispatch(_files[i].node, [&](auto &&cdev) {
+                return cdev.poll(_files[i].ofile);
+              });
+            });
 
             if ((mask & POLLIN_SET) && (in & bit_sel)) {
               *rinp |= bit_sel;
@@ -283,18 +692,246 @@ int FileManager<N_NODES, NMAX_FD>::select(int n, fd_set *inp, fd_set *outp,
               *rexp |= bit_sel;
               set_cnt++;
             }
+
+            const auto period = _files[i].node->cdev.pollPeriod();
+            if (period.count() > 0) wait = std::min<NanoSeconds>(wait, period);
           }
         }
       }
     }
 
-    if (set_cnt || timed_out) {
+    if (set_cnt || deadline.expired()) {
+#ifdef FM_STATS
+      /* The whole call, on behalf of each watched node */
+      const auto cycles = dwt::getCycles() - start;
+      for (auto fd = 0; fd < n; ++fd) {
+        if (!_isDriver(_files[fd].node) ||
+            !((inp && FD_ISSET(fd, inp)) || (outp && FD_ISSET(fd, outp)) ||
+              (exp && FD_ISSET(fd, exp))))
+          continue;
+
+        const auto ready = FD_ISSET(fd, &ret_in) || FD_ISSET(fd, &ret_out) ||
+                           FD_ISSET(fd, &ret_ex);
+        _stats.record(std::distance(_nodes.cbegin(), _files[fd].node),
+                      FM_STATS_SELECT, ready ? 1 : -EAGAIN, cycles);
+      }
+#endif
+
       if (inp) *inp = ret_in;
       if (outp) *outp = ret_out;
       if (exp) *exp = ret_ex;
       return set_cnt;
     }
+
+    /*
+     * Without an alarm channel, or for a wait too short to be scheduled, it
+     * falls back to polling
+     */
+    _sleep(std::min(wait, deadline.remaining()));
+  }
+}
+
+template <typename HwAlarm, typename Names, int NMAX_FD>
+int FileManager<HwAlarm, Names, NMAX_FD>::epollCreate(int flags) {
+  if (flags) return -EINVAL;
+
+  auto it = std::find_if(_ep.begin(), _ep.end(),
+                         [](const EventPollType &ep) { return !ep.inUse(); });
+  if (it == _ep.end()) return -EMFILE;
+
+  return _open(&_ep_nodes[std::distance(_ep.begin(), it)], O_RDONLY);
+}
+
+template <typename HwAlarm, typename Names, int NMAX_FD>
+int FileManager<HwAlarm, Names, NMAX_FD>::epollCtl(int epfd, int op, int fd,
+                                                   epoll_event *event) {
+  if (epfd < 0 || epfd >= NMAX_FD || !_files[epfd].node) return -EBADF;
+  if (fd < 0 || fd >= NMAX_FD || !_files[fd].node) return -EBADF;
+
+  /* Nesting is not supported, as instances do not notify */
+  auto ep = _getEventPoll(epfd);
+  if (!ep || _isEventPoll(_files[fd].node)) return -EINVAL;
+
+  return ep->ctl(op, fd, _files[fd].node->cdev, _files[fd].ofile, event);
+}
+
+template <typename HwAlarm, typename Names, int NMAX_FD>
+int FileManager<HwAlarm, Names, NMAX_FD>::epollWait(int epfd,
+                                                    epoll_event *events,
+                                                    int maxevents,
+                                                    int timeout) {
+  if (epfd < 0 || epfd >= NMAX_FD || !_files[epfd].node) return -EBADF;
+
+  auto ep = _getEventPoll(epfd);
+  if (!ep || !events || maxevents <= 0) return -EINVAL;
+
+  /* A negative timeout blocks indefinitely, a zero one doesn't block */
+  Deadline deadline(timeout < 0 ? Deadline::NONE : timeout * 1000ULL);
+
+  while (true) {
+    const auto n = ep->harvest(events, maxevents);
+    if (n || deadline.expired()) return n;
+
+    /* Until a node notifies, is due for sampling, or the timeout expires */
+    auto wait = deadline.remaining();
+    if (ep->period().count() > 0)
+      wait = std::min<typename HwAlarm::NanoSeconds>(wait, ep->period());
+
+    _sleep(wait);
+  }
+}
+
+template <typename HwAlarm, typename Names, int NMAX_FD>
+int FileManager<HwAlarm, Names, NMAX_FD>::pipe(int fds[2], int flags) {
+  if (!fds) return -EFAULT;
+  if (flags & ~O_NONBLOCK) return -EINVAL;
+
+  auto it = std::find_if(_pipes.begin(), _pipes.end(),
+                         [](const PipeType &p) { return !p.inUse(); });
+  if (it == _pipes.end()) return -ENFILE;
+
+  auto node = &_pipe_nodes[std::distance(_pipes.begin(), it)];
+  const auto rd = _open(node, O_RDONLY | flags);
+  if (rd < 0) return rd;
+
+  const auto wr = _open(node, O_WRONLY | flags);
+  if (wr < 0) {
+    close(rd);
+    return wr;
+  }
+
+  fds[0] = rd;
+  fds[1] = wr;
+  return 0;
+}
+
+template <typename HwAlarm, typename Names, int NMAX_FD>
+int FileManager<HwAlarm, Names, NMAX_FD>::ioSubmit(const io_sqe *sqes,
+                                                   unsigned nr) {
+  if (!sqes) return -EFAULT;
+
+  unsigned n = 0;
+  for (auto &entry : _io) {
+    if (n == nr) break;
+    if (entry.state != IoEntry::FREE) continue;
+
+    if (sqes[n].opcode > IORING_OP_WRITE) break;
+    entry = {.state = IoEntry::PENDING, .seq = _io_seq++, .sqe = sqes[n]};
+    ++n;
+  }
+
+  /* The first request is invalid, or the ring is full */
+  if (!n && nr) return sqes[0].opcode > IORING_OP_WRITE ? -EINVAL : -EBUSY;
+
+  _ioAdvance();
+  return n;
+}
+
+template <typename HwAlarm, typename Names, int NMAX_FD>
+int FileManager<HwAlarm, Names, NMAX_FD>::ioWait(io_cqe *cqes, unsigned min,
+                                                 unsigned max, int timeout) {
+  if (!cqes || !max || min > max) return -EINVAL;
+
+  /* A negative timeout blocks indefinitely, a zero one doesn't block */
+  Deadline deadline(timeout < 0 ? Deadline::NONE : timeout * 1000ULL);
+  unsigned n = 0;
+
+  while (true) {
+    _ioAdvance();
+
+    /* Reap in submission order */
+    unsigned in_flight = 0;
+    while (n < max) {
+      IoEntry *first = nullptr;
+      in_flight = 0;
+      for (auto &entry : _io) {
+        if (entry.state == IoEntry::FREE) continue;
+
+        ++in_flight;
+        if (entry.state == IoEntry::DONE &&
+            (!first || entry.seq - first->seq > UINT32_MAX / 2))
+          first = &entry;
+      }
+      if (!first) break;
+
+      cqes[n++] = {.user_data = first->sqe.user_data, .res = first->res};
+      first->state = IoEntry::FREE;
+    }
+
+    if (n >= std::min(min, n + in_flight) || deadline.expired()) return n;
+
+    /* Until a node notifies, is due for sampling, or the timeout expires */
+    auto wait = deadline.remaining();
+    for (const auto &entry : _io) {
+      if (entry.state != IoEntry::PENDING || !_files[entry.sqe.fd].node)
+        continue;
+
+      const auto period = _files[entry.sqe.fd].node->cdev.pollPeriod();
+      if (period.count() > 0)
+        wait = std::min<typename HwAlarm::NanoSeconds>(wait, period);
+    }
+
+    _sleep(wait);
+  }
+}
+
+template <typename HwAlarm, typename Names, int NMAX_FD>
+void FileManager<HwAlarm, Names, NMAX_FD>::_ioAdvance() {
+  /* Completing a request may unblock the next one on the same fd */
+  for (bool progress = true; progress;) {
+    progress = false;
+
+    for (auto &entry : _io) {
+      if (entry.state != IoEntry::PENDING) continue;
+
+      const auto blocked = std::any_of(
+          _io.cbegin(), _io.cend(), [&entry](const IoEntry &other) {
+            return other.state == IoEntry::PENDING &&
+                   other.sqe.fd == entry.sqe.fd &&
+                   entry.seq - other.seq - 1 < UINT32_MAX / 2;
+          });
+
+      if (!blocked && _ioIssue(entry)) progress = true;
+    }
+  }
+}
+
+template <typename HwAlarm, typename Names, int NMAX_FD>
+bool FileManager<HwAlarm, Names, NMAX_FD>::_ioIssue(IoEntry &entry) {
+  const auto fd = entry.sqe.fd;
+  int ret;
+
+  if (entry.sqe.opcode == IORING_OP_NOP) {
+    ret = 0;
+  } else if (fd < 0 || fd >= NMAX_FD || !_files[fd].node) {
+    ret = -EBADF;
+  } else {
+    const auto is_read = entry.sqe.opcode == IORING_OP_READ;
+    auto &ofile = _files[fd].ofile;
+
+    /* Retried at once only if the node got ready before being armed */
+    for (auto retry = true;; retry = false) {
+      /* Never block: the request is retried when the node notifies */
+      const auto flags = ofile.flags;
+      ofile.flags |= FNONBLOCK;
+
+      ret = is_read ? read(fd, entry.sqe.buf, entry.sqe.len)
+                    : write(fd, entry.sqe.buf, entry.sqe.len);
+
+      ofile.flags = flags;
+      if (ret != -EAGAIN) break;
+      if (!retry) return false;
+
+      /* Polling arms the notification, unless the node got ready meanwhile */
+      const auto mask = _dispatch(
+          _files[fd].node, [&](auto &&cdev) { return cdev.poll(ofile); });
+      if (!(mask & (is_read ? EPOLLIN : EPOLLOUT))) return false;
+    }
   }
+
+  entry.res = ret;
+  entry.state = IoEntry::DONE;
+  return true;
 }
 
-#endif  // FILEMANAGER_TPP
\ No newline at end of file
+#endif  // FILEMANAGER_TPP
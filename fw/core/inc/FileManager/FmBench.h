@@ -0,0 +1,18 @@
+/**
+ * @file     FmBench.h
+ * @author   Fabio Scatozza <s315216@studenti.polito.it>
+ * @date     18.10.2026
+ *
+ * Cycles per system call of the FileManager, with the file operations
+ * dispatched through the IFile vtable (NodeNames) and with the jump table of
+ * NodeDrivers. Enabled by the FM_BENCH option, the results are printed with
+ * PRINTD, therefore in Debug builds.
+ */
+
+#ifndef FMBENCH_H
+#define FMBENCH_H
+
+/* Requires the DWT cycle counter, see dwt::init() */
+void fmBench();
+
+#endif // FMBENCH_H
@@ -0,0 +1,55 @@
+/**
+ * @file     FmStats.hpp
+ * @author   Fabio Scatozza <s315216@studenti.polito.it>
+ * @date     18.10.2026
+ *
+ * Per-node counters and latency histograms of the FileManager system calls,
+ * measured with the DWT cycle counter and read back through a read-only
+ * pseudo-file, whose content is laid out as in fmstats.h
+ */
+
+#ifndef FMSTATS_HPP
+#define FMSTATS_HPP
+
+#include <eventpoll.h>
+#include <fmstats.h>
+
+#include <array>
+
+#include "IFile.h"
+
+template <size_t N_NODES>
+class FmStats : public IFile {
+ public:
+  explicit FmStats(const std::array<const char *, N_NODES> &names);
+
+  /* Read-only, O_TRUNC clears the counters */
+  int open(OFile &ofile) override;
+  int close(OFile &ofile) override;
+  off_t llseek(OFile &ofile, off_t offset, int whence) override;
+  ssize_t read(OFile &ofile, char *buf, size_t count, off_t &pos) override;
+  /* The table, read-only, updated in place */
+  ssize_t mmap(OFile &ofile, int prot, void *&addr) override;
+
+  /**
+   * @brief Account a system call to a node
+   * @param node Index in the order of registration
+   * @param op FM_STATS_OPEN, ..., FM_STATS_SELECT
+   * @param ret Return of the call: byte count, event mask, or -errno
+   * @param cycles Latency of the call
+   */
+  void record(size_t node, size_t op, long ret, uint32_t cycles);
+
+  void clear();
+
+ private:
+  using StatsTable = std::array<fm_node_stats, N_NODES>;
+
+  static constexpr off_t SIZE = sizeof(StatsTable);
+
+  StatsTable _stats;
+};
+
+#include "FmStats.tpp"
+
+#endif // FMSTATS_HPP
@@ -0,0 +1,107 @@
+/**
+ * @file     FmStats.tpp
+ * @author   Fabio Scatozza <s315216@studenti.polito.it>
+ * @date     18.10.2026
+ */
+
+#ifndef FMSTATS_TPP
+#define FMSTATS_TPP
+
+#include <fcntl.h>
+#include <mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <bit>
+#include <cerrno>
+#include <cstring>
+
+template <size_t N_NODES>
+FmStats<N_NODES>::FmStats(const std::array<const char *, N_NODES> &names)
+    : _stats{} {
+  for (size_t i = 0; i < N_NODES; ++i)
+    strncpy(_stats[i].name, names[i], FM_STATS_NAME_LEN - 1);
+}
+
+template <size_t N_NODES>
+int FmStats<N_NODES>::open(OFile &ofile) {
+  if (ofile.mode != FREAD) return -EINVAL;
+
+  if (ofile.flags & FTRUNC) clear();
+  return 0;
+}
+
+template <size_t N_NODES>
+int FmStats<N_NODES>::close([[maybe_unused]] OFile &ofile) {
+  return 0;
+}
+
+template <size_t N_NODES>
+off_t FmStats<N_NODES>::llseek(OFile &ofile, off_t offset, int whence) {
+  off_t pos;
+
+  switch (whence) {
+    case SEEK_SET:
+      pos = offset;
+      break;
+    case SEEK_CUR:
+      pos = ofile.pos + offset;
+      break;
+    case SEEK_END:
+      pos = SIZE + offset;
+      break;
+    default:
+      return -EINVAL;
+  }
+
+  if (pos < 0) return -EINVAL;
+  return ofile.pos = pos;
+}
+
+template <size_t N_NODES>
+ssize_t FmStats<N_NODES>::read([[maybe_unused]] OFile &ofile, char *buf,
+                               size_t count, off_t &pos) {
+  if (pos >= SIZE) return 0;
+
+  /* Counters are only updated in thread mode: the copy is consistent */
+  count = std::min<size_t>(count, SIZE - pos);
+  std::copy_n(reinterpret_cast<const char *>(_stats.data()) + pos, count, buf);
+
+  pos += count;
+  return count;
+}
+
+template <size_t N_NODES>
+ssize_t FmStats<N_NODES>::mmap([[maybe_unused]] OFile &ofile, int prot,
+                               void *&addr) {
+  if (prot & PROT_WRITE) return -EACCES;
+
+  addr = _stats.data();
+  return SIZE;
+}
+
+template <size_t N_NODES>
+void FmStats<N_NODES>::record(size_t node, size_t op, long ret,
+                              uint32_t cycles) {
+  auto &s = _stats[node].ops[op];
+
+  s.calls++;
+  if (ret == -EAGAIN)
+    s.eagain++;
+  else if (ret < 0 ||
+           (op == FM_STATS_POLL && (static_cast<__poll_t>(ret) & EPOLLERR)))
+    s.errors++;
+  else if (op == FM_STATS_READ || op == FM_STATS_WRITE)
+    s.bytes += ret;
+
+  s.max_cycles = std::max(s.max_cycles, cycles);
+  s.hist[std::min<size_t>(std::bit_width(cycles), FM_STATS_NBINS - 1)]++;
+}
+
+template <size_t N_NODES>
+void FmStats<N_NODES>::clear() {
+  for (auto &node : _stats)
+    std::fill(std::begin(node.ops), std::end(node.ops), fm_op_stats{});
+}
+
+#endif // FMSTATS_TPP
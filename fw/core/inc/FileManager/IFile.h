@@ -11,6 +11,12 @@
 #include <types.h>
 
 #include <cerrno>
+#include <chrono>
+
+#include "EpItem.h"
+#include "WaitQueue.h"
+#include "ioctl.h"
+#include "uio.h"
 
 /* Represents an open file */
 struct OFile {
@@ -43,6 +49,105 @@ public:
     return -ENOSYS;
   }
   virtual __poll_t poll([[maybe_unused]] OFile &ofile) { return -ENOSYS; }
+
+  /* Reconfigure an open file, arg pointing to the argument of the request */
+  virtual int ioctl([[maybe_unused]] OFile &ofile,
+                    [[maybe_unused]] unsigned long request,
+                    [[maybe_unused]] void *arg) {
+    return -ENOTTY;
+  }
+
+  /* Vectored I/O: one read()/write() per segment, up to a short transfer */
+  virtual ssize_t readv(OFile &ofile, const iovec *iov, int iovcnt,
+                        off_t &pos) {
+    ssize_t total = 0;
+    for (auto i = 0; i < iovcnt; ++i) {
+      const auto ret = read(ofile, static_cast<char *>(iov[i].iov_base),
+                            iov[i].iov_len, pos);
+      if (ret < 0) return total ? total : ret;
+
+      total += ret;
+      if (static_cast<size_t>(ret) < iov[i].iov_len) break;
+    }
+    return total;
+  }
+  virtual ssize_t writev(OFile &ofile, const iovec *iov, int iovcnt,
+                         off_t &pos) {
+    ssize_t total = 0;
+    for (auto i = 0; i < iovcnt; ++i) {
+      const auto ret = write(ofile, static_cast<const char *>(iov[i].iov_base),
+                             iov[i].iov_len, pos);
+      if (ret < 0) return total ? total : ret;
+
+      total += ret;
+      if (static_cast<size_t>(ret) < iov[i].iov_len) break;
+    }
+    return total;
+  }
+
+  /* Buffer loan: up to count bytes of the transfer buffer, in place of buf */
+  virtual ssize_t acquire([[maybe_unused]] OFile &ofile,
+                          [[maybe_unused]] char *&buf,
+                          [[maybe_unused]] size_t count) {
+    return -ENOSYS;
+  }
+  /* Transfer the first count bytes of the loan, which ends */
+  virtual ssize_t commit([[maybe_unused]] OFile &ofile,
+                         [[maybe_unused]] size_t count,
+                         [[maybe_unused]] off_t &pos) {
+    return -ENOSYS;
+  }
+
+  /* Memory-resident content, accessed in place: its address and length, with
+   * the access prot (PROT_READ, PROT_WRITE) of mman.h */
+  virtual ssize_t mmap([[maybe_unused]] OFile &ofile,
+                       [[maybe_unused]] int prot,
+                       [[maybe_unused]] void *&addr) {
+    return -ENODEV;
+  }
+
+  /* Devices that cannot notify() readiness changes are polled at this
+   * period, while select() waits */
+  virtual std::chrono::microseconds pollPeriod() const { return {}; }
+
+  /* By the FileManager the node is registered with */
+  void setWaitQueue(WaitQueue *wq) { _wq = wq; }
+
+  /* By epoll instances */
+  void watch(EpItem &item) {
+    const auto primask = __get_PRIMASK();
+    __disable_irq();
+    item.next_watch = _ep_items;
+    _ep_items = &item;
+    __set_PRIMASK(primask);
+  }
+
+  void unwatch(EpItem &item) {
+    const auto primask = __get_PRIMASK();
+    __disable_irq();
+    for (auto p = &_ep_items; *p; p = &(*p)->next_watch) {
+      if (*p == &item) {
+        *p = item.next_watch;
+        break;
+      }
+    }
+    __set_PRIMASK(primask);
+  }
+
+protected:
+  /*
+   * Readiness may have changed: queues the epoll items watching the node, and
+   * wakes up select() or epoll_wait(). From ISRs
+   */
+  RAMFUNC void notify() const {
+    for (auto item = _ep_items; item; item = item->next_watch)
+      item->rdl->push(*item);
+    if (_wq) _wq->wake();
+  }
+
+private:
+  WaitQueue *_wq = nullptr;
+  EpItem *_ep_items = nullptr;
 };
 
 inline IFile::~IFile() {}
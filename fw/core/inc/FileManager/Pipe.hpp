@@ -0,0 +1,65 @@
+/**
+ * @file     Pipe.hpp
+ * @author   Fabio Scatozza <s315216@studenti.polito.it>
+ * @date     18.10.2026
+ * @see      https://github.com/torvalds/linux/blob/master/fs/pipe.c
+ *
+ * Anonymous pipe, over a ring buffer in RAM. The write end can lend the free
+ * space of the ring, so that a producer formats its data in place, and the
+ * consumer reads it with a single copy. Both ends notify() the other as they
+ * consume or produce.
+ * Both ends are served in thread mode, so nothing can make progress while a
+ * call blocks: one that would wait fails with -EDEADLK instead (-EAGAIN with
+ * O_NONBLOCK). A task waits for the other end with select(), epoll or the
+ * I/O ring.
+ */
+
+#ifndef PIPE_HPP
+#define PIPE_HPP
+
+#include <array>
+#include <bit>
+
+#include "IFile.h"
+
+template <size_t SIZE>
+class Pipe : public IFile {
+  static_assert(std::has_single_bit(SIZE), "SIZE must be a power of 2");
+
+ public:
+  /* One read end, O_RDONLY, and one write end, O_WRONLY */
+  int open(OFile &ofile) override;
+  int close(OFile &ofile) override;
+  off_t llseek(OFile &ofile, off_t offset, int whence) override;
+
+  /* Up to count bytes, 0 once empty and the write end is closed */
+  ssize_t read(OFile &ofile, char *buf, size_t count, off_t &pos) override;
+  /* Non-blocking writes of up to SIZE bytes are all-or-nothing, blocking
+   * ones are short once full. -EPIPE once the read end is closed */
+  ssize_t write(OFile &ofile, const char *buf, size_t count,
+                off_t &pos) override;
+  __poll_t poll(OFile &ofile) override;
+
+  /* Free space up to the end of the ring, as the loan does not wrap around.
+   * A write() in between ends the loan */
+  ssize_t acquire(OFile &ofile, char *&buf, size_t count) override;
+  ssize_t commit(OFile &ofile, size_t count, off_t &pos) override;
+
+  /* Until both ends are closed */
+  bool inUse() const;
+
+ private:
+  size_t _used() const { return _head - _tail; }
+  size_t _free() const { return SIZE - _used(); }
+
+  std::array<char, SIZE> _buf;
+  size_t _head = 0; /* Free running, masked on access */
+  size_t _tail = 0;
+  size_t _lent = 0;
+  bool _reader = false;
+  bool _writer = false;
+};
+
+#include "Pipe.tpp"
+
+#endif // PIPE_HPP
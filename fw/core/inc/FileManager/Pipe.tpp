@@ -0,0 +1,152 @@
+/**
+ * @file     Pipe.tpp
+ * @author   Fabio Scatozza <s315216@studenti.polito.it>
+ * @date     18.10.2026
+ */
+
+#ifndef PIPE_TPP
+#define PIPE_TPP
+
+#include <eventpoll.h>
+#include <fcntl.h>
+
+#include <algorithm>
+#include <cerrno>
+
+template <size_t SIZE>
+int Pipe<SIZE>::open(OFile &ofile) {
+  switch (ofile.mode) {
+    case FREAD:
+      if (_reader) return -EBUSY;
+      _reader = true;
+      return 0;
+    case FWRITE:
+      if (_writer) return -EBUSY;
+      _writer = true;
+      return 0;
+    default:
+      return -EINVAL;
+  }
+}
+
+template <size_t SIZE>
+int Pipe<SIZE>::close(OFile &ofile) {
+  if (ofile.mode == FREAD) {
+    _reader = false;
+  } else {
+    _writer = false;
+    _lent = 0;
+  }
+
+  if (!inUse()) _head = _tail = 0;
+
+  /* Hang-up, or broken pipe, for the other end */
+  notify();
+  return 0;
+}
+
+template <size_t SIZE>
+off_t Pipe<SIZE>::llseek([[maybe_unused]] OFile &ofile,
+                         [[maybe_unused]] off_t offset,
+                         [[maybe_unused]] int whence) {
+  return -ESPIPE;
+}
+
+template <size_t SIZE>
+ssize_t Pipe<SIZE>::read(OFile &ofile, char *buf, size_t count,
+                         [[maybe_unused]] off_t &pos) {
+  if (!count) return 0;
+
+  if (!_used()) {
+    if (!_writer) return 0;
+    return ofile.flags & FNONBLOCK ? -EAGAIN : -EDEADLK;
+  }
+
+  /* At most two chunks, as the data may wrap around */
+  count = std::min(count, _used());
+  const auto tail = _tail & (SIZE - 1);
+  const auto first = std::min(count, SIZE - tail);
+  std::copy_n(_buf.data() + tail, first, buf);
+  std::copy_n(_buf.data(), count - first, buf + first);
+  _tail += count;
+
+  notify();
+  return count;
+}
+
+template <size_t SIZE>
+ssize_t Pipe<SIZE>::write(OFile &ofile, const char *buf, size_t count,
+                          [[maybe_unused]] off_t &pos) {
+  if (!_reader) return -EPIPE;
+
+  _lent = 0;
+  if (!count) return 0;
+
+  const bool nonblock = ofile.flags & FNONBLOCK;
+  if (!_free()) return nonblock ? -EAGAIN : -EDEADLK;
+  if (nonblock && count <= SIZE && _free() < count) return -EAGAIN;
+
+  /* At most two chunks, as the free space may wrap around */
+  count = std::min(count, _free());
+  const auto head = _head & (SIZE - 1);
+  const auto first = std::min(count, SIZE - head);
+  std::copy_n(buf, first, _buf.data() + head);
+  std::copy_n(buf + first, count - first, _buf.data());
+  _head += count;
+
+  notify();
+  return count;
+}
+
+template <size_t SIZE>
+__poll_t Pipe<SIZE>::poll(OFile &ofile) {
+  __poll_t mask = 0;
+
+  if (ofile.mode == FREAD) {
+    if (_used()) mask |= EPOLLIN | EPOLLRDNORM;
+    if (!_writer) mask |= EPOLLHUP;
+  } else {
+    if (!_reader)
+      mask |= EPOLLERR;
+    else if (_free())
+      mask |= EPOLLOUT | EPOLLWRNORM;
+  }
+
+  return mask;
+}
+
+template <size_t SIZE>
+ssize_t Pipe<SIZE>::acquire(OFile &ofile, char *&buf, size_t count) {
+  if (!_reader) return -EPIPE;
+
+  if (!_free()) return ofile.flags & FNONBLOCK ? -EAGAIN : -EDEADLK;
+
+  /* Drained: rewind, for the largest contiguous loan */
+  if (!_used()) _head = _tail = 0;
+
+  const auto head = _head & (SIZE - 1);
+  _lent = std::min({count, _free(), SIZE - head});
+  buf = _buf.data() + head;
+  return _lent;
+}
+
+template <size_t SIZE>
+ssize_t Pipe<SIZE>::commit([[maybe_unused]] OFile &ofile, size_t count,
+                           [[maybe_unused]] off_t &pos) {
+  if (!_lent || count > _lent) return -EINVAL;
+
+  _lent = 0;
+  if (count) {
+    _head += count;
+    notify();
+  }
+
+  return count;
+}
+
+template <size_t SIZE>
+bool Pipe<SIZE>::inUse() const {
+  return _reader || _writer;
+}
+
+#endif // PIPE_TPP
@@ -0,0 +1,18 @@
+/**
+ * @file     FmtBench.h
+ * @author   Fabio Scatozza <s315216@studenti.polito.it>
+ * @date     18.10.2026
+ *
+ * Cycles per formatted line of the compile-time engine (Format.hpp), against
+ * newlib vsnprintf, for the lines of the display and of the log. Enabled by
+ * the FMT_BENCH option, the results are printed with PRINTD, therefore in
+ * Debug builds.
+ */
+
+#ifndef FMTBENCH_H
+#define FMTBENCH_H
+
+/* Requires the DWT cycle counter, see dwt::init() */
+void fmtBench();
+
+#endif // FMTBENCH_H
@@ -0,0 +1,137 @@
+/**
+ * @file     Format.hpp
+ * @author   Fabio Scatozza <s315216@studenti.polito.it>
+ * @date     18.10.2026
+ * @see      https://en.cppreference.com/w/cpp/io/c/fprintf
+ *
+ * printf-compatible formatting, with the format string parsed at compile
+ * time: each conversion is bound to its argument, whose type is checked, and
+ * expands to the code for its base, flags, width and precision, while the
+ * literal text is copied with constant lengths. Conversions are
+ *   %[flags][width][.precision][length]conversion
+ * with flags "-0+ #" and conversions "diuoxXcsp%". The argument types are
+ * known, hence length modifiers other than h and hh, which narrow the
+ * argument, are accepted and ignored; widths and precisions given by * are not
+ * supported. Integer arguments are promoted, then reinterpreted as signed or
+ * unsigned as the conversion requires, as by printf. Fixed-point values,
+ * wrapped by fmt::fixed<DECIMALS>(), are printed by %d, %i and %u with
+ * DECIMALS digits past the point.
+ */
+
+#ifndef FORMAT_HPP
+#define FORMAT_HPP
+
+#include <array>
+#include <cstdint>
+#include <concepts>
+#include <cstddef>
+#include <cstdio>
+#include <string_view>
+#include <tuple>
+
+#include "FixedString.hpp"
+
+namespace fmt {
+
+/* Size of the chunks of print(), if the output is not bounded below it */
+constexpr size_t PRINT_CHUNK = 64;
+
+/* Integer scaled by 10^DECIMALS */
+template <unsigned DECIMALS, std::integral T>
+struct Fixed {
+  T scaled;
+};
+
+template <unsigned DECIMALS, std::integral T>
+constexpr Fixed<DECIMALS, T> fixed(T scaled) {
+  return {scaled};
+}
+
+/**
+ * @brief As snprintf(), without the terminator
+ * @return Length of the whole output, of which at most cap characters are
+ * written to buf
+ */
+template <FixedString FMT, typename... Args>
+size_t format(char *buf, size_t cap, const Args &...args);
+
+/**
+ * @brief As fprintf(), through the stdio buffer of stream
+ * @return Length of the output, or -1
+ */
+template <FixedString FMT, typename... Args>
+int print(FILE *stream, const Args &...args);
+
+/* Upper bound of the output length, SIZE_MAX if unbounded (%s without
+ * precision) */
+template <FixedString FMT, typename... Args>
+consteval size_t maxLength();
+
+namespace detail {
+
+/* Conversion, preceded by the literal text since the previous one */
+struct Spec {
+  size_t lit = 0;
+  size_t lit_len = 0;
+  char conv = 0; /* 0 for the trailing literal text */
+  bool left = false;
+  bool zero = false;
+  bool alt = false;
+  char sign = 0; /* '+', ' ' */
+  size_t width = 0;
+  int prec = -1;
+  uint8_t narrow = 0; /* Bits, for h and hh */
+  size_t arg = 0; /* Index of the argument, their count for conv 0 */
+};
+
+/* Not defined: called while parsing a malformed format string, so that it
+ * does not compile */
+void invalidFormat();
+
+/* Number of specs, filled in if not null */
+constexpr size_t parse(std::string_view fmt, Spec *specs);
+
+template <FixedString FMT>
+inline constexpr auto SPECS = [] {
+  std::array<Spec, parse(FMT.view(), nullptr)> specs{};
+  parse(FMT.view(), specs.data());
+  return specs;
+}();
+
+/* Bounded output, which spills into a stdio stream if any */
+class Sink {
+ public:
+  Sink(char *buf, size_t cap, FILE *spill = nullptr)
+      : _buf(buf), _cap(cap), _spill(spill) {}
+
+  void put(char c);
+  void put(const char *s, size_t n);
+  void fill(char c, size_t n);
+
+  /* Into the stream. False on errors */
+  bool flush();
+
+  /* Whole output, whether written or not */
+  size_t size() const { return _len; }
+
+ private:
+  bool _drain();
+
+  char *_buf;
+  size_t _cap;
+  FILE *_spill;
+  size_t _pos = 0;
+  size_t _len = 0;
+  bool _err = false;
+};
+
+template <FixedString FMT, typename... Args>
+void emit(Sink &out, const Args &...args);
+
+} // namespace detail
+
+} // namespace fmt
+
+#include "Format.tpp"
+
+#endif // FORMAT_HPP
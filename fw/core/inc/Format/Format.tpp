@@ -0,0 +1,362 @@
+/**
+ * @file     Format.tpp
+ * @author   Fabio Scatozza <s315216@studenti.polito.it>
+ * @date     18.10.2026
+ */
+
+#ifndef FORMAT_TPP
+#define FORMAT_TPP
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+#include <utility>
+
+namespace fmt {
+
+namespace detail {
+
+constexpr size_t parse(std::string_view fmt, Spec *specs) {
+  constexpr std::string_view FLAGS = "-0+ #";
+  constexpr std::string_view LENGTHS = "hljztL";
+  constexpr std::string_view CONVS = "diuoxXcsp%";
+
+  size_t n = 0;
+  size_t arg = 0;
+  size_t lit = 0;
+
+  while (true) {
+    const auto pct = fmt.find('%', lit);
+    Spec s{.lit = lit,
+           .lit_len = (pct == fmt.npos ? fmt.size() : pct) - lit,
+           .arg = arg};
+
+    if (pct == fmt.npos) {
+      if (specs) specs[n] = s;
+      return n + 1;
+    }
+
+    auto i = pct + 1;
+    for (; i < fmt.size() && FLAGS.find(fmt[i]) != FLAGS.npos; ++i) {
+      switch (fmt[i]) {
+        case '-': s.left = true; break;
+        case '0': s.zero = true; break;
+        case '#': s.alt = true; break;
+        default: if (s.sign != '+') s.sign = fmt[i];
+      }
+    }
+
+    for (; i < fmt.size() && fmt[i] >= '0' && fmt[i] <= '9'; ++i)
+      s.width = s.width * 10 + (fmt[i] - '0');
+
+    if (i < fmt.size() && fmt[i] == '.') {
+      s.prec = 0;
+      for (++i; i < fmt.size() && fmt[i] >= '0' && fmt[i] <= '9'; ++i)
+        s.prec = s.prec * 10 + (fmt[i] - '0');
+    }
+
+    for (; i < fmt.size() && LENGTHS.find(fmt[i]) != LENGTHS.npos; ++i)
+      if (fmt[i] == 'h') s.narrow = s.narrow ? 8 : 16;
+
+    if (i == fmt.size() || CONVS.find(fmt[i]) == CONVS.npos) invalidFormat();
+    s.conv = fmt[i];
+    if (s.conv != '%') ++arg;
+
+    if (specs) specs[n] = s;
+    ++n;
+    lit = i + 1;
+  }
+}
+
+inline void Sink::put(char c) {
+  if (_pos == _cap && !_drain()) {
+    ++_len;
+    return;
+  }
+
+  _buf[_pos++] = c;
+  ++_len;
+}
+
+inline void Sink::put(const char *s, size_t n) {
+  while (n) {
+    if (_pos == _cap && !_drain()) {
+      _len += n;
+      return;
+    }
+
+    const auto k = std::min(n, _cap - _pos);
+    std::copy_n(s, k, _buf + _pos);
+    _pos += k;
+    _len += k;
+    s += k;
+    n -= k;
+  }
+}
+
+inline void Sink::fill(char c, size_t n) {
+  while (n) {
+    if (_pos == _cap && !_drain()) {
+      _len += n;
+      return;
+    }
+
+    const auto k = std::min(n, _cap - _pos);
+    std::fill_n(_buf + _pos, k, c);
+    _pos += k;
+    _len += k;
+    n -= k;
+  }
+}
+
+inline bool Sink::flush() { return _drain(); }
+
+inline bool Sink::_drain() {
+  if (!_spill || _err) return false;
+
+  if (_pos && fwrite(_buf, 1, _pos, _spill) != _pos) _err = true;
+  _pos = 0;
+  return !_err;
+}
+
+template <typename T>
+struct IsFixed : std::false_type {};
+template <unsigned DECIMALS, typename T>
+struct IsFixed<Fixed<DECIMALS, T>> : std::true_type {};
+
+template <Spec S>
+constexpr unsigned base() {
+  if constexpr (S.conv == 'x' || S.conv == 'X' || S.conv == 'p') return 16;
+  if constexpr (S.conv == 'o') return 8;
+  return 10;
+}
+
+/* Digits of the magnitude, POINT of them past the point */
+template <Spec S, unsigned POINT, typename U>
+void emitInt(Sink &out, U mag, bool neg) {
+  constexpr auto BASE = base<S>();
+  constexpr auto DIGITS =
+      S.conv == 'X' ? "0123456789ABCDEF" : "0123456789abcdef";
+  constexpr bool SIGNED = S.conv == 'd' || S.conv == 'i';
+
+  char tmp[std::numeric_limits<U>::digits + POINT + 2];
+  const auto end = tmp + sizeof(tmp);
+  auto p = end;
+
+  const bool nonzero = mag != 0;
+  size_t n = 0;
+  if (POINT || S.prec || nonzero) {
+    do {
+      if (POINT && n == POINT) *--p = '.';
+      *--p = DIGITS[mag % BASE];
+      mag /= BASE;
+      ++n;
+    } while (mag || n <= POINT);
+  }
+
+  if constexpr (BASE == 8 && S.alt) {
+    if (p == end || *p != '0') {
+      *--p = '0';
+      ++n;
+    }
+  }
+
+  /* Prefix: sign, then 0x */
+  char prefix[3];
+  size_t prefix_len = 0;
+  if (neg)
+    prefix[prefix_len++] = '-';
+  else if (SIGNED && S.sign)
+    prefix[prefix_len++] = S.sign;
+
+  if constexpr (S.conv == 'p' || (BASE == 16 && S.alt)) {
+    if (S.conv == 'p' || nonzero) {
+      prefix[prefix_len++] = '0';
+      prefix[prefix_len++] = S.conv == 'X' ? 'X' : 'x';
+    }
+  }
+
+  const auto len = static_cast<size_t>(end - p);
+  size_t zeros = (!POINT && S.prec > 0 && static_cast<size_t>(S.prec) > n)
+                     ? S.prec - n
+                     : 0;
+  auto body = prefix_len + zeros + len;
+  if (S.zero && !S.left && S.prec < 0 && S.width > body) {
+    zeros += S.width - body;
+    body = S.width;
+  }
+
+  const auto pad = S.width > body ? S.width - body : 0;
+  if (!S.left) out.fill(' ', pad);
+  out.put(prefix, prefix_len);
+  out.fill('0', zeros);
+  out.put(p, len);
+  if (S.left) out.fill(' ', pad);
+}
+
+/* Of a signed value, not overflowing on the minimum */
+template <typename U, typename I>
+constexpr U magnitude(I v) {
+  return v < 0 ? static_cast<U>(U{0} - static_cast<U>(v)) : static_cast<U>(v);
+}
+
+template <Spec S>
+void emitPadded(Sink &out, const char *s, size_t n) {
+  const auto pad = S.width > n ? S.width - n : 0;
+  if (!S.left) out.fill(' ', pad);
+  out.put(s, n);
+  if (S.left) out.fill(' ', pad);
+}
+
+template <Spec S, typename T>
+void emitArg(Sink &out, const T &v) {
+  if constexpr (S.conv == 'c') {
+    static_assert(std::is_integral_v<T>, "%c takes an integer");
+    const auto c = static_cast<char>(v);
+    emitPadded<S>(out, &c, 1);
+  } else if constexpr (S.conv == 's') {
+    static_assert(std::is_convertible_v<const T &, const char *>,
+                  "%s takes a C string");
+    if constexpr (std::is_convertible_v<const T &, const char *>) {
+      const char *s = v;
+      emitPadded<S>(out, s, S.prec < 0 ? strlen(s) : strnlen(s, S.prec));
+    }
+  } else if constexpr (S.conv == 'p') {
+    static_assert(std::is_pointer_v<T>, "%p takes a pointer");
+    emitInt<S, 0>(out, reinterpret_cast<uintptr_t>(v), false);
+  } else if constexpr (IsFixed<T>::value) {
+    static_assert(S.conv == 'd' || S.conv == 'i' || S.conv == 'u',
+                  "Fixed-point values take %d, %i or %u");
+    static_assert(S.prec < 0, "Fixed-point values take no precision");
+    [&]<unsigned DECIMALS, typename I>(const Fixed<DECIMALS, I> &f) {
+      using P = decltype(+f.scaled);
+      using U = std::make_unsigned_t<P>;
+      if constexpr (S.conv == 'u') {
+        emitInt<S, DECIMALS>(out, static_cast<U>(f.scaled), false);
+      } else {
+        const auto sv = static_cast<std::make_signed_t<P>>(f.scaled);
+        emitInt<S, DECIMALS>(out, magnitude<U>(sv), sv < 0);
+      }
+    }(v);
+  } else {
+    static_assert(std::is_integral_v<T>, "Integer conversions take an integer");
+    using P = std::conditional_t<
+        S.narrow == 8, int8_t,
+        std::conditional_t<S.narrow == 16, int16_t, decltype(+v)>>;
+    using U = std::make_unsigned_t<P>;
+    if constexpr (S.conv == 'd' || S.conv == 'i') {
+      const auto sv = static_cast<std::make_signed_t<P>>(v);
+      emitInt<S, 0>(out, magnitude<U>(sv), sv < 0);
+    } else {
+      emitInt<S, 0>(out, static_cast<U>(v), false);
+    }
+  }
+}
+
+template <FixedString FMT, Spec S, typename Tuple>
+void emitSpec(Sink &out, const Tuple &args) {
+  if constexpr (S.lit_len > 0) out.put(FMT.str + S.lit, S.lit_len);
+
+  if constexpr (S.conv == '%')
+    out.put('%');
+  else if constexpr (S.conv)
+    emitArg<S>(out, std::get<S.arg>(args));
+}
+
+template <FixedString FMT, typename... Args>
+void emit(Sink &out, const Args &...args) {
+  constexpr auto &specs = SPECS<FMT>;
+  static_assert(specs.back().arg == sizeof...(Args),
+                "Arguments do not match the format string");
+
+  if constexpr (specs.back().arg == sizeof...(Args)) {
+    const std::tuple<const Args &...> argt(args...);
+    [&]<size_t... I>(std::index_sequence<I...>) {
+      (emitSpec<FMT, specs[I]>(out, argt), ...);
+    }(std::make_index_sequence<specs.size()>{});
+  }
+}
+
+template <Spec S, typename T>
+consteval size_t argMaxLength() {
+  size_t n;
+
+  if constexpr (S.conv == 'c') {
+    n = 1;
+  } else if constexpr (S.conv == 's') {
+    n = S.prec < 0 ? SIZE_MAX : S.prec;
+  } else {
+    using I = decltype([] {
+      if constexpr (IsFixed<T>::value)
+        return +T{}.scaled;
+      else if constexpr (std::is_pointer_v<T>)
+        return uintptr_t{};
+      else
+        return +T{};
+    }());
+    constexpr auto BITS = std::numeric_limits<std::make_unsigned_t<I>>::digits;
+    constexpr auto BASE = base<S>();
+
+    /* Digits, then point, sign and prefix */
+    n = BASE == 16 ? (BITS + 3) / 4 : BASE == 8 ? (BITS + 2) / 3 + 1
+                                                : BITS * 302 / 1000 + 1;
+    n = std::max<size_t>(n, S.prec < 0 ? 0 : S.prec);
+    if constexpr (IsFixed<T>::value) n += 2;
+    n += 3;
+  }
+
+  return std::max(n, S.width);
+}
+
+} // namespace detail
+
+template <FixedString FMT, typename... Args>
+size_t format(char *buf, size_t cap, const Args &...args) {
+  detail::Sink out(buf, cap);
+  detail::emit<FMT>(out, args...);
+  return out.size();
+}
+
+template <FixedString FMT, typename... Args>
+int print(FILE *stream, const Args &...args) {
+  /* Output bounded by the chunk size is written at once */
+  constexpr auto SIZE =
+      std::clamp<size_t>(maxLength<FMT, Args...>(), 1, PRINT_CHUNK);
+
+  char buf[SIZE];
+  detail::Sink out(buf, SIZE, stream);
+  detail::emit<FMT>(out, args...);
+  return out.flush() ? static_cast<int>(out.size()) : -1;
+}
+
+template <FixedString FMT, typename... Args>
+consteval size_t maxLength() {
+  constexpr auto &specs = detail::SPECS<FMT>;
+  static_assert(specs.back().arg == sizeof...(Args),
+                "Arguments do not match the format string");
+
+  using Tuple = std::tuple<Args...>;
+  return [&]<size_t... I>(std::index_sequence<I...>) {
+    size_t n = 0;
+    const auto add = [&n](size_t k) {
+      n = (k > SIZE_MAX - n) ? SIZE_MAX : n + k;
+    };
+
+    (([&] {
+       constexpr auto S = specs[I];
+       add(S.lit_len);
+       if constexpr (S.conv == '%')
+         add(1);
+       else if constexpr (S.conv)
+         add(detail::argMaxLength<S, std::tuple_element_t<S.arg, Tuple>>());
+     }()),
+     ...);
+    return n;
+  }(std::make_index_sequence<specs.size()>{});
+}
+
+} // namespace fmt
+
+#endif // FORMAT_TPP
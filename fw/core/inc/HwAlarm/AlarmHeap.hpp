@@ -0,0 +1,58 @@
+/**
+ * @file     AlarmHeap.hpp
+ * @author   Fabio Scatozza <s315216@studenti.polito.it>
+ * @date     18.10.2026
+ *
+ * Binary min-heap of alarm deadlines. The nodes are owned by the clients and
+ * remember their slot: insert, cancel and re-key are O(log n), with no search
+ */
+
+#ifndef ALARMHEAP_HPP
+#define ALARMHEAP_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "ramfunc.h"
+
+struct AlarmNode {
+  static constexpr size_t UNLINKED = SIZE_MAX;
+
+  bool linked() const { return slot != UNLINKED; }
+
+  uint64_t deadline = 0;
+  size_t slot = UNLINKED;
+};
+
+template <size_t N>
+class AlarmHeap {
+ public:
+  AlarmHeap();
+
+  /* False if full. The node must not be linked already */
+  bool push(AlarmNode &node);
+  /* The node must be linked */
+  void remove(AlarmNode &node);
+  void update(AlarmNode &node, uint64_t deadline);
+
+  /* Earliest deadline, nullptr if empty */
+  AlarmNode *top() const { return _size ? _nodes[0] : nullptr; }
+  size_t size() const { return _size; }
+  bool full() const { return _size == N; }
+
+  /* Heap order, and nodes in the slot they remember: for the host checks */
+  bool valid() const;
+
+ private:
+  void place(size_t slot, AlarmNode *node);
+  void siftUp(size_t slot);
+  void siftDown(size_t slot);
+
+  std::array<AlarmNode *, N> _nodes;
+  size_t _size;
+};
+
+#include "AlarmHeap.tpp"
+
+#endif // ALARMHEAP_HPP
@@ -0,0 +1,93 @@
+/**
+ * @file     AlarmHeap.tpp
+ * @author   Fabio Scatozza <s315216@studenti.polito.it>
+ * @date     18.10.2026
+ */
+
+#ifndef ALARMHEAP_TPP
+#define ALARMHEAP_TPP
+
+template <size_t N>
+AlarmHeap<N>::AlarmHeap() : _nodes{}, _size(0) {}
+
+template <size_t N>
+RAMFUNC void AlarmHeap<N>::place(size_t slot, AlarmNode *node) {
+  _nodes[slot] = node;
+  node->slot = slot;
+}
+
+template <size_t N>
+RAMFUNC void AlarmHeap<N>::siftUp(size_t slot) {
+  const auto node = _nodes[slot];
+
+  while (slot) {
+    const auto parent = (slot - 1) / 2;
+    if (_nodes[parent]->deadline <= node->deadline) break;
+
+    place(slot, _nodes[parent]);
+    slot = parent;
+  }
+  place(slot, node);
+}
+
+template <size_t N>
+RAMFUNC void AlarmHeap<N>::siftDown(size_t slot) {
+  const auto node = _nodes[slot];
+
+  for (;;) {
+    auto child = 2 * slot + 1;
+    if (child >= _size) break;
+
+    /* the earlier of the two children */
+    if (child + 1 < _size &&
+        _nodes[child + 1]->deadline < _nodes[child]->deadline)
+      ++child;
+    if (node->deadline <= _nodes[child]->deadline) break;
+
+    place(slot, _nodes[child]);
+    slot = child;
+  }
+  place(slot, node);
+}
+
+template <size_t N>
+RAMFUNC bool AlarmHeap<N>::push(AlarmNode &node) {
+  if (full()) return false;
+
+  place(_size, &node);
+  siftUp(_size++);
+  return true;
+}
+
+template <size_t N>
+RAMFUNC void AlarmHeap<N>::remove(AlarmNode &node) {
+  const auto slot = node.slot;
+  const auto last = _nodes[--_size];
+  node.slot = AlarmNode::UNLINKED;
+
+  /* fill the hole with the last node, which may go either way */
+  if (slot != _size) {
+    place(slot, last);
+    siftUp(slot);
+    siftDown(last->slot);
+  }
+}
+
+template <size_t N>
+RAMFUNC void AlarmHeap<N>::update(AlarmNode &node, uint64_t deadline) {
+  node.deadline = deadline;
+  siftUp(node.slot);
+  siftDown(node.slot);
+}
+
+template <size_t N>
+bool AlarmHeap<N>::valid() const {
+  for (size_t slot = 0; slot < _size; ++slot) {
+    if (_nodes[slot]->slot != slot) return false;
+    if (slot && _nodes[(slot - 1) / 2]->deadline > _nodes[slot]->deadline)
+      return false;
+  }
+  return true;
+}
+
+#endif // ALARMHEAP_TPP
@@ -10,10 +10,18 @@
 #include <array>
 #include <chrono>
 
+#include "AlarmHeap.hpp"
 #include "CallbackUtils.hpp"
+#include "WaitQueue.h"
+#include "ramfunc.h"
 #include "tim.h"
 
-template <uintptr_t TimBase>
+/**
+ * @tparam TimBase Timer instance, free running
+ * @tparam NMAX_VIRTUAL Virtual alarms: if any, the last channel is reserved to
+ * multiplex them, always compared against the nearest deadline
+ */
+template <uintptr_t TimBase, size_t NMAX_VIRTUAL = 0>
 class HwAlarm {
  public:
   using DurationRep = uint64_t;
@@ -33,12 +41,44 @@ class HwAlarm {
     CHANGED
   };
 
+  /* Alarm multiplexed on the reserved channel, storage owned by the client */
+  class VirtualAlarm : AlarmNode {
+   public:
+    explicit VirtualAlarm(const ICallbackType *icb)
+        : icb(icb), reps(0), ticks(0) {}
+
+   private:
+    friend HwAlarm;
+
+    const ICallbackType *icb;
+    uint32_t reps;
+    Cnt ticks;
+  };
+
+  /* Monotonic, from the overflow-extended counter. Zero until init() */
+  struct SteadyClock {
+    using rep = int64_t;
+    using period = std::nano;
+    using duration = std::chrono::duration<rep, period>;
+    using time_point = std::chrono::time_point<SteadyClock>;
+    static constexpr bool is_steady = true;
+
+    static time_point now();
+  };
+
   HwAlarm();
   void handler();
 
   bool init(const NanoSeconds &t_cnt, uint32_t preempt = 0, uint32_t sub = 0);
+  /*
+   * Running channel alarms are not rescaled. False while virtual alarms are
+   * running. SteadyClock continues from now
+   */
   bool setResolution(const NanoSeconds &tick);
 
+  /* Ticks since the last change of resolution, race-free from any context */
+  static uint64_t ticks();
+
   /**
    * @brief Start an alarm from current CNT
    * @param delay Time interval between consecutive alarm firings
@@ -64,11 +104,37 @@ class HwAlarm {
                       const NanoSeconds &delay = NanoSeconds::zero(),
                       const ICallbackType *icb_new = nullptr);
 
-  void delay(const NanoSeconds &t) const;
+  /**
+   * @brief Start a virtual alarm from current CNT, restarting it if running
+   * @return As the channel alarm, CHANNELS_BUSY if NMAX_VIRTUAL are running
+   */
+  AlarmState setAlarm(const NanoSeconds &delay, VirtualAlarm &va,
+                      uint32_t reps = 1);
+
+  /* Change a running virtual alarm, as the channel alarm */
+  AlarmState setAlarm(VirtualAlarm &va, uint32_t reps,
+                      const NanoSeconds &delay = NanoSeconds::zero());
+
+  /**
+   * @brief Wait for t. From thread mode, with virtual alarms, it sleeps (WFI)
+   * on a one-shot alarm and spins only the last, calibrated, few ticks
+   */
+  void delay(const NanoSeconds &t);
+
+  /* Longest delay of a single alarm firing, at the configured resolution */
+  NanoSeconds maxDelay() const;
+
+  /* Worst delay from an alarm firing to its handler, since the last reset */
+  NanoSeconds maxLatency(bool reset = false);
+
+  /* Heap invariant of the virtual alarms, for the host checks */
+  bool checkVirtual() const { return _vheap.valid(); }
 
  private:
   static inline auto _tim = reinterpret_cast<TIM_TypeDef *>(TimBase);
   static constexpr auto _nch = tim::getNChannels(TimBase);
+  static constexpr size_t _vch = _nch - 1;
+  static constexpr size_t _nhw = NMAX_VIRTUAL ? _vch : _nch;
 
   using Psc = uint16_t;
 
@@ -77,16 +143,41 @@ class HwAlarm {
     volatile uint32_t reps;
     volatile Cnt ticks;
   };
-  using AlarmContainer = std::array<Alarm, _nch>;
+  using AlarmContainer = std::array<Alarm, _nhw>;
 
   bool calcTimeBase(const NanoSeconds &t_cnt, Psc &psc);
+  DurationRep toTicks(const NanoSeconds &t) const;
   size_t getChannel() const;
   void freeChannel(size_t ch);
 
+  /* Sleep for the given ticks, false if it can't */
+  bool sleep(Cnt ticks);
+  RAMFUNC void wake() { _delay_wq.wake(); }
+  void calibrate();
+
+  /* Virtual alarms, with PRIMASK set */
+  void armVirtual();
+  void handleVirtual();
+  AlarmState startVirtual(VirtualAlarm &va, Cnt cnt, Cnt delay,
+                          uint32_t reps);
+
   AlarmContainer _alarms;
+  AlarmHeap<NMAX_VIRTUAL> _vheap;
+
+  MemFnCallback<HwAlarm, void()> _delay_cb;
+  VirtualAlarm _delay_alarm;
+  WaitQueue _delay_wq;
+  Cnt _spin_ticks; /* Wake-up cost, spun rather than slept */
+  volatile Cnt _max_late;
   /*volatile*/ uint32_t _psc_clk;
   /*volatile*/ DurationRep _psc_plus_one_times_den;
   /*volatile*/ DurationRep _psc_plus_one_times_half_den;
+
+  /* Counter extension, in the timer ISR, and scale of SteadyClock */
+  static inline volatile uint32_t _wraps = 0;
+  static inline int64_t _epoch_ns = 0;
+  static inline uint64_t _tick_ns = 0;
+  static inline uint64_t _tick_ns_frac = 0; /* 2^-32 ns */
 };
 
 #include "HwAlarm.tpp"
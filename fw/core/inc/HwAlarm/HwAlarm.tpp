@@ -12,15 +12,20 @@
 
 #include <algorithm>
 
-template <uintptr_t TimBase>
-HwAlarm<TimBase>::HwAlarm()
+template <uintptr_t TimBase, size_t NMAX_VIRTUAL>
+HwAlarm<TimBase, NMAX_VIRTUAL>::HwAlarm()
     : _alarms{},
+      _delay_cb(this, &HwAlarm::wake),
+      _delay_alarm(&_delay_cb),
+      _spin_ticks(0),
+      _max_late(0),
       _psc_clk(0),
       _psc_plus_one_times_den(0),
       _psc_plus_one_times_half_den(0) {}
 
-template <uintptr_t TimBase>
-bool HwAlarm<TimBase>::calcTimeBase(const NanoSeconds &t_cnt, Psc &psc) {
+template <uintptr_t TimBase, size_t NMAX_VIRTUAL>
+bool HwAlarm<TimBase, NMAX_VIRTUAL>::calcTimeBase(const NanoSeconds &t_cnt,
+                                                  Psc &psc) {
   constexpr auto psc_width = std::numeric_limits<Psc>::digits;
   constexpr auto ratio_den = static_cast<DurationRep>(NanoSeconds::period::den);
 
@@ -37,22 +42,50 @@ bool HwAlarm<TimBase>::calcTimeBase(const NanoSeconds &t_cnt, Psc &psc) {
   _psc_plus_one_times_half_den = psc_plus_one * (ratio_den >> 1);
   psc = psc_plus_one - 1;
 
+  /* Fixed-point tick length, for SteadyClock */
+  _tick_ns = _psc_plus_one_times_den / psc_clk;
+  _tick_ns_frac = ((_psc_plus_one_times_den % psc_clk) << 32) / psc_clk;
+
   return true;
 }
 
-template <uintptr_t TimBase>
-bool HwAlarm<TimBase>::setResolution(const NanoSeconds &tick) {
+template <uintptr_t TimBase, size_t NMAX_VIRTUAL>
+bool HwAlarm<TimBase, NMAX_VIRTUAL>::setResolution(const NanoSeconds &tick) {
+  /* lock the heap and the counter extension, from ISRs of any priority */
+  const auto primask = __get_PRIMASK();
+  __disable_irq();
+
+  /* the virtual deadlines are in ticks since the last change */
+  if (_vheap.size()) {
+    __set_PRIMASK(primask);
+    return false;
+  }
+
+  /* at the old resolution, with a pending overflow */
+  const auto epoch = SteadyClock::now().time_since_epoch().count();
+
   Psc psc;
-  if (!calcTimeBase(tick, psc)) return false;
+  if (!calcTimeBase(tick, psc)) {
+    __set_PRIMASK(primask);
+    return false;
+  }
 
+  /* UG resets CNT, and doesn't set UIF (URS): drop the pending overflow */
   LL_TIM_SetPrescaler(_tim, psc);
   LL_TIM_GenerateEvent_UPDATE(_tim);
+  LL_TIM_ClearFlag_UPDATE(_tim);
+  _wraps = 0;
+  _epoch_ns = epoch;
+  __set_PRIMASK(primask);
+
+  /* The wake-up cost is in ticks */
+  if (LL_TIM_IsEnabledCounter(_tim)) calibrate();
   return true;
 }
 
-template <uintptr_t TimBase>
-bool HwAlarm<TimBase>::init(const NanoSeconds &t_cnt, uint32_t preempt,
-                            uint32_t sub) {
+template <uintptr_t TimBase, size_t NMAX_VIRTUAL>
+bool HwAlarm<TimBase, NMAX_VIRTUAL>::init(const NanoSeconds &t_cnt,
+                                          uint32_t preempt, uint32_t sub) {
   tim::enableClock(TimBase);
 
   /*
@@ -69,6 +102,10 @@ bool HwAlarm<TimBase>::init(const NanoSeconds &t_cnt, uint32_t preempt,
   /* Set PSC, generates UEV (reset PSC and CNT) */
   if (!setResolution(t_cnt)) return false;
 
+  /* Extend the counter at each overflow */
+  LL_TIM_ClearFlag_UPDATE(_tim);
+  LL_TIM_EnableIT_UPDATE(_tim);
+
   /*
    * CCMR @ reset
    *  - Output channel
@@ -82,11 +119,19 @@ bool HwAlarm<TimBase>::init(const NanoSeconds &t_cnt, uint32_t preempt,
   NVIC_EnableIRQ(tim::getIRQn(TimBase));
 
   LL_TIM_EnableCounter(_tim);
+  calibrate();
   return true;
 }
 
-template <uintptr_t TimBase>
-size_t HwAlarm<TimBase>::getChannel() const {
+template <uintptr_t TimBase, size_t NMAX_VIRTUAL>
+RAMFUNC auto HwAlarm<TimBase, NMAX_VIRTUAL>::toTicks(const NanoSeconds &t) const
+    -> DurationRep {
+  return ((t.count() * _psc_clk) + _psc_plus_one_times_half_den) /
+         _psc_plus_one_times_den;
+}
+
+template <uintptr_t TimBase, size_t NMAX_VIRTUAL>
+RAMFUNC size_t HwAlarm<TimBase, NMAX_VIRTUAL>::getChannel() const {
   size_t idx;
   for (idx = 0; idx < _alarms.size(); ++idx) {
     if (!_alarms[idx].icb) return idx;
@@ -94,8 +139,8 @@ size_t HwAlarm<TimBase>::getChannel() const {
   return idx;
 }
 
-template <uintptr_t TimBase>
-void HwAlarm<TimBase>::freeChannel(size_t ch) {
+template <uintptr_t TimBase, size_t NMAX_VIRTUAL>
+RAMFUNC void HwAlarm<TimBase, NMAX_VIRTUAL>::freeChannel(size_t ch) {
   _alarms[ch].icb = nullptr;
 
   /* disable IRQ and re-evaluate all */
@@ -103,9 +148,10 @@ void HwAlarm<TimBase>::freeChannel(size_t ch) {
   NVIC_ClearPendingIRQ(tim::getIRQn(TimBase));
 }
 
-template <uintptr_t TimBase>
-auto HwAlarm<TimBase>::setAlarm(const NanoSeconds &delay,
-                                const ICallbackType *icb, uint32_t reps)
+template <uintptr_t TimBase, size_t NMAX_VIRTUAL>
+RAMFUNC auto HwAlarm<TimBase, NMAX_VIRTUAL>::setAlarm(const NanoSeconds &delay,
+                                                      const ICallbackType *icb,
+                                                      uint32_t reps)
     -> AlarmState {
   /* save time of request asap */
   const auto cnt = static_cast<Cnt>(_tim->CNT);
@@ -117,9 +163,7 @@ auto HwAlarm<TimBase>::setAlarm(const NanoSeconds &delay,
   const auto idx = getChannel();
   if (idx == _alarms.size()) return CHANNELS_BUSY;
 
-  const auto ticks_wide =
-      ((delay.count() * _psc_clk) + _psc_plus_one_times_half_den) /
-      _psc_plus_one_times_den;
+  const auto ticks_wide = toTicks(delay);
   const auto ticks = static_cast<Cnt>(ticks_wide);
 
   if (!ticks_wide || ticks_wide > std::numeric_limits<Cnt>::max())
@@ -149,10 +193,11 @@ auto HwAlarm<TimBase>::setAlarm(const NanoSeconds &delay,
   return STARTED;
 }
 
-template <uintptr_t TimBase>
-auto HwAlarm<TimBase>::setAlarm(const ICallbackType *icb, uint32_t reps,
-                                const NanoSeconds &delay,
-                                const ICallbackType *icb_new) -> AlarmState {
+template <uintptr_t TimBase, size_t NMAX_VIRTUAL>
+RAMFUNC auto HwAlarm<TimBase, NMAX_VIRTUAL>::setAlarm(
+    const ICallbackType *icb, uint32_t reps, const NanoSeconds &delay,
+    const ICallbackType *icb_new)
+    -> AlarmState {
   if (!icb || (icb_new && !*icb_new)) return INVALID_CALLBACK;
 
   /* lock alarm representation */
@@ -181,9 +226,7 @@ auto HwAlarm<TimBase>::setAlarm(const ICallbackType *icb, uint32_t reps,
     auto cnt = *tim::ccr<TimBase>(idx) - _alarms[idx].ticks;
 
     /* recalculate timing parameters */
-    const auto ticks_wide =
-        ((delay.count() * _psc_clk) + _psc_plus_one_times_half_den) /
-        _psc_plus_one_times_den;
+    const auto ticks_wide = toTicks(delay);
     _alarms[idx].ticks = static_cast<Cnt>(ticks_wide);
 
     if (!ticks_wide || ticks_wide > std::numeric_limits<Cnt>::max()) {
@@ -213,19 +256,220 @@ auto HwAlarm<TimBase>::setAlarm(const ICallbackType *icb, uint32_t reps,
   return CHANGED;
 }
 
+template <uintptr_t TimBase, size_t NMAX_VIRTUAL>
+RAMFUNC uint64_t HwAlarm<TimBase, NMAX_VIRTUAL>::ticks() {
+  constexpr auto width = std::numeric_limits<Cnt>::digits;
+
+  /* retry if the ISR has extended the counter meanwhile */
+  for (;;) {
+    const uint32_t wraps = _wraps;
+    auto cnt = static_cast<Cnt>(_tim->CNT);
+
+    /* overflow not handled yet (masked or preempted): read CNT past it */
+    const bool pending = LL_TIM_IsActiveFlag_UPDATE(_tim);
+    if (pending) cnt = static_cast<Cnt>(_tim->CNT);
+
+    if (wraps == _wraps) return ((uint64_t{wraps} + pending) << width) | cnt;
+  }
+}
+
+template <uintptr_t TimBase, size_t NMAX_VIRTUAL>
+RAMFUNC auto HwAlarm<TimBase, NMAX_VIRTUAL>::SteadyClock::now() -> time_point {
+  const auto t = ticks();
+
+  /* t * (_tick_ns + _tick_ns_frac / 2^32), within 64 bits */
+  const auto frac =
+      (t >> 32) * _tick_ns_frac + (((t & 0xFFFFFFFFU) * _tick_ns_frac) >> 32);
+  return time_point(duration(_epoch_ns + t * _tick_ns + frac));
+}
+
+template <uintptr_t TimBase, size_t NMAX_VIRTUAL>
+RAMFUNC void HwAlarm<TimBase, NMAX_VIRTUAL>::armVirtual() {
+  const auto top = _vheap.top();
+  if (!top) {
+    tim::disableItCC(_tim, _vch);
+    return;
+  }
+
+  /* deadlines are within the counter range, it matches the first time */
+  *tim::ccr<TimBase>(_vch) = static_cast<Cnt>(top->deadline);
+  tim::clearFlagCC(_tim, _vch);
+  tim::enableItCC(_tim, _vch);
+
+  /* deadline already elapsed ? match by software */
+  if (ticks() >= top->deadline) _tim->EGR = TIM_EGR_CC1G << _vch;
+}
+
+template <uintptr_t TimBase, size_t NMAX_VIRTUAL>
+RAMFUNC auto HwAlarm<TimBase, NMAX_VIRTUAL>::setAlarm(const NanoSeconds &delay,
+                                                      VirtualAlarm &va,
+                                                      uint32_t reps)
+    -> AlarmState {
+  static_assert(NMAX_VIRTUAL > 0, "No virtual alarms");
+
+  /* save time of request asap */
+  const auto cnt = static_cast<Cnt>(_tim->CNT);
+
+  /* exit early if parameters are invalid */
+  if (!va.icb || !*va.icb) return INVALID_CALLBACK;
+
+  const auto ticks_wide = toTicks(delay);
+  if (!ticks_wide || ticks_wide > std::numeric_limits<Cnt>::max())
+    return INVALID_DELAY;
+
+  return startVirtual(va, cnt, static_cast<Cnt>(ticks_wide), reps);
+}
+
+template <uintptr_t TimBase, size_t NMAX_VIRTUAL>
+RAMFUNC auto HwAlarm<TimBase, NMAX_VIRTUAL>::startVirtual(VirtualAlarm &va,
+                                                          Cnt cnt, Cnt delay,
+                                                          uint32_t reps)
+    -> AlarmState {
+  /* lock the heap, from ISRs of any priority */
+  const auto primask = __get_PRIMASK();
+  __disable_irq();
+
+  if (va.linked()) _vheap.remove(va);
+  if (_vheap.full()) {
+    __set_PRIMASK(primask);
+    return CHANNELS_BUSY;
+  }
+
+  /* from the time of request */
+  const auto now = ticks();
+  va.reps = !reps ? std::numeric_limits<uint32_t>::max() : reps;
+  va.ticks = delay;
+  va.deadline = now - static_cast<Cnt>(static_cast<Cnt>(now) - cnt) + delay;
+
+  _vheap.push(va);
+  armVirtual();
+
+  __set_PRIMASK(primask);
+  return STARTED;
+}
+
+template <uintptr_t TimBase, size_t NMAX_VIRTUAL>
+RAMFUNC auto HwAlarm<TimBase, NMAX_VIRTUAL>::setAlarm(VirtualAlarm &va,
+                                                      uint32_t reps,
+                                                      const NanoSeconds &delay)
+    -> AlarmState {
+  static_assert(NMAX_VIRTUAL > 0, "No virtual alarms");
+
+  const auto primask = __get_PRIMASK();
+  __disable_irq();
+
+  auto state = CHANGED;
+
+  if (!va.linked()) {
+    state = INVALID_CALLBACK;
+  } else if (!reps) {
+    _vheap.remove(va);
+    state = STOPPED;
+  } else {
+    va.reps = reps;
+
+    if (delay != NanoSeconds::zero()) {
+      /* recover original time instant */
+      const auto start = va.deadline - va.ticks;
+      const auto ticks_wide = toTicks(delay);
+
+      if (!ticks_wide || ticks_wide > std::numeric_limits<Cnt>::max()) {
+        _vheap.remove(va);
+        state = INVALID_DELAY;
+      } else {
+        va.ticks = static_cast<Cnt>(ticks_wide);
+
+        /* delay already elapsed ? */
+        if (start + va.ticks < ticks()) {
+          _vheap.remove(va);
+          state = DELAY_TOO_SHORT;
+        } else {
+          _vheap.update(va, start + va.ticks);
+        }
+      }
+    }
+  }
+
+  if (state != INVALID_CALLBACK) armVirtual();
+
+  __set_PRIMASK(primask);
+  return state;
+}
+
+template <uintptr_t TimBase, size_t NMAX_VIRTUAL>
+RAMFUNC void HwAlarm<TimBase, NMAX_VIRTUAL>::handleVirtual() {
+  constexpr auto max_reps = std::numeric_limits<uint32_t>::max();
+
+  /* Fire the elapsed alarms one at a time: callbacks may change the heap */
+  for (;;) {
+    const auto primask = __get_PRIMASK();
+    __disable_irq();
+
+    const auto now = ticks();
+    const auto va = static_cast<VirtualAlarm *>(_vheap.top());
+
+    if (!va || va->deadline > now) {
+      armVirtual();
+      __set_PRIMASK(primask);
+      return;
+    }
+
+    const auto late = std::min<uint64_t>(now - va->deadline,
+                                         std::numeric_limits<Cnt>::max());
+    if (late > _max_late) _max_late = late;
+
+    /* done ? unlink, rearm otherwise */
+    const auto icb = va->icb;
+    if (va->reps != max_reps && 0 == --va->reps)
+      _vheap.remove(*va);
+    else
+      _vheap.update(*va, va->deadline + va->ticks);
+
+    __set_PRIMASK(primask);
+    (*icb)();
+  }
+}
+
+template <uintptr_t TimBase, size_t NMAX_VIRTUAL>
+auto HwAlarm<TimBase, NMAX_VIRTUAL>::maxLatency(bool reset) -> NanoSeconds {
+  const DurationRep ticks = _max_late;
+  if (reset) _max_late = 0;
+
+  if (!_psc_clk) return NanoSeconds::zero();
+  return NanoSeconds(ticks * _psc_plus_one_times_den / _psc_clk);
+}
+
+template <uintptr_t TimBase, size_t NMAX_VIRTUAL>
+auto HwAlarm<TimBase, NMAX_VIRTUAL>::maxDelay() const -> NanoSeconds {
+  const DurationRep ticks = std::numeric_limits<Cnt>::max();
+
+  if (!_psc_clk) return NanoSeconds::zero();
+  return NanoSeconds(ticks * _psc_plus_one_times_den / _psc_clk);
+}
+
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wvolatile"
 /* compound assignment with 'volatile'-qualified left operand is deprecated */
 
-template <uintptr_t TimBase>
-void HwAlarm<TimBase>::handler() {
+template <uintptr_t TimBase, size_t NMAX_VIRTUAL>
+RAMFUNC void HwAlarm<TimBase, NMAX_VIRTUAL>::handler() {
   constexpr auto max_reps = std::numeric_limits<uint32_t>::max();
-  std::array<const ICallbackType *, _nch> scheduled{};
+  std::array<const ICallbackType *, _nhw> scheduled{};
+
+  /* extend the counter, before anyone reads it */
+  if (LL_TIM_IsActiveFlag_UPDATE(_tim)) {
+    LL_TIM_ClearFlag_UPDATE(_tim);
+    ++_wraps;
+  }
 
   /* one channel after the other */
   for (size_t idx = 0; idx < _alarms.size(); ++idx) {
     /* if in use && has triggered */
     if (_alarms[idx].icb && tim::isActiveFlagCC(_tim, idx)) {
+      /* ticks since the match */
+      const Cnt late = static_cast<Cnt>(_tim->CNT) - *tim::ccr<TimBase>(idx);
+      if (late > _max_late) _max_late = late;
+
       /* schedule its execution */
       scheduled[idx] = _alarms[idx].icb;
 
@@ -248,23 +492,74 @@ void HwAlarm<TimBase>::handler() {
   for (const auto icb : scheduled) {
     if (icb) (*icb)();
   }
+
+  if constexpr (NMAX_VIRTUAL > 0) {
+    if (tim::isActiveFlagCC(_tim, _vch)) {
+      tim::clearFlagCC(_tim, _vch);
+      handleVirtual();
+    }
+  }
 }
 #pragma GCC diagnostic pop
 
-template <uintptr_t TimBase>
-void HwAlarm<TimBase>::delay(const NanoSeconds &t) const {
+template <uintptr_t TimBase, size_t NMAX_VIRTUAL>
+bool HwAlarm<TimBase, NMAX_VIRTUAL>::sleep(Cnt ticks) {
+  if constexpr (NMAX_VIRTUAL > 0) {
+    /* the alarm handler must be able to preempt */
+    if (__get_IPSR() || __get_PRIMASK()) return false;
+
+    if (startVirtual(_delay_alarm, static_cast<Cnt>(_tim->CNT), ticks, 1) !=
+        STARTED)
+      return false;
+
+    _delay_wq.sleep();
+    return true;
+  }
+  return false;
+}
+
+template <uintptr_t TimBase, size_t NMAX_VIRTUAL>
+void HwAlarm<TimBase, NMAX_VIRTUAL>::calibrate() {
+  constexpr int n_samples = 4;
+
+  /* worst overshoot of the shortest sleep */
+  Cnt worst = 0;
+  for (int i = 0; i < n_samples; ++i) {
+    const auto t0 = static_cast<Cnt>(_tim->CNT);
+    if (!sleep(1)) return;
+
+    const auto elapsed = static_cast<Cnt>(static_cast<Cnt>(_tim->CNT) - t0);
+    if (elapsed > 1) worst = std::max<Cnt>(worst, elapsed - 1);
+  }
+  _spin_ticks = worst + 1;
+}
+
+template <uintptr_t TimBase, size_t NMAX_VIRTUAL>
+void HwAlarm<TimBase, NMAX_VIRTUAL>::delay(const NanoSeconds &t) {
+  /* chunks within half the counter range, not to miss a wrap */
+  constexpr DurationRep max_chunk = std::numeric_limits<Cnt>::max() >> 1;
+
   auto t0 = static_cast<Cnt>(_tim->CNT);
-  const auto ticks = ((t.count() * _psc_clk) + _psc_plus_one_times_half_den) /
-                     _psc_plus_one_times_den;
+  const auto ticks = toTicks(t);
 
   if (!ticks) return;
 
   DurationRep elapsed = 0;
-  while (elapsed < ticks) {
+  const auto advance = [&] {
     const auto t1 = static_cast<Cnt>(_tim->CNT);
     elapsed += static_cast<Cnt>(t1 - t0);
     t0 = t1;
+  };
+
+  /* sleep through most of it */
+  while (elapsed + _spin_ticks < ticks) {
+    const auto chunk = std::min(ticks - elapsed - _spin_ticks, max_chunk);
+    if (!sleep(static_cast<Cnt>(chunk))) break;
+    advance();
   }
+
+  /* spin the wake-up cost */
+  while (elapsed < ticks) advance();
 }
 
 #endif  // HWALARM_TPP
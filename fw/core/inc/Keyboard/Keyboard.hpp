@@ -25,6 +25,9 @@ class Keyboard : public IFile {
   int open(OFile& ofile) override;
   ssize_t read(OFile& ofile, char* buf, size_t count, off_t& pos) override;
   __poll_t poll(OFile& ofile) override;
+  int ioctl(OFile& ofile, unsigned long request, void* arg) override;
+  /* The PS/2 controller is sampled over SPI, without interrupts */
+  std::chrono::microseconds pollPeriod() const override;
 
  private:
   using FrameT = uint16_t;
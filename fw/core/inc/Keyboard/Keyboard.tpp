@@ -239,6 +239,28 @@ __poll_t Keyboard<SpiMaster, HwAlarm>::poll(OFile& ofile) {
   return ((_peek = _step(scan_code))) ? READY_MASK : 0;
 }
 
+template <typename SpiMaster, typename HwAlarm>
+int Keyboard<SpiMaster, HwAlarm>::ioctl([[maybe_unused]] OFile& ofile,
+                                        unsigned long request, void* arg) {
+  switch (request) {
+    case KBD_IOC_SFCLK: {
+      const auto fclk_hz = *static_cast<const uint32_t*>(arg);
+      if (!_spi.setMaxClockFreq(_id, fclk_hz)) return -EINVAL;
+
+      _max_fclk_hz = fclk_hz;
+      return 0;
+    }
+
+    default:
+      return -ENOTTY;
+  }
+}
+
+template <typename SpiMaster, typename HwAlarm>
+std::chrono::microseconds Keyboard<SpiMaster, HwAlarm>::pollPeriod() const {
+  return T_POLL;
+}
+
 template <typename SpiMaster, typename HwAlarm>
 int Keyboard<SpiMaster, HwAlarm>::_getc(char& c) {
   uint8_t scan_code;
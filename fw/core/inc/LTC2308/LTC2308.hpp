@@ -25,6 +25,7 @@ class LTC2308 : public IFile {
 
   int open(OFile& ofile) override;
   ssize_t read(OFile& ofile, char* buf, size_t count, off_t& pos) override;
+  int ioctl(OFile& ofile, unsigned long request, void* arg) override;
 
  private:
   using FrameT = uint16_t;
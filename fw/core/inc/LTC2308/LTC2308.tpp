@@ -175,4 +175,44 @@ ssize_t LTC2308<SpiMaster, HwAlarm>::read(OFile& ofile, char* buf, size_t count,
   return rqst_count;
 }
 
+template <typename SpiMaster, typename HwAlarm>
+int LTC2308<SpiMaster, HwAlarm>::ioctl([[maybe_unused]] OFile& ofile,
+                                       unsigned long request, void* arg) {
+  switch (request) {
+    case ADC_IOC_SFCLK: {
+      const auto fclk_hz = *static_cast<const uint32_t*>(arg);
+      if (fclk_hz > OPT_FCLK_MAX || !_spi.setMaxClockFreq(_id, fclk_hz))
+        return -EINVAL;
+
+      _max_fclk_hz = fclk_hz;
+      return 0;
+    }
+
+    case ADC_IOC_SCFG: {
+      const auto& cfg = *static_cast<const adc_cfg*>(arg);
+      if (cfg.channel > CH7) return -EINVAL;
+
+      /* The configuration word is sent along with each conversion start, so
+       * the next read() samples with the new one */
+      const auto was_lp = _lp;
+      setOptions(cfg.single_ended ? SINGLE_ENDED : DIFFERENTIAL,
+                 static_cast<Channel>(cfg.channel),
+                 cfg.unipolar ? UNIPOLAR : BIPOLAR, cfg.low_power);
+
+      /* The leftover byte was converted with the old configuration */
+      _sdi = NULL_FRAME;
+
+      /* Wake up from sleep, as read() would not anymore */
+      if (was_lp && !_lp) {
+        _spi.txrx(_id, _sdo << (FRAME_NBIT - CFG_NBIT), T_EN, T_DIS);
+        _hw_alarm.delay(T_REFWAKE);
+      }
+      return 0;
+    }
+
+    default:
+      return -ENOTTY;
+  }
+}
+
 #endif  // LTC2308_TPP
@@ -0,0 +1,46 @@
+/**
+ * @file     MotionConfig.hpp
+ * @author   Fabio Scatozza <s315216@studenti.polito.it>
+ * @date     18.10.2026
+ *
+ * Pattern configuration shared by the firmware and the host tools: the flash
+ * layout of MotionPattern depends on NMAX_SEGMENTS, and the segments encode
+ * the user input through these conversions.
+ */
+
+#ifndef MOTIONCONFIG_HPP
+#define MOTIONCONFIG_HPP
+
+#include "BStepper.h"
+#include "utils.hpp"
+
+namespace motion {
+
+static constexpr auto NMAX_SEGMENTS = 8;
+static constexpr auto STEPS_PER_REV = 200;
+static constexpr auto DEGREES_360 = 360;
+static constexpr auto ADC_FULLSCALE_mV = 4096;
+static constexpr auto MILLI_RPM_MIN = 2'500;
+static constexpr auto MILLI_RPM_SOL = 25'000;
+static constexpr auto MILLI_RPM_MAX = 400'000;
+
+/* Angular displacement in tenths of a degree, to steps (rounded) */
+constexpr int stepsFromAngle(int angle_x10) {
+  return iround(angle_x10 * (STEPS_PER_REV / 10), DEGREES_360);
+}
+
+/* Steps to the angular displacement they cover, in tenths of a degree */
+constexpr int angleFromSteps(int steps) {
+  return (steps * DEGREES_360 * 10) / STEPS_PER_REV;
+}
+
+/* Potentiometer wiper voltage, from the input dynamic of the ADC to
+ * [MILLI_RPM_MIN, MILLI_RPM_MAX] */
+constexpr BStepper::SpeedType milliRpmFromMv(int mv) {
+  return MILLI_RPM_MIN +
+         iround(mv * (MILLI_RPM_MAX - MILLI_RPM_MIN), ADC_FULLSCALE_mV);
+}
+
+} // namespace motion
+
+#endif // MOTIONCONFIG_HPP
@@ -8,62 +8,275 @@
 #define MOTIONPATTERN_HPP
 
 #include "BStepper.h"
+#include "debug.h"
 #include "flash.h"
 
-template <size_t NMAX_MOTION_SEGMENTS>
+#include <cstddef>
+#include <cstdlib>
+#include <iterator>
+#include <limits>
+#include <type_traits>
+
+/*
+ * FLASH_RESIDENT drops the RAM mirror of the pattern: segments are decoded
+ * from flash on access and plans are compiled on demand. data() is not
+ * available. It is not zero-RAM: random access keeps two slot numbers per
+ * segment (4 B), the one edit records refer to and that of the latest version,
+ * in place of the mirrored segment and plan. The capacity is still
+ * NMAX_MOTION_SEGMENTS, which sizes the chunk as well: flash does not bound it.
+ */
+template <size_t NMAX_MOTION_SEGMENTS, bool FLASH_RESIDENT = false>
 class MotionPattern {
 public:
+  /* Motion bytecode (see MotionVM.hpp): plain patterns are made of MOVE */
+  enum Opcode : uint8_t { MOVE = 0, REPEAT, CALL, RET, DWELL, WAIT, N_OPCODES };
+
+  /* Instructions other than MOVE take their operands in place of the speed
+   * and of the steps */
   struct MotionSegment {
     BStepper::SpeedType milli_rev_per_minute;
     BStepper::StepCountType steps;
     BStepper::Direction direction;
+    Opcode op = MOVE;
   };
 
-  MotionPattern(const flash::Sector &sec);
+  class FlashIterator;
+  using const_iterator =
+      std::conditional_t<FLASH_RESIDENT, FlashIterator, const MotionSegment *>;
+
+  /* Modifiers return the mirrored segment, or success if flash resident */
+  using Result =
+      std::conditional_t<FLASH_RESIDENT, bool, const MotionSegment *>;
+  using Reference = std::conditional_t<FLASH_RESIDENT, MotionSegment,
+                                       const MotionSegment &>;
+
+  /**
+   * @param sec Flash sector dedicated to the pattern
+   * @param stepper Motor the pattern is compiled for: its resolution and
+   * clock must be configured, and must not change afterward
+   */
+  MotionPattern(const flash::Sector &sec, const BStepper &stepper);
 
-  const MotionSegment &operator[](size_t pos) const;
-  const MotionSegment *data() const;
+  Reference operator[](size_t pos) const;
+  const MotionSegment *data() const
+    requires(!FLASH_RESIDENT);
 
-  const MotionSegment *begin() const;
-  const MotionSegment *end() const;
+  /* Timer register image of segment pos, computed at load or pushBack. If
+   * flash resident, computed on each call: valid until the next one */
+  const BStepper::Plan &plan(size_t pos) const;
+
+  /* Modifiers invalidate flash iterators */
+  const_iterator begin() const;
+  const_iterator end() const;
 
   constexpr static size_t max_size() { return NMAX_MOTION_SEGMENTS; }
   size_t size() const;
   bool empty() const;
 
+  /* No room for another segment, even after compaction */
+  bool full() const;
+
   void clear();
-  const MotionSegment *pushBack(BStepper::SpeedType milli_rev_per_minute,
-                                   BStepper::StepCountType steps,
-                                   BStepper::Direction direction);
-  const MotionSegment *pushBack(const MotionSegment &ms);
+  Result pushBack(BStepper::SpeedType milli_rev_per_minute,
+                  BStepper::StepCountType steps, BStepper::Direction direction);
+  Result pushBack(const MotionSegment &ms);
+
+  /*
+   * Edits are appended as records resolved at load: replacing a segment
+   * programs two records, erasing it one. When the chunk runs out of slots,
+   * the live segments are compacted into the next chunk.
+   */
+  Result replace(size_t pos, const MotionSegment &ms);
+  bool erase(size_t pos);
+
+  /*
+   * Batch append: the segments are programmed as they are appended, but they
+   * become part of the pattern only on commit(), by flipping a single bit of
+   * the first record. A reset before then discards the whole batch. Should the
+   * chunk run out of slots, the compaction carries over the staged records,
+   * still uncommitted. Flash is kept unlocked from beginBatch() to commit() or
+   * abortBatch(), and no other modifier can be interleaved (clear() aborts
+   * the batch).
+   */
+  bool beginBatch();
+  /* On failure, the batch is aborted */
+  Result append(const MotionSegment &ms);
+  bool commit();
+  void abortBatch();
 
 private:
+  /* Transitions only clear bits: STAGED -> WRITTEN clears bit 6 alone,
+   * so a commit interrupted by a reset is either done or not */
   enum FlashChunkAttribute : uint8_t {
     ERASED = 0xFF,
-    WRITTEN = 0xAA,
+    STAGED = 0xEA, /* Head of an uncommitted batch */
+    WRITTEN = 0xAA, /* Single entry, or head of a committed batch */
+    LINKED = 0x55, /* Batch entry following the head */
     DIRTY = 0x00
   };
 
+  /* Stored in the upper bits of the tag. Edit records refer to the slot
+   * where the segment was first written */
+  enum RecordKind : uint8_t {
+    SEGMENT = 0x00,
+    OVERRIDE = 0x40, /* Batch head, followed by the new segment */
+    TOMBSTONE = 0x80,
+    KIND_MASK = 0xC0
+  };
+
   struct FlashChunkEntry {
     /* Motion Segment */
     BStepper::SpeedType milli_rev_per_minute;
-    BStepper::StepCountType steps;
-    BStepper::Direction direction;
-    /* Packed with a chunk attribute */
+    BStepper::StepCountType steps; /* Target slot, for edit records */
+    uint8_t tag; /* RecordKind | Opcode << OP_SHIFT | BStepper::Direction */
+    /* Programmed last */
+    FlashChunkAttribute attr;
+  };
+
+  /* Records written before the opcode was introduced decode as MOVE */
+  static constexpr uint8_t OP_SHIFT = 1;
+  static constexpr uint8_t DIR_MASK = 0x01;
+
+  static constexpr uint8_t makeTag(RecordKind k,
+                                   BStepper::Direction d = BStepper::CCW,
+                                   Opcode op = MOVE) {
+    return static_cast<uint8_t>(k) | static_cast<uint8_t>(op << OP_SHIFT) |
+           static_cast<uint8_t>(d);
+  }
+
+  /* Edit records consume slots as well: spare room to defer compaction */
+  static constexpr size_t n_slots = 2 * NMAX_MOTION_SEGMENTS;
+
+  struct FlashChunk {
+    /* ERASED while in use: programming any bit marks the chunk dirty */
     FlashChunkAttribute attr;
+    FlashChunkEntry entries[n_slots];
+  };
+
+  /* Last bytes of the sector, past the chunks. The format is programmed right
+   * after each erase: a sector holding any other layout is rejected */
+  struct SectorTrailer {
+    uint32_t format;
+    uint8_t reserved[3];
+    /* Last byte of the sector: programmed before erasing it */
+    FlashChunkAttribute erase_marker;
   };
 
-  using FlashChunk = FlashChunkEntry[NMAX_MOTION_SEGMENTS];
-  using CacheChunk = std::array<MotionSegment, NMAX_MOTION_SEGMENTS>;
+  /* 'MP', layout version */
+  static constexpr uint32_t FORMAT_MAGIC = 0x4D50'0000U;
+  static constexpr uint32_t FORMAT_VERSION = 2;
+  static constexpr uint32_t FORMAT = FORMAT_MAGIC | FORMAT_VERSION;
+  static constexpr uint32_t FORMAT_ERASED = 0xFFFF'FFFFU;
+
+  /* The layout FORMAT_VERSION stands for. Checked by the target and the host
+   * builds alike, whose BStepper.h define the operand types separately */
+  static_assert(sizeof(FlashChunkEntry) == 8 &&
+                    offsetof(FlashChunkEntry, milli_rev_per_minute) == 0 &&
+                    offsetof(FlashChunkEntry, steps) == 4 &&
+                    offsetof(FlashChunkEntry, tag) == 6 &&
+                    offsetof(FlashChunkEntry, attr) == 7,
+                "FlashChunkEntry layout changed: bump FORMAT_VERSION");
+  static_assert(offsetof(FlashChunk, attr) == 0 &&
+                    offsetof(FlashChunk, entries) == 4 &&
+                    sizeof(FlashChunk) == 4 + 8 * n_slots,
+                "FlashChunk layout changed: bump FORMAT_VERSION");
+  static_assert(sizeof(SectorTrailer) == 8 &&
+                    offsetof(SectorTrailer, format) == 0 &&
+                    offsetof(SectorTrailer, erase_marker) == 7,
+                "SectorTrailer layout changed: bump FORMAT_VERSION");
+
+  /* Empty when flash resident */
+  static constexpr size_t n_mirrored =
+      FLASH_RESIDENT ? 0 : NMAX_MOTION_SEGMENTS;
+
+  using CacheChunk = std::array<MotionSegment, n_mirrored>;
+  using PlanChunk = std::array<BStepper::Plan, n_mirrored>;
+  /* Slot each segment was first written to, referenced by edit records */
+  using IdChunk = std::array<BStepper::StepCountType, NMAX_MOTION_SEGMENTS>;
+  /* Flash resident: slot of the latest version of each segment */
+  using SlotChunk = std::array<BStepper::StepCountType,
+                               NMAX_MOTION_SEGMENTS - n_mirrored>;
+
+  static bool isBlank(const FlashChunkEntry &e);
+  static size_t firstBlankSlot(const FlashChunk &c);
+  static bool hasCommitted(const FlashChunk &c);
 
-  void erase();
+  static MotionSegment decode(const FlashChunkEntry &e);
+
+  /* Plan of a MOVE, empty for the other instructions. False if the motor
+   * cannot execute the segment, the opcode is unknown, or the operands of a
+   * control instruction at pos are out of range (unused ones must be 0) */
+  bool compile(const MotionSegment &ms, size_t pos, BStepper::Plan &p) const;
+
+  size_t fchunkCount() const;
+  const SectorTrailer &trailer() const;
+
+  void eraseSector();
+  void programFormat();
+  /* Adopt a blank sector, or reject one in an unknown format */
+  void checkFormat();
   void markDirty();
 
+  /* Flash must be unlocked, with Op::PG. Erased fields are skipped */
+  static bool programEntry(const FlashChunkEntry &dst,
+                           const FlashChunkEntry &src);
+
+  void cache(size_t pos, const FlashChunkEntry &e);
+  size_t find(BStepper::StepCountType id) const;
+  BStepper::StepCountType idOf(size_t pos) const;
+  void remove(size_t pos);
+
+  /* Ensure n free slots, compacting if needed */
+  bool reserve(size_t n);
+  /* Offset of the chunk to compact into, leaving n free slots. 0 if none */
+  size_t compactionTarget(size_t n) const;
+  bool compact(size_t n);
+  /* Compact midway through a batch. Flash is left unlocked, with Op::PG */
+  bool carryBatch();
+
   flash::Sector _sec;
-  FlashChunk *_fchunk;
+  const BStepper &_stepper;
+  const FlashChunk *_fchunk;
   size_t _fchunk_idx;
-  CacheChunk _cchunk;
+  size_t _slot;
+  [[no_unique_address]] CacheChunk _cchunk;
+  [[no_unique_address]] PlanChunk _pchunk;
+  IdChunk _ids;
+  [[no_unique_address]] SlotChunk _slots;
+  /* Flash resident: plan() buffer */
+  [[no_unique_address]] mutable std::array<BStepper::Plan, FLASH_RESIDENT>
+      _plan;
   size_t _n;
+
+  /* Batch in progress: staged entries are cached past _n */
+  bool _batch;
+  size_t _staged;
+  const FlashChunkEntry *_head;
+};
+
+/* Walks the segments in pattern order, decoding them from flash */
+template <size_t NMAX_MOTION_SEGMENTS, bool FLASH_RESIDENT>
+class MotionPattern<NMAX_MOTION_SEGMENTS, FLASH_RESIDENT>::FlashIterator {
+public:
+  using iterator_category = std::forward_iterator_tag;
+  using value_type = MotionSegment;
+  using difference_type = std::ptrdiff_t;
+  using pointer = void;
+  using reference = MotionSegment;
+
+  FlashIterator() = default;
+
+  MotionSegment operator*() const;
+  FlashIterator &operator++();
+  FlashIterator operator++(int);
+  bool operator==(const FlashIterator &other) const;
+
+private:
+  friend class MotionPattern;
+  FlashIterator(const MotionPattern *mp, size_t pos);
+
+  const MotionPattern *_mp = nullptr;
+  size_t _pos = 0;
 };
 
 #include "MotionPattern.tpp"
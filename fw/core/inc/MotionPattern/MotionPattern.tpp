@@ -7,178 +7,805 @@
 #ifndef MOTIONPATTERN_TPP
 #define MOTIONPATTERN_TPP
 
-template <size_t NMAX_MOTION_SEGMENTS>
-void MotionPattern<NMAX_MOTION_SEGMENTS>::erase() {
+template <size_t NMAX_MOTION_SEGMENTS, bool FLASH_RESIDENT>
+size_t
+MotionPattern<NMAX_MOTION_SEGMENTS, FLASH_RESIDENT>::fchunkCount() const {
+  return (getSize(_sec) - sizeof(SectorTrailer)) / sizeof(FlashChunk);
+}
+
+template <size_t NMAX_MOTION_SEGMENTS, bool FLASH_RESIDENT>
+auto MotionPattern<NMAX_MOTION_SEGMENTS, FLASH_RESIDENT>::trailer() const
+    -> const SectorTrailer & {
+  return *reinterpret_cast<const SectorTrailer *>(
+      getBaseAddr(_sec) + getSize(_sec) - sizeof(SectorTrailer));
+}
+
+template <size_t NMAX_MOTION_SEGMENTS, bool FLASH_RESIDENT>
+void MotionPattern<NMAX_MOTION_SEGMENTS, FLASH_RESIDENT>::eraseSector() {
   if (!flash::unlock()) {
     PRINTE("flash::unlock() failed. Forcing reset...");
     exit(-4);
   }
 
+  /*
+   * The marker flags an interrupted erase at boot. The reference manual leaves
+   * the content of a sector undefined after an interrupted erase: recovery
+   * relies on the marker, the last byte of the sector, not reading ERASED
+   * before all of the sector does, as when the erase proceeds from the sector
+   * start (which the emulator models). Should a torn erase still pass for
+   * complete, the format word, programmed only afterward, is missing: such a
+   * sector is adopted only if entirely blank.
+   */
+  setOperation(flash::Op::PG);
+  flash::program(trailer().erase_marker, DIRTY);
+
+  /* stall: erasing an unmarked sector would go unnoticed if interrupted */
+  if (isActive(flash::PGERR)) {
+    flash::lock();
+    PRINTE("Failed marking sector S%d for erase. Forcing reset...",
+           static_cast<uint32_t>(_sec));
+    exit(-4);
+  }
+
   setOperation(flash::Op::SER);
   setParallelism(flash::PSize::x32);
   setSector(_sec);
   flash::startErase();
 
-  /* stall and lock */
+  /* completed, with interrupts served meanwhile: lock */
   flash::lock();
   PRINTD("Sector S%d erased", static_cast<uint32_t>(_sec));
+
+  programFormat();
 }
 
-template <size_t NMAX_MOTION_SEGMENTS>
-MotionPattern<NMAX_MOTION_SEGMENTS>::MotionPattern(const flash::Sector &sec)
-    : _sec(sec), _fchunk(reinterpret_cast<FlashChunk *>(getBaseAddr(sec))),
-      _fchunk_idx(0), _n(0) {
-  const auto sec_size = getSize(_sec);
-  const auto n_fchunks = sec_size / sizeof(FlashChunk);
+template <size_t NMAX_MOTION_SEGMENTS, bool FLASH_RESIDENT>
+void MotionPattern<NMAX_MOTION_SEGMENTS, FLASH_RESIDENT>::programFormat() {
+  if (!flash::unlock()) {
+    PRINTE("flash::unlock() failed. Forcing reset...");
+    exit(-4);
+  }
+
+  setOperation(flash::Op::PG);
+  flash::program(trailer().format, FORMAT);
+
+  /* stall and lock */
+  flash::lock();
+  if (isActive(flash::PGERR)) {
+    PRINTE("Failed programming the format of sector S%d. Forcing reset...",
+           static_cast<uint32_t>(_sec));
+    exit(-4);
+  }
+}
+
+template <size_t NMAX_MOTION_SEGMENTS, bool FLASH_RESIDENT>
+void MotionPattern<NMAX_MOTION_SEGMENTS, FLASH_RESIDENT>::checkFormat() {
+  const auto format = trailer().format;
+  if (format == FORMAT) return;
+
+  /* A reset between the erase and the format leaves a blank sector, while any
+   * layout in use has programmed the first chunk, and a torn erase leaves
+   * programmed bits behind */
+  const auto *p = reinterpret_cast<const uint8_t *>(getBaseAddr(_sec));
+  bool blank = format == FORMAT_ERASED;
+  for (size_t i = 0; blank && i < getSize(_sec) - sizeof(SectorTrailer); ++i)
+    blank = p[i] == 0xFF;
+
+  if (blank) {
+    programFormat();
+    return;
+  }
+
+  /* The pattern is lost, rather than misread */
+  PRINTE("Sector S%d: unsupported pattern format 0x%08x (expected 0x%08x). "
+         "Erasing...",
+         static_cast<uint32_t>(_sec), format, FORMAT);
+  eraseSector();
+}
+
+template <size_t NMAX_MOTION_SEGMENTS, bool FLASH_RESIDENT>
+bool MotionPattern<NMAX_MOTION_SEGMENTS, FLASH_RESIDENT>::isBlank(
+    const FlashChunkEntry &e) {
+  const auto *p = reinterpret_cast<const uint8_t *>(&e);
+  for (size_t i = 0; i < sizeof(e); ++i)
+    if (p[i] != 0xFF) return false;
+
+  return true;
+}
+
+template <size_t NMAX_MOTION_SEGMENTS, bool FLASH_RESIDENT>
+size_t MotionPattern<NMAX_MOTION_SEGMENTS, FLASH_RESIDENT>::firstBlankSlot(
+    const FlashChunk &c) {
+  /* Slots are programmed in order */
+  size_t slot = 0;
+  while (slot < n_slots && !isBlank(c.entries[slot])) ++slot;
+  return slot;
+}
+
+template <size_t NMAX_MOTION_SEGMENTS, bool FLASH_RESIDENT>
+bool MotionPattern<NMAX_MOTION_SEGMENTS, FLASH_RESIDENT>::hasCommitted(
+    const FlashChunk &c) {
+  for (const auto &e : c.entries) {
+    if (e.attr == WRITTEN) return true;
+    if (isBlank(e)) break;
+  }
+  return false;
+}
+
+template <size_t NMAX_MOTION_SEGMENTS, bool FLASH_RESIDENT>
+auto MotionPattern<NMAX_MOTION_SEGMENTS, FLASH_RESIDENT>::decode(
+    const FlashChunkEntry &e) -> MotionSegment {
+  return {e.milli_rev_per_minute, e.steps,
+          static_cast<BStepper::Direction>(e.tag & DIR_MASK),
+          static_cast<Opcode>((e.tag & ~KIND_MASK) >> OP_SHIFT)};
+}
+
+template <size_t NMAX_MOTION_SEGMENTS, bool FLASH_RESIDENT>
+bool MotionPattern<NMAX_MOTION_SEGMENTS, FLASH_RESIDENT>::compile(
+    const MotionSegment &ms, size_t pos, BStepper::Plan &p) const {
+  const auto a = ms.milli_rev_per_minute;
+  const auto b = static_cast<size_t>(ms.steps);
+
+  if (ms.op == MOVE)
+    return _stepper.compile(ms.steps, a, ms.direction, p);
+
+  /* Checked against the capacity: forward references are filled later */
+  p = {};
+  switch (ms.op) {
+  case REPEAT:
+    return pos + 1 + b <= max_size();
+  case CALL:
+    return !a && b < max_size();
+  case DWELL:
+    return !b;
+  case RET:
+  case WAIT:
+    return !a && !b;
+  default:
+    return false;
+  }
+}
+
+template <size_t NMAX_MOTION_SEGMENTS, bool FLASH_RESIDENT>
+MotionPattern<NMAX_MOTION_SEGMENTS, FLASH_RESIDENT>::MotionPattern(
+    const flash::Sector &sec, const BStepper &stepper)
+    : _sec(sec), _stepper(stepper),
+      _fchunk(reinterpret_cast<const FlashChunk *>(getBaseAddr(sec))),
+      _fchunk_idx(0), _slot(0), _n(0), _batch(false), _staged(0),
+      _head(nullptr) {
+  const auto n_fchunks = fchunkCount();
+  const auto *fchunks = _fchunk;
 
   PRINTD("Sector S%d (0x%08x, %uB): n_fchunks = %u, sizeof(FlashChunk) = %uB",
-         static_cast<uint32_t>(_sec), _fchunk, sec_size, n_fchunks,
-         sizeof(FlashChunk));
+         static_cast<uint32_t>(_sec), reinterpret_cast<uintptr_t>(_fchunk),
+         getSize(_sec), n_fchunks, sizeof(FlashChunk));
 
-  /* Find first non-dirty chunk */
-  while (_fchunk_idx < n_fchunks && (*_fchunk)->attr == DIRTY) {
-    ++_fchunk_idx;
-    ++_fchunk;
+  /* Resume an interrupted erase */
+  if (trailer().erase_marker != ERASED) {
+    PRINTD("Sector S%d erase was interrupted", static_cast<uint32_t>(_sec));
+    eraseSector();
+  } else {
+    checkFormat();
   }
 
+  /* Chunks are marked dirty in order, so the dirty ones form a prefix:
+   * binary search the first non-dirty chunk */
+  size_t lo = 0;
+  size_t hi = n_fchunks;
+  while (lo < hi) {
+    const auto mid = lo + (hi - lo) / 2;
+    if (fchunks[mid].attr != ERASED)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  _fchunk_idx = lo;
+  _fchunk = fchunks + lo;
+
   /* All chunks dirty? Erase the sector */
   if (_fchunk_idx == n_fchunks) {
-    erase();
+    eraseSector();
     _fchunk_idx = 0;
-    _fchunk = reinterpret_cast<FlashChunk *>(getBaseAddr(_sec));
+    _fchunk = fchunks;
   }
 
-  /* Load cache from written entries */
-  while (_n < max_size() && (*_fchunk)[_n].attr == WRITTEN) {
-    _cchunk[_n].milli_rev_per_minute = (*_fchunk)[_n].milli_rev_per_minute;
-    _cchunk[_n].steps = (*_fchunk)[_n].steps;
-    _cchunk[_n].direction = (*_fchunk)[_n].direction;
-    ++_n;
+  /* A compaction commits the live segments to a following chunk before marking
+   * the ones in between dirty: complete it, if it was interrupted. Only the
+   * records of interrupted compactions can precede it */
+  for (auto *c = _fchunk + 1;
+       c < fchunks + n_fchunks && !isBlank(c->entries[0]); ++c) {
+    if (!hasCommitted(*c)) continue;
+
+    PRINTD("Completing compaction of fchunk %u", _fchunk_idx);
+    while (_fchunk != c) {
+      markDirty();
+      ++_fchunk_idx;
+      ++_fchunk;
+    }
+    break;
+  }
+
+  /* Load cache from written entries and committed batches, applying the edit
+   * records in order */
+  bool committed = false;
+  bool overriding = false;
+  size_t target = 0;
+
+  for (; _slot < n_slots; ++_slot) {
+    const auto &e = _fchunk->entries[_slot];
+
+    if (e.attr == WRITTEN) {
+      committed = true;
+      overriding = false;
+    } else if (e.attr == STAGED) {
+      committed = false;
+    } else if (e.attr != LINKED) {
+      if (isBlank(e)) break;
+
+      /* Programming was interrupted by a reset: the slot is lost, and so is
+       * the batch it belongs to */
+      PRINTD("Skipping torn slot %u of fchunk %u", _slot, _fchunk_idx);
+      committed = false;
+    }
+
+    if (!committed) continue;
+
+    switch (e.tag & KIND_MASK) {
+    case OVERRIDE:
+      overriding = true;
+      target = find(e.steps);
+      break;
+
+    case TOMBSTONE:
+      if (const auto pos = find(e.steps); pos < _n) remove(pos);
+      break;
+
+    default:
+      if (overriding) {
+        if (target < _n) cache(target, e);
+        overriding = false;
+      } else if (_n < max_size()) {
+        _ids[_n] = _slot;
+        cache(_n++, e);
+      }
+      break;
+    }
+  }
+}
+
+template <size_t NMAX_MOTION_SEGMENTS, bool FLASH_RESIDENT>
+void MotionPattern<NMAX_MOTION_SEGMENTS, FLASH_RESIDENT>::cache(
+    size_t pos, const FlashChunkEntry &e) {
+  /* Flash resident: decoded and compiled on access */
+  if constexpr (FLASH_RESIDENT) {
+    _slots[pos] = &e - _fchunk->entries;
+    return;
+  }
+
+  _cchunk[pos] = decode(e);
+
+  /* Invalid plans are kept, BStepper::rotate() rejects them */
+  if (!compile(_cchunk[pos], pos, _pchunk[pos]))
+    PRINTE("Failed compiling segment %u", pos);
+}
+
+template <size_t NMAX_MOTION_SEGMENTS, bool FLASH_RESIDENT>
+size_t MotionPattern<NMAX_MOTION_SEGMENTS, FLASH_RESIDENT>::find(
+    BStepper::StepCountType id) const {
+  size_t pos = 0;
+  while (pos < _n && _ids[pos] != id) ++pos;
+  return pos;
+}
+
+template <size_t NMAX_MOTION_SEGMENTS, bool FLASH_RESIDENT>
+BStepper::StepCountType
+MotionPattern<NMAX_MOTION_SEGMENTS, FLASH_RESIDENT>::idOf(size_t pos) const {
+  return _ids[pos];
+}
+
+template <size_t NMAX_MOTION_SEGMENTS, bool FLASH_RESIDENT>
+void MotionPattern<NMAX_MOTION_SEGMENTS, FLASH_RESIDENT>::remove(size_t pos) {
+  for (--_n; pos < _n; ++pos) {
+    _ids[pos] = _ids[pos + 1];
+
+    if constexpr (FLASH_RESIDENT) {
+      _slots[pos] = _slots[pos + 1];
+    } else {
+      _cchunk[pos] = _cchunk[pos + 1];
+      _pchunk[pos] = _pchunk[pos + 1];
+    }
   }
 }
 
-template <size_t NMAX_MOTION_SEGMENTS>
-auto MotionPattern<NMAX_MOTION_SEGMENTS>::operator[](size_t pos) const
-    -> const MotionSegment & {
-  return _cchunk[pos];
+template <size_t NMAX_MOTION_SEGMENTS, bool FLASH_RESIDENT>
+auto MotionPattern<NMAX_MOTION_SEGMENTS, FLASH_RESIDENT>::operator[](
+    size_t pos) const -> Reference {
+  if constexpr (FLASH_RESIDENT)
+    return decode(_fchunk->entries[_slots[pos]]);
+  else
+    return _cchunk[pos];
 }
 
-template <size_t NMAX_MOTION_SEGMENTS>
-auto MotionPattern<NMAX_MOTION_SEGMENTS>::data() const
-    -> const MotionSegment * {
+template <size_t NMAX_MOTION_SEGMENTS, bool FLASH_RESIDENT>
+auto MotionPattern<NMAX_MOTION_SEGMENTS, FLASH_RESIDENT>::data() const
+    -> const MotionSegment *
+  requires(!FLASH_RESIDENT)
+{
   return _cchunk.data();
 }
 
-template <size_t NMAX_MOTION_SEGMENTS>
-auto MotionPattern<NMAX_MOTION_SEGMENTS>::begin() const
-    -> const MotionSegment * {
-  return _cchunk.begin();
+template <size_t NMAX_MOTION_SEGMENTS, bool FLASH_RESIDENT>
+const BStepper::Plan &MotionPattern<NMAX_MOTION_SEGMENTS, FLASH_RESIDENT>::plan(
+    size_t pos) const {
+  if constexpr (FLASH_RESIDENT) {
+    /* Invalid plans are returned as well, BStepper::rotate() rejects them */
+    compile((*this)[pos], pos, _plan[0]);
+    return _plan[0];
+  } else {
+    return _pchunk[pos];
+  }
+}
+
+template <size_t NMAX_MOTION_SEGMENTS, bool FLASH_RESIDENT>
+auto MotionPattern<NMAX_MOTION_SEGMENTS, FLASH_RESIDENT>::begin() const
+    -> const_iterator {
+  if constexpr (FLASH_RESIDENT)
+    return {this, 0};
+  else
+    return _cchunk.begin();
 }
 
-template <size_t NMAX_MOTION_SEGMENTS>
-auto MotionPattern<NMAX_MOTION_SEGMENTS>::end() const -> const MotionSegment * {
-  return _cchunk.begin() + _n;
+template <size_t NMAX_MOTION_SEGMENTS, bool FLASH_RESIDENT>
+auto MotionPattern<NMAX_MOTION_SEGMENTS, FLASH_RESIDENT>::end() const
+    -> const_iterator {
+  if constexpr (FLASH_RESIDENT)
+    return {this, _n};
+  else
+    return _cchunk.begin() + _n;
 }
 
-template <size_t NMAX_MOTION_SEGMENTS>
-size_t MotionPattern<NMAX_MOTION_SEGMENTS>::size() const {
+template <size_t NMAX_MOTION_SEGMENTS, bool FLASH_RESIDENT>
+size_t MotionPattern<NMAX_MOTION_SEGMENTS, FLASH_RESIDENT>::size() const {
   return _n;
 }
 
-template <size_t NMAX_MOTION_SEGMENTS>
-bool MotionPattern<NMAX_MOTION_SEGMENTS>::empty() const {
+template <size_t NMAX_MOTION_SEGMENTS, bool FLASH_RESIDENT>
+bool MotionPattern<NMAX_MOTION_SEGMENTS, FLASH_RESIDENT>::empty() const {
   return !_n;
 }
 
-template <size_t NMAX_MOTION_SEGMENTS>
-void MotionPattern<NMAX_MOTION_SEGMENTS>::markDirty() {
+template <size_t NMAX_MOTION_SEGMENTS, bool FLASH_RESIDENT>
+bool MotionPattern<NMAX_MOTION_SEGMENTS, FLASH_RESIDENT>::full() const {
+  if (_n == max_size()) return true;
+  if (_slot < n_slots) return false;
+
+  return !compactionTarget(1);
+}
+
+template <size_t NMAX_MOTION_SEGMENTS, bool FLASH_RESIDENT>
+size_t MotionPattern<NMAX_MOTION_SEGMENTS, FLASH_RESIDENT>::compactionTarget(
+    size_t n) const {
+  /* Chunks are skipped only if filled by interrupted compactions */
+  for (size_t d = 1; _fchunk_idx + d < fchunkCount(); ++d)
+    if (firstBlankSlot(_fchunk[d]) + _n + n <= n_slots) return d;
+
+  return 0;
+}
+
+template <size_t NMAX_MOTION_SEGMENTS, bool FLASH_RESIDENT>
+void MotionPattern<NMAX_MOTION_SEGMENTS, FLASH_RESIDENT>::markDirty() {
   if (!flash::unlock()) {
     PRINTE("flash::unlock() failed. Forcing reset...");
     exit(-4);
   }
 
   setOperation(flash::Op::PG);
-  flash::setParallelism(FlashChunkAttribute{});
-  (*_fchunk)->attr = DIRTY;
+  flash::program(_fchunk->attr, DIRTY);
 
   /* stall and lock */
   flash::lock();
   if (isActive(flash::PGERR)) {
     PRINTE("Failed marking fchunk %u (0x%08x) DIRTY. Forcing reset...",
-           _fchunk_idx, _fchunk);
+           _fchunk_idx, reinterpret_cast<uintptr_t>(_fchunk));
     exit(-4);
   }
-  PRINTD("fchunk %u (0x%08x) marked DIRTY", _fchunk_idx, _fchunk);
+  PRINTD("fchunk %u (0x%08x) marked DIRTY", _fchunk_idx,
+         reinterpret_cast<uintptr_t>(_fchunk));
+}
+
+template <size_t NMAX_MOTION_SEGMENTS, bool FLASH_RESIDENT>
+bool MotionPattern<NMAX_MOTION_SEGMENTS, FLASH_RESIDENT>::programEntry(
+    const FlashChunkEntry &dst, const FlashChunkEntry &src) {
+  if (src.milli_rev_per_minute !=
+      std::numeric_limits<BStepper::SpeedType>::max())
+    flash::program(dst.milli_rev_per_minute, src.milli_rev_per_minute);
+
+  if (src.steps != std::numeric_limits<BStepper::StepCountType>::max())
+    flash::program(dst.steps, src.steps);
+
+  flash::program(dst.tag, src.tag);
+
+  if (isActive(flash::PGERR, true)) return false;
+
+  /* Fail-safe update by changing the entry attribute last */
+  flash::program(dst.attr, src.attr);
+  return !isActive(flash::PGERR, true);
+}
+
+template <size_t NMAX_MOTION_SEGMENTS, bool FLASH_RESIDENT>
+bool MotionPattern<NMAX_MOTION_SEGMENTS, FLASH_RESIDENT>::reserve(size_t n) {
+  return _slot + n <= n_slots || compact(n);
+}
+
+template <size_t NMAX_MOTION_SEGMENTS, bool FLASH_RESIDENT>
+bool MotionPattern<NMAX_MOTION_SEGMENTS, FLASH_RESIDENT>::compact(size_t n) {
+  /* The last chunk can only be recycled by clear() */
+  const auto d = compactionTarget(n);
+  if (!d) return false;
+
+  /* An interrupted compaction may have left uncommitted records behind */
+  const auto &next = _fchunk[d];
+  const auto first = firstBlankSlot(next);
+
+  PRINTD("Compacting fchunk %u: %u segments in %u slots", _fchunk_idx, _n,
+         _slot);
+
+  if (!flash::unlock()) {
+    PRINTE("flash::unlock() failed. Unable to set Op::PG");
+    return false;
+  }
+
+  setOperation(flash::Op::PG);
+
+  /* Copy the live segments as a batch */
+  bool ok = true;
+  size_t pos = 0;
+  for (auto it = begin(); ok && it != end(); ++it, ++pos) {
+    const MotionSegment ms = *it;
+    ok = programEntry(
+        next.entries[first + pos],
+        {ms.milli_rev_per_minute, ms.steps,
+         makeTag(SEGMENT, ms.direction, ms.op), pos ? LINKED : STAGED});
+  }
+
+  if (ok && _n) {
+    flash::program(next.entries[first].attr, WRITTEN);
+    ok = !isActive(flash::PGERR, true);
+  }
+
+  flash::lock();
+  if (!ok) {
+    PRINTE("Compacting fchunk %u failed", _fchunk_idx);
+    return false;
+  }
+
+  /* Committed: this chunk, and the skipped ones, are superseded */
+  for (size_t i = 0; i < d; ++i) {
+    markDirty();
+    ++_fchunk_idx;
+    ++_fchunk;
+  }
+
+  for (pos = 0; pos < _n; ++pos) {
+    _ids[pos] = first + pos;
+    if constexpr (FLASH_RESIDENT) _slots[pos] = first + pos;
+  }
+  _slot = first + _n;
+  return true;
 }
 
-template <size_t NMAX_MOTION_SEGMENTS>
-void MotionPattern<NMAX_MOTION_SEGMENTS>::clear() {
-  const auto max_fchunk_idx = getSize(_sec) / sizeof(FlashChunk) - 1;
+template <size_t NMAX_MOTION_SEGMENTS, bool FLASH_RESIDENT>
+void MotionPattern<NMAX_MOTION_SEGMENTS, FLASH_RESIDENT>::clear() {
+  const auto max_fchunk_idx = fchunkCount() - 1;
+
+  if (_batch) abortBatch();
+
+  /* Nothing to invalidate: spare the chunk */
+  if (!_slot) return;
+
   PRINTD("Clearing fchunk %u/%u ...", _fchunk_idx, max_fchunk_idx);
 
   if (_fchunk_idx == max_fchunk_idx) {
     /* marking the chunk dirty leaves no usable fchunk */
-    erase();
+    eraseSector();
     _fchunk_idx = 0;
-    _fchunk = reinterpret_cast<FlashChunk *>(getBaseAddr(_sec));
+    _fchunk = reinterpret_cast<const FlashChunk *>(getBaseAddr(_sec));
+    _slot = 0;
   } else {
-    /* next chunk is erased */
+    /* next chunk is erased, but for an interrupted compaction */
     markDirty();
     ++_fchunk_idx;
     ++_fchunk;
+    _slot = firstBlankSlot(*_fchunk);
   }
 
   /* Clear cache */
   _n = 0;
 }
 
-template <size_t NMAX_MOTION_SEGMENTS>
-auto MotionPattern<NMAX_MOTION_SEGMENTS>::pushBack(
+template <size_t NMAX_MOTION_SEGMENTS, bool FLASH_RESIDENT>
+auto MotionPattern<NMAX_MOTION_SEGMENTS, FLASH_RESIDENT>::pushBack(
     BStepper::SpeedType milli_rev_per_minute, BStepper::StepCountType steps,
-    BStepper::Direction direction) -> const MotionSegment * {
+    BStepper::Direction direction) -> Result {
+  return pushBack({milli_rev_per_minute, steps, direction});
+}
+
+template <size_t NMAX_MOTION_SEGMENTS, bool FLASH_RESIDENT>
+auto MotionPattern<NMAX_MOTION_SEGMENTS, FLASH_RESIDENT>::pushBack(
+    const MotionSegment &ms) -> Result {
+
+  if (_batch || _n == max_size() || !reserve(1)) return {};
+
+  /* Reject segments the motor cannot execute, before committing */
+  BStepper::Plan p;
+  if (!compile(ms, _n, p)) {
+    PRINTE("Failed compiling segment %u", _n);
+    return {};
+  }
 
   if (!flash::unlock()) {
     PRINTE("flash::unlock() failed. Unable to set Op::PG");
-    return nullptr;
+    return {};
   }
 
   setOperation(flash::Op::PG);
 
-  flash::setParallelism(BStepper::SpeedType{});
-  (*_fchunk)[_n].milli_rev_per_minute = milli_rev_per_minute;
+  /* From now on, the slot is consumed even if programming fails */
+  const auto id = _slot++;
+  const bool ok = programEntry(
+      _fchunk->entries[id],
+      {ms.milli_rev_per_minute, ms.steps,
+       makeTag(SEGMENT, ms.direction, ms.op), WRITTEN});
+  flash::lock();
+
+  if (!ok) {
+    PRINTE("Programming slot %u of fchunk %u failed", id, _fchunk_idx);
+    return {};
+  }
+
+  _ids[_n] = id;
 
-  flash::setParallelism(BStepper::StepCountType{});
-  (*_fchunk)[_n].steps = steps;
+  if constexpr (FLASH_RESIDENT) {
+    _slots[_n++] = id;
+    return true;
+  } else {
+    /* Cache update */
+    _cchunk[_n] = ms;
+    _pchunk[_n] = p;
+    return &_cchunk[_n++];
+  }
+}
 
-  flash::setParallelism(BStepper::Direction{});
-  (*_fchunk)[_n].direction = direction;
+template <size_t NMAX_MOTION_SEGMENTS, bool FLASH_RESIDENT>
+auto MotionPattern<NMAX_MOTION_SEGMENTS, FLASH_RESIDENT>::replace(size_t pos,
+                                                  const MotionSegment &ms)
+    -> Result {
+  if (_batch || pos >= _n || !reserve(2)) return {};
 
-  if (isActive(flash::PGERR, true)) {
-    PRINTE("Programming (*0x%08x)[%u] failed", _fchunk, _n);
-    return nullptr;
+  BStepper::Plan p;
+  if (!compile(ms, pos, p)) {
+    PRINTE("Failed compiling segment %u", pos);
+    return {};
   }
 
-  /* Fail-safe update by changing the entry attribute last */
-  flash::setParallelism(FlashChunkAttribute{});
-  (*_fchunk)[_n].attr = WRITTEN;
+  /* Resolved after compaction, which renumbers the segments */
+  const auto id = idOf(pos);
+
+  if (!flash::unlock()) {
+    PRINTE("flash::unlock() failed. Unable to set Op::PG");
+    return {};
+  }
+
+  setOperation(flash::Op::PG);
+
+  /* Two-record batch: the override, then the new segment */
+  const auto &head = _fchunk->entries[_slot++];
+  const auto &e = _fchunk->entries[_slot++];
+
+  bool ok =
+      programEntry(head, {std::numeric_limits<BStepper::SpeedType>::max(),
+                          id, makeTag(OVERRIDE), STAGED}) &&
+      programEntry(e, {ms.milli_rev_per_minute, ms.steps,
+                       makeTag(SEGMENT, ms.direction, ms.op), LINKED});
+
+  if (ok) {
+    flash::program(head.attr, WRITTEN);
+    ok = !isActive(flash::PGERR, true);
+  }
+
+  flash::lock();
+  if (!ok) {
+    PRINTE("Replacing segment %u failed", pos);
+    return {};
+  }
+
+  if constexpr (FLASH_RESIDENT) {
+    _slots[pos] = &e - _fchunk->entries;
+    return true;
+  } else {
+    _cchunk[pos] = ms;
+    _pchunk[pos] = p;
+    return &_cchunk[pos];
+  }
+}
+
+template <size_t NMAX_MOTION_SEGMENTS, bool FLASH_RESIDENT>
+bool MotionPattern<NMAX_MOTION_SEGMENTS, FLASH_RESIDENT>::erase(size_t pos) {
+  if (_batch || pos >= _n || !reserve(1)) return false;
+
+  const auto id = idOf(pos);
+
+  if (!flash::unlock()) {
+    PRINTE("flash::unlock() failed. Unable to set Op::PG");
+    return false;
+  }
+
+  setOperation(flash::Op::PG);
+  const bool ok = programEntry(
+      _fchunk->entries[_slot++],
+      {std::numeric_limits<BStepper::SpeedType>::max(), id,
+       makeTag(TOMBSTONE), WRITTEN});
   flash::lock();
 
-  if (isActive(flash::PGERR, true)) {
-    PRINTE("Programming (*0x%08x)[%u] failed", _fchunk, _n);
-    return nullptr;
+  if (!ok) {
+    PRINTE("Erasing segment %u failed", pos);
+    return false;
   }
 
-  /* Cache update */
-  _cchunk[_n].milli_rev_per_minute = milli_rev_per_minute;
-  _cchunk[_n].steps = steps;
-  _cchunk[_n].direction = direction;
-  return &_cchunk[_n++];
+  remove(pos);
+  return true;
+}
+
+template <size_t NMAX_MOTION_SEGMENTS, bool FLASH_RESIDENT>
+bool MotionPattern<NMAX_MOTION_SEGMENTS, FLASH_RESIDENT>::beginBatch() {
+  if (_batch) return false;
+
+  /* The chunk is compacted only if the batch runs out of slots */
+  if (!flash::unlock()) {
+    PRINTE("flash::unlock() failed. Unable to set Op::PG");
+    return false;
+  }
+
+  setOperation(flash::Op::PG);
+  _batch = true;
+  _staged = 0;
+  _head = nullptr;
+  return true;
+}
+
+template <size_t NMAX_MOTION_SEGMENTS, bool FLASH_RESIDENT>
+auto MotionPattern<NMAX_MOTION_SEGMENTS, FLASH_RESIDENT>::append(
+    const MotionSegment &ms) -> Result {
+  if (!_batch) return {};
+
+  const auto pos = _n + _staged;
+  BStepper::Plan p;
+  if (pos == max_size() || !compile(ms, pos, p) ||
+      (_slot == n_slots && !carryBatch())) {
+    abortBatch();
+    return {};
+  }
+
+  /* From now on, the slot is consumed even if programming fails */
+  const auto id = _slot++;
+  const auto &e = _fchunk->entries[id];
+
+  if (!programEntry(e, {ms.milli_rev_per_minute, ms.steps,
+                        makeTag(SEGMENT, ms.direction, ms.op),
+                        _staged ? LINKED : STAGED})) {
+    PRINTE("Programming slot %u of fchunk %u failed", id, _fchunk_idx);
+    abortBatch();
+    return {};
+  }
+
+  if (!_staged) _head = &e;
+  ++_staged;
+  _ids[pos] = id;
+
+  if constexpr (FLASH_RESIDENT) {
+    _slots[pos] = id;
+    return true;
+  } else {
+    _cchunk[pos] = ms;
+    _pchunk[pos] = p;
+    return &_cchunk[pos];
+  }
+}
+
+template <size_t NMAX_MOTION_SEGMENTS, bool FLASH_RESIDENT>
+bool MotionPattern<NMAX_MOTION_SEGMENTS, FLASH_RESIDENT>::carryBatch() {
+  /* Still readable once the chunk is marked dirty */
+  const auto *staged = _head;
+
+  /* Room for the staged entries and the one being appended */
+  if (!compact(_staged + 1)) return false;
+
+  if (!flash::unlock()) {
+    PRINTE("flash::unlock() failed. Unable to set Op::PG");
+    return false;
+  }
+  setOperation(flash::Op::PG);
+
+  /* Programmed as they were, so the batch is still uncommitted */
+  for (size_t i = 0; i < _staged; ++i) {
+    const auto id = _slot++;
+    const auto &e = _fchunk->entries[id];
+
+    if (!programEntry(e, staged[i])) {
+      PRINTE("Programming slot %u of fchunk %u failed", id, _fchunk_idx);
+      return false;
+    }
+
+    if (!i) _head = &e;
+    _ids[_n + i] = id;
+    if constexpr (FLASH_RESIDENT) _slots[_n + i] = id;
+  }
+  return true;
+}
+
+template <size_t NMAX_MOTION_SEGMENTS, bool FLASH_RESIDENT>
+bool MotionPattern<NMAX_MOTION_SEGMENTS, FLASH_RESIDENT>::commit() {
+  if (!_batch) return false;
+
+  if (_staged) {
+    /* Single-bit commit */
+    flash::program(_head->attr, WRITTEN);
+
+    if (isActive(flash::PGERR, true)) {
+      PRINTE("Committing batch at slot %u of fchunk %u failed",
+             _head - _fchunk->entries, _fchunk_idx);
+      abortBatch();
+      return false;
+    }
+  }
+
+  flash::lock();
+  _n += _staged;
+  _batch = false;
+  _staged = 0;
+  return true;
+}
+
+template <size_t NMAX_MOTION_SEGMENTS, bool FLASH_RESIDENT>
+void MotionPattern<NMAX_MOTION_SEGMENTS, FLASH_RESIDENT>::abortBatch() {
+  if (!_batch) return;
+
+  /* The staged entries are skipped at the next boot */
+  flash::lock();
+  _batch = false;
+  _staged = 0;
+}
+
+template <size_t NMAX_MOTION_SEGMENTS, bool FLASH_RESIDENT>
+MotionPattern<NMAX_MOTION_SEGMENTS, FLASH_RESIDENT>::FlashIterator::
+    FlashIterator(const MotionPattern *mp, size_t pos)
+    : _mp(mp), _pos(pos) {}
+
+template <size_t NMAX_MOTION_SEGMENTS, bool FLASH_RESIDENT>
+auto MotionPattern<NMAX_MOTION_SEGMENTS, FLASH_RESIDENT>::FlashIterator::
+operator*() const -> MotionSegment {
+  return (*_mp)[_pos];
+}
+
+template <size_t NMAX_MOTION_SEGMENTS, bool FLASH_RESIDENT>
+auto MotionPattern<NMAX_MOTION_SEGMENTS, FLASH_RESIDENT>::FlashIterator::
+operator++() -> FlashIterator & {
+  ++_pos;
+  return *this;
+}
+
+template <size_t NMAX_MOTION_SEGMENTS, bool FLASH_RESIDENT>
+auto MotionPattern<NMAX_MOTION_SEGMENTS, FLASH_RESIDENT>::FlashIterator::
+operator++(int) -> FlashIterator {
+  auto tmp = *this;
+  ++*this;
+  return tmp;
 }
 
-template <size_t NMAX_MOTION_SEGMENTS>
-auto MotionPattern<NMAX_MOTION_SEGMENTS>::pushBack(
-    const MotionSegment &ms) -> const MotionSegment * {
-  return pushBack(ms.milli_rev_per_minute, ms.steps, ms.direction);
+template <size_t NMAX_MOTION_SEGMENTS, bool FLASH_RESIDENT>
+bool MotionPattern<NMAX_MOTION_SEGMENTS, FLASH_RESIDENT>::FlashIterator::
+operator==(const FlashIterator &other) const {
+  return _mp == other._mp && _pos == other._pos;
 }
 
-#endif // MOTIONPATTERN_TPP
\ No newline at end of file
+#endif // MOTIONPATTERN_TPP
@@ -0,0 +1,82 @@
+/**
+ * @file     MotionVM.hpp
+ * @author   Fabio Scatozza <s315216@studenti.polito.it>
+ * @date     18.10.2026
+ *
+ * Playback of the motion bytecode stored in a MotionPattern. The program
+ * counter is the position in the pattern; operands a and b are held in place
+ * of the speed and of the steps:
+ *   MOVE    a: milli-rpm, b: steps  rotation, as a plain segment
+ *   REPEAT  a: count, b: length     run the next b instructions a times
+ *   CALL    b: target               jump, pushing the return position
+ *   RET                             pop, or restart at top level
+ *   DWELL   a: ms                   hold the position
+ *   WAIT                            hold until the user resumes
+ * Control instructions are resolved by next(), which returns the following
+ * action for the caller to perform. Running past the last instruction
+ * restarts the program, so that plain patterns are replayed circularly.
+ */
+
+#ifndef MOTIONVM_HPP
+#define MOTIONVM_HPP
+
+#include "BStepper.h"
+#include "debug.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+/* With a flash resident pattern, MOVE plans are valid until the next call */
+template <typename Pattern, size_t STACK_DEPTH = 8>
+class MotionVM {
+public:
+  enum ActionKind : uint8_t { MOVE, DWELL, WAIT, HALT };
+
+  struct Action {
+    ActionKind kind;
+    const BStepper::Plan *plan; /* MOVE */
+    uint32_t ms;                /* DWELL, never 0 */
+  };
+
+  /* The pattern must not be modified while the program runs */
+  explicit MotionVM(const Pattern &mp);
+
+  /* Restart from the first instruction */
+  void reset();
+
+  /**
+   * @brief Resolve the control instructions up to the next action
+   * @return HALT, for good, if the program is empty or malformed, or if more
+   * than max_size() control instructions separate two actions, which bounds
+   * the cost of a call
+   */
+  Action next();
+
+  size_t pc() const;
+  /* Instructions fetched by the last next(), the action included */
+  size_t fetched() const;
+
+private:
+  struct Frame {
+    size_t start; /* First instruction of the loop body, or return position */
+    size_t end;   /* Past the loop body, or CALL_FRAME */
+    uint32_t count; /* Iterations left */
+  };
+
+  static constexpr size_t CALL_FRAME = SIZE_MAX;
+
+  bool push(const Frame &f);
+  Action halt(const char *why);
+
+  const Pattern &_mp;
+  std::array<Frame, STACK_DEPTH> _stack;
+  size_t _sp;
+  size_t _pc;
+  size_t _fetched;
+  bool _halted;
+};
+
+#include "MotionVM.tpp"
+
+#endif // MOTIONVM_HPP
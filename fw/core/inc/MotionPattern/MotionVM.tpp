@@ -0,0 +1,132 @@
+/**
+ * @file     MotionVM.tpp
+ * @author   Fabio Scatozza <s315216@studenti.polito.it>
+ * @date     18.10.2026
+ */
+
+#ifndef MOTIONVM_TPP
+#define MOTIONVM_TPP
+
+template <typename Pattern, size_t STACK_DEPTH>
+MotionVM<Pattern, STACK_DEPTH>::MotionVM(const Pattern &mp) : _mp(mp) {
+  reset();
+}
+
+template <typename Pattern, size_t STACK_DEPTH>
+void MotionVM<Pattern, STACK_DEPTH>::reset() {
+  _sp = 0;
+  _pc = 0;
+  _fetched = 0;
+  _halted = false;
+}
+
+template <typename Pattern, size_t STACK_DEPTH>
+size_t MotionVM<Pattern, STACK_DEPTH>::pc() const {
+  return _pc;
+}
+
+template <typename Pattern, size_t STACK_DEPTH>
+size_t MotionVM<Pattern, STACK_DEPTH>::fetched() const {
+  return _fetched;
+}
+
+template <typename Pattern, size_t STACK_DEPTH>
+bool MotionVM<Pattern, STACK_DEPTH>::push(const Frame &f) {
+  if (_sp == _stack.size()) return false;
+
+  _stack[_sp++] = f;
+  return true;
+}
+
+template <typename Pattern, size_t STACK_DEPTH>
+auto MotionVM<Pattern, STACK_DEPTH>::halt(const char *why) -> Action {
+  PRINTE("Motion program halted at %u: %s", _pc, why);
+  _halted = true;
+  return {HALT, nullptr, 0};
+}
+
+template <typename Pattern, size_t STACK_DEPTH>
+auto MotionVM<Pattern, STACK_DEPTH>::next() -> Action {
+  _fetched = 0;
+  if (_halted) return {HALT, nullptr, 0};
+
+  const auto n = _mp.size();
+  if (!n) return halt("empty program");
+
+  /* The action itself is fetched as well */
+  for (_fetched = 1; _fetched <= Pattern::max_size() + 1; ++_fetched) {
+    /* Close the loops whose body is over: repeat, or pop */
+    while (_sp && _stack[_sp - 1].end == _pc) {
+      if (--_stack[_sp - 1].count)
+        _pc = _stack[_sp - 1].start;
+      else
+        --_sp;
+    }
+
+    /* Past the last instruction, with any pending call discarded */
+    if (_pc >= n) {
+      _pc = 0;
+      _sp = 0;
+    }
+
+    const auto &ins = _mp[_pc];
+    const auto a = ins.milli_rev_per_minute;
+    const auto b = static_cast<size_t>(ins.steps);
+
+    switch (ins.op) {
+    case Pattern::MOVE: {
+      const auto &p = _mp.plan(_pc);
+      if (!p.steps) return halt("segment cannot be executed");
+
+      ++_pc;
+      return {MOVE, &p, 0};
+    }
+
+    case Pattern::REPEAT:
+      /* The body must be nested within the enclosing one, even if skipped:
+       * jumping past its end would leave the enclosing loop open */
+      if (_pc + 1 + b > n ||
+          (_sp && _stack[_sp - 1].end != CALL_FRAME &&
+           _pc + 1 + b > _stack[_sp - 1].end))
+        return halt("loop body out of bounds");
+
+      /* Empty loops are skipped */
+      if (!a || !b) {
+        _pc += 1 + b;
+        break;
+      }
+
+      if (!push({_pc + 1, _pc + 1 + b, a})) return halt("stack overflow");
+      ++_pc;
+      break;
+
+    case Pattern::CALL:
+      if (b >= n) return halt("call target out of bounds");
+      if (!push({_pc + 1, CALL_FRAME, 0})) return halt("stack overflow");
+      _pc = b;
+      break;
+
+    case Pattern::RET:
+      /* Unwind the loops of the callee */
+      while (_sp && _stack[_sp - 1].end != CALL_FRAME) --_sp;
+      _pc = _sp ? _stack[--_sp].start : n;
+      break;
+
+    case Pattern::DWELL:
+      ++_pc;
+      if (a) return {DWELL, nullptr, a};
+      break;
+
+    case Pattern::WAIT:
+      ++_pc;
+      return {WAIT, nullptr, 0};
+
+    default:
+      return halt("unknown opcode");
+    }
+  }
+
+  return halt("no action within max_size() instructions");
+}
+
+#endif // MOTIONVM_TPP
@@ -8,6 +8,7 @@
 #define PUSHBUTTON_HPP
 
 #include "CallbackUtils.hpp"
+#include "ramfunc.h"
 #include "stm32f4xx.h"
 
 template <typename HwAlarm, bool FALLING_TRIGGER = true>
@@ -43,6 +44,7 @@ private:
   uint32_t _pin_mask;
   HwAlarm &_hw_alarm;
   CallbackType _alarm_cb;
+  typename HwAlarm::VirtualAlarm _alarm; /* Debouncing tolerates latency */
 
   volatile State _state;
   MilliSeconds _reject;
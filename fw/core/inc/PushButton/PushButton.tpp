@@ -16,11 +16,12 @@ PushButton<HwAlarm, FALLING_TRIGGER>::PushButton(GPIO_TypeDef *gpio,
                                                 MilliSeconds reject,
                                                 MilliSeconds long_press)
     : _gpio(gpio), _pin_mask(pin_mask), _hw_alarm(hw_alarm),
-      _alarm_cb(this, &PushButton::alarm), _state(OFF), _reject(reject),
-      _long_press_residual(long_press - reject) {}
+      _alarm_cb(this, &PushButton::alarm), _alarm(&_alarm_cb), _state(OFF),
+      _reject(reject), _long_press_residual(long_press - reject) {}
 
 template <typename HwAlarm, bool FALLING_TRIGGER>
-void PushButton<HwAlarm, FALLING_TRIGGER>::enableTrig(Edge edge) const {
+RAMFUNC void PushButton<HwAlarm, FALLING_TRIGGER>::enableTrig(
+    Edge edge) const {
   if (edge == FALLING_TRIGGER)
     LL_EXTI_EnableFallingTrig_0_31(_pin_mask);
   else
@@ -28,7 +29,8 @@ void PushButton<HwAlarm, FALLING_TRIGGER>::enableTrig(Edge edge) const {
 }
 
 template <typename HwAlarm, bool FALLING_TRIGGER>
-void PushButton<HwAlarm, FALLING_TRIGGER>::disableTrig(Edge edge) const {
+RAMFUNC void PushButton<HwAlarm, FALLING_TRIGGER>::disableTrig(
+    Edge edge) const {
   if (edge == FALLING_TRIGGER)
     LL_EXTI_DisableFallingTrig_0_31(_pin_mask);
   else
@@ -39,7 +41,8 @@ void PushButton<HwAlarm, FALLING_TRIGGER>::disableTrig(Edge edge) const {
 }
 
 template <typename HwAlarm, bool FALLING_TRIGGER>
-bool PushButton<HwAlarm, FALLING_TRIGGER>::isEnabledTrig(Edge edge) const {
+RAMFUNC bool PushButton<HwAlarm, FALLING_TRIGGER>::isEnabledTrig(
+    Edge edge) const {
   return edge == FALLING_TRIGGER ? LL_EXTI_IsEnabledFallingTrig_0_31(_pin_mask)
                                 : LL_EXTI_IsEnabledRisingTrig_0_31(_pin_mask);
 }
@@ -58,7 +61,7 @@ bool PushButton<HwAlarm, FALLING_TRIGGER>::enable() {
 template <typename HwAlarm, bool FALLING_TRIGGER>
 void PushButton<HwAlarm, FALLING_TRIGGER>::disable() {
   LL_EXTI_DisableIT_0_31(_pin_mask);
-  _hw_alarm.setAlarm(&_alarm_cb, 0);
+  _hw_alarm.setAlarm(_alarm, 0);
   disableTrig(LEADING);
   disableTrig(TRAILING);
   _state = OFF;
@@ -80,35 +83,43 @@ void PushButton<HwAlarm, FALLING_TRIGGER>::init(uint32_t preempt,
 }
 
 template <typename HwAlarm, bool FALLING_TRIGGER>
-void PushButton<HwAlarm, FALLING_TRIGGER>::handler() {
+RAMFUNC void PushButton<HwAlarm, FALLING_TRIGGER>::handler() {
   if (!LL_EXTI_ReadFlag_0_31(_pin_mask))
     return;
 
   if (isEnabledTrig(LEADING)) {
     /* Initialize and start new alarm, while not sensitive to edges
      * (the 2nd repetition is there just to be lengthened/stopped */
-    _hw_alarm.setAlarm(_reject, &_alarm_cb, 2);
+    if (_hw_alarm.setAlarm(_reject, _alarm, 2) < 0) {
+      /* no alarm to debounce with: stay armed, the next bounce retries */
+      LL_EXTI_ClearFlag_0_31(_pin_mask);
+      return;
+    }
     _state = REJECTING;
     disableTrig(LEADING);
   } else {
     /* Trailing edge has arrived before the alarm could fire */
-    _hw_alarm.setAlarm(&_alarm_cb, 0);
+    _hw_alarm.setAlarm(_alarm, 0);
     _state = DETECTED_SHORT;
     disableTrig(TRAILING);
   }
 }
 
 template <typename HwAlarm, bool FALLING_TRIGGER>
-void PushButton<HwAlarm, FALLING_TRIGGER>::alarm() {
+RAMFUNC void PushButton<HwAlarm, FALLING_TRIGGER>::alarm() {
   if (_state == REJECTING) {
     if (LL_GPIO_IsInputPinSet(_gpio, _pin_mask) != FALLING_TRIGGER) {
       /* actual edge (level did change) */
-      _hw_alarm.setAlarm(&_alarm_cb, 1, _long_press_residual);
+      if (_hw_alarm.setAlarm(_alarm, 1, _long_press_residual) < 0) {
+        /* the residual has already elapsed, still pressed (alarm dropped) */
+        _state = DETECTED_LONG;
+        return;
+      }
       _state = TRIGGERED;
       enableTrig(TRAILING);
     } else {
       /* spurious edge */
-      _hw_alarm.setAlarm(&_alarm_cb, 0);
+      _hw_alarm.setAlarm(_alarm, 0);
       _state = IDLE;
       enableTrig(LEADING);
     }
@@ -27,6 +27,19 @@ class SSegDisplay final : public UartTx<BUF_SIZE> {
   ssize_t write(OFile &ofile, const char *buf, size_t count,
                 off_t &pos) override;
   off_t llseek(OFile &ofile, off_t offset, int whence) override;
+  int ioctl(OFile &ofile, unsigned long request, void *arg) override;
+
+  /* Characters are encoded in place: no gathering, nor lending */
+  ssize_t writev(OFile &ofile, const iovec *iov, int iovcnt,
+                 off_t &pos) override {
+    return IFile::writev(ofile, iov, iovcnt, pos);
+  }
+  ssize_t acquire(OFile &ofile, char *&buf, size_t count) override {
+    return IFile::acquire(ofile, buf, count);
+  }
+  ssize_t commit(OFile &ofile, size_t count, off_t &pos) override {
+    return IFile::commit(ofile, count, pos);
+  }
 
  private:
   /**
@@ -216,7 +216,46 @@ off_t SSegDisplay<HwAlarm, BUF_SIZE, SEG_ON_HIGH>::llseek(OFile &ofile,
 }
 
 template <typename HwAlarm, size_t BUF_SIZE, bool SEG_ON_HIGH>
-void SSegDisplay<HwAlarm, BUF_SIZE, SEG_ON_HIGH>::alarm() {
+int SSegDisplay<HwAlarm, BUF_SIZE, SEG_ON_HIGH>::ioctl(OFile &ofile,
+                                                       unsigned long request,
+                                                       void *arg) {
+  switch (request) {
+    case SSEG_IOC_GSCROLL:
+      *static_cast<sseg_scroll *>(arg) = {
+          .delay_ms = static_cast<uint32_t>(_scroll_delay.count()),
+          .min_times = static_cast<uint32_t>(_min_scroll_times)};
+      return 0;
+
+    case SSEG_IOC_SSCROLL: {
+      const auto &scroll = *static_cast<const sseg_scroll *>(arg);
+      const auto delay = MilliSeconds{scroll.delay_ms};
+      if (!scroll.delay_ms || delay > _hw_alarm.maxDelay()) return -EINVAL;
+
+      _scroll_delay = delay;
+      _min_scroll_times = scroll.min_times;
+      if (_state != TRANSFER_SCROLL) return 0;
+
+      /* Retime the scroll task, restarting it if the new delay is over */
+      if (_nscroll >= _min_scroll_times) _scrolled = true;
+      if (_hw_alarm.setAlarm(&_alarm_cb, std::numeric_limits<uint32_t>::max(),
+                             _scroll_delay) < 0 &&
+          _hw_alarm.setAlarm(_scroll_delay, &_alarm_cb, 0) < 0)
+        return -EIO;
+      return 0;
+    }
+
+    case UART_IOC_SBAUD:
+      /* The scroll task starts transfers on its own */
+      if (_state == TRANSFER_SCROLL) return -EBUSY;
+      [[fallthrough]];
+
+    default:
+      return UartTx<BUF_SIZE>::ioctl(ofile, request, arg);
+  }
+}
+
+template <typename HwAlarm, size_t BUF_SIZE, bool SEG_ON_HIGH>
+RAMFUNC void SSegDisplay<HwAlarm, BUF_SIZE, SEG_ON_HIGH>::alarm() {
   if (this->isSending())
     exit(-3); /* scroll time too short? Something very weird is happening */
 
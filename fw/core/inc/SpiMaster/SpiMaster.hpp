@@ -36,10 +36,14 @@ class SpiMaster {
   std::optional<SlaveId> addSlave(const PinCfg &ssn, size_t nbits, bool cpol,
                                   bool cpha, ClockFreq max_fclk_hz);
   void removeSlave(SlaveId sid);
+  /* Takes effect from the next transfer */
+  bool setMaxClockFreq(SlaveId sid, ClockFreq max_fclk_hz);
+
+  using NanoSeconds = typename HwAlarm::NanoSeconds;
 
   std::optional<FrameT> txrx(SlaveId sid, FrameT txd,
-                             HwAlarmType::NanoSeconds t_pre = HwAlarmType::NanoSeconds{30},
-                             HwAlarmType::NanoSeconds t_post = HwAlarmType::NanoSeconds{30});
+                             NanoSeconds t_pre = NanoSeconds{30},
+                             NanoSeconds t_post = NanoSeconds{30});
 
  private:
   struct Slave {
@@ -50,9 +54,10 @@ class SpiMaster {
   };
   using SlaveTable = std::array<Slave, NMAX_SLAVES>;
 
-  constexpr static auto T_WEAK_PUPD = HwAlarmType::MicroSeconds{1};
+  constexpr static auto T_WEAK_PUPD = typename HwAlarm::MicroSeconds{1};
 
   bool _isValid(SlaveId sid) const;
+  std::optional<uint8_t> _brPsc(ClockFreq max_fclk_hz) const;
   void _applyCfg(SlaveId sid);
 
   SPI_TypeDef *_spi;
@@ -64,15 +64,8 @@ auto SpiMaster<HwAlarm, NMAX_SLAVES>::addSlave(const PinCfg &ssn, size_t nbits,
   if (nbits > std::numeric_limits<FrameT>::digits) return {};
 
   /* Compute baud rate settings, if a feasible solution exists */
-  auto fclk_hz = spi::getAPBClockFreq(_spi) >> 1;
-  uint8_t br_psc = 0;
-
-  constexpr auto br_psc_end = 8;
-  while (fclk_hz > max_fclk_hz && br_psc < br_psc_end) {
-    br_psc++;
-    fclk_hz >>= 1;
-  }
-  if (br_psc == br_psc_end) return {};
+  const auto br_psc = _brPsc(max_fclk_hz);
+  if (!br_psc) return {};
 
   /* Look for a free slave id */
   const auto it =
@@ -85,7 +78,7 @@ auto SpiMaster<HwAlarm, NMAX_SLAVES>::addSlave(const PinCfg &ssn, size_t nbits,
   it->nbits = nbits;
   it->cpol = cpol;
   it->cpha = cpha;
-  it->br_psc = br_psc;
+  it->br_psc = *br_psc;
 
   /* Initialize GPIO peripheral */
   gpio::enableClock(ssn.gpio);
@@ -103,10 +96,41 @@ auto SpiMaster<HwAlarm, NMAX_SLAVES>::addSlave(const PinCfg &ssn, size_t nbits,
   /* The id is the index into _slaves */
   const auto id = std::distance(_slaves.begin(), it);
 
-  PRINTD("Slave configured [fclk_hz = %u, id = %u]", fclk_hz, id);
+  PRINTD("Slave configured [fclk_hz = %u, id = %u]",
+         (spi::getAPBClockFreq(_spi) >> 1) >> *br_psc, id);
   return {id};
 }
 
+template <typename HwAlarm, size_t NMAX_SLAVES>
+bool SpiMaster<HwAlarm, NMAX_SLAVES>::setMaxClockFreq(SlaveId sid,
+                                                      ClockFreq max_fclk_hz) {
+  if (!_isValid(sid)) return false;
+
+  const auto br_psc = _brPsc(max_fclk_hz);
+  if (!br_psc) return false;
+
+  /* SPI transfers are blocking by design: applied by the next txrx() */
+  _slaves[sid].br_psc = *br_psc;
+  if (sid == _active_cfg) _active_cfg = _slaves.size();
+  return true;
+}
+
+template <typename HwAlarm, size_t NMAX_SLAVES>
+std::optional<uint8_t> SpiMaster<HwAlarm, NMAX_SLAVES>::_brPsc(
+    ClockFreq max_fclk_hz) const {
+  auto fclk_hz = spi::getAPBClockFreq(_spi) >> 1;
+  uint8_t br_psc = 0;
+
+  constexpr auto br_psc_end = 8;
+  while (fclk_hz > max_fclk_hz && br_psc < br_psc_end) {
+    br_psc++;
+    fclk_hz >>= 1;
+  }
+  if (br_psc == br_psc_end) return {};
+
+  return {br_psc};
+}
+
 template <typename HwAlarm, size_t NMAX_SLAVES>
 bool SpiMaster<HwAlarm, NMAX_SLAVES>::_isValid(SlaveId sid) const {
   return sid < _slaves.size() && _slaves[sid].ssn.gpio != nullptr;
@@ -153,8 +177,8 @@ void SpiMaster<HwAlarm, NMAX_SLAVES>::_applyCfg(SlaveId sid) {
 template <typename HwAlarm, size_t NMAX_SLAVES>
 std::optional<typename SpiMaster<HwAlarm, NMAX_SLAVES>::FrameT>
 SpiMaster<HwAlarm, NMAX_SLAVES>::txrx(SlaveId sid, FrameT txd,
-                                      HwAlarmType::NanoSeconds t_pre,
-                                      HwAlarmType::NanoSeconds t_post) {
+                                      NanoSeconds t_pre,
+                                      NanoSeconds t_post) {
   if (!_isValid(sid)) return {};
 
   const auto &slave = _slaves[sid];
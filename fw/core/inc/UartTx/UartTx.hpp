@@ -11,6 +11,7 @@
 
 #include "dma.h"
 #include "gpio.h"
+#include "ramfunc.h"
 #include "usart.h"
 
 #include <array>
@@ -19,18 +20,31 @@ template <size_t BUF_SIZE = 512>
 class UartTx : public IFile {
 public:
   UartTx(USART_TypeDef *usart, DMA_TypeDef *dma);
+  void handler();
 
   void setPin(GPIO_TypeDef *gpio, uint32_t pin, uint32_t af);
   void setFrame(uint32_t parity, uint32_t stop);
   void setBaudRate(uint32_t baud_rate, uint32_t over_sampling);
   void setDMATransfer(uint32_t stream, uint32_t ch,
                       uint32_t stream_priority = LL_DMA_PRIORITY_LOW);
+  /* Of the USART interrupt, which notifies the transfer completion */
+  void setIRQPriority(uint32_t preempt = 0, uint32_t sub = 0);
 
   int open(OFile &ofile) override;
   int close(OFile &ofile) override;
 
   off_t llseek(OFile &ofile, off_t offset, int whence) override;
   ssize_t write(OFile &ofile, const char *buf, size_t count, off_t &pos) override;
+  /* Writable once the transfer completes, which is notified */
+  __poll_t poll(OFile &ofile) override;
+  int ioctl(OFile &ofile, unsigned long request, void *arg) override;
+  /* Gathered into one DMA transfer */
+  ssize_t writev(OFile &ofile, const iovec *iov, int iovcnt,
+                 off_t &pos) override;
+
+  /* Lend the DMA buffer, so that data is copied there once */
+  ssize_t acquire(OFile &ofile, char *&buf, size_t count) override;
+  ssize_t commit(OFile &ofile, size_t count, off_t &pos) override;
 
 protected:
   using BufferType = std::array<uint8_t, BUF_SIZE>;
@@ -56,6 +70,10 @@ private:
   uint32_t _usart_over_sampling;
   uint32_t _dma_priority;
   uint32_t _dma_channel;
+  uint32_t _irq_preempt = 0;
+  uint32_t _irq_sub = 0;
+
+  size_t _lent = 0; /* Size of the outstanding loan of _buf */
 };
 
 #include "UartTx.tpp"
@@ -43,6 +43,12 @@ void UartTx<BUF_SIZE>::setDMATransfer(uint32_t stream, uint32_t ch,
   _dma_channel = ch;
 }
 
+template <size_t BUF_SIZE>
+void UartTx<BUF_SIZE>::setIRQPriority(uint32_t preempt, uint32_t sub) {
+  _irq_preempt = preempt;
+  _irq_sub = sub;
+}
+
 template <size_t BUF_SIZE>
 int UartTx<BUF_SIZE>::open(OFile &ofile) {
   if (ofile.mode != FWRITE)
@@ -91,15 +97,19 @@ int UartTx<BUF_SIZE>::open(OFile &ofile) {
   };
   LL_USART_Init(_usart, &usart_init);
 
-  /* Enable USART in DMA mode */
+  /* Enable USART in DMA mode, the completion interrupt is armed by poll() */
   LL_USART_EnableDMAReq_TX(_usart);
   LL_USART_Enable(_usart);
+  NVIC_SetPriority(usart::getIRQn(_usart),
+                   NVIC_EncodePriority(NVIC_GetPriorityGrouping(),
+                                       _irq_preempt, _irq_sub));
+  NVIC_EnableIRQ(usart::getIRQn(_usart));
 
   return 0;
 }
 
 template <size_t BUF_SIZE>
-bool UartTx<BUF_SIZE>::isSending() const {
+RAMFUNC bool UartTx<BUF_SIZE>::isSending() const {
   return !LL_USART_IsActiveFlag_TC(_usart);
 }
 
@@ -114,14 +124,32 @@ bool UartTx<BUF_SIZE>::wait(bool non_block) {
 }
 
 template <size_t BUF_SIZE>
-void UartTx<BUF_SIZE>::startDMATransfer(size_t count) const {
+RAMFUNC void UartTx<BUF_SIZE>::handler() {
+  if (LL_USART_IsEnabledIT_TC(_usart) && LL_USART_IsActiveFlag_TC(_usart)) {
+    /* The flag is left for wait(): one notification per arming */
+    LL_USART_DisableIT_TC(_usart);
+    notify();
+  }
+}
+
+template <size_t BUF_SIZE>
+__poll_t UartTx<BUF_SIZE>::poll([[maybe_unused]] OFile &ofile) {
+  if (!isSending()) return EPOLLOUT | EPOLLWRNORM;
+
+  /* Completed meanwhile? The interrupt is taken right away */
+  LL_USART_EnableIT_TC(_usart);
+  return 0;
+}
+
+template <size_t BUF_SIZE>
+RAMFUNC void UartTx<BUF_SIZE>::startDMATransfer(size_t count) const {
   LL_DMA_SetDataLength(_dma, _dma_stream, count);
   dma::clearFlagTC(_dma, _dma_stream);
   LL_DMA_EnableStream(_dma, _dma_stream);
 }
 
 template <size_t BUF_SIZE>
-void UartTx<BUF_SIZE>::startDMATransfer(
+RAMFUNC void UartTx<BUF_SIZE>::startDMATransfer(
     typename BufferType::const_iterator first, size_t count) const {
   LL_DMA_SetMemoryAddress(_dma, _dma_stream,
     reinterpret_cast<uintptr_t>(&*first));
@@ -137,6 +165,7 @@ int UartTx<BUF_SIZE>::close([[maybe_unused]] OFile &ofile) {
 
   /* Wait for ongoing transfer to complete */
   while (isSending());
+  NVIC_DisableIRQ(usart::getIRQn(_usart));
 
   /* De-init peripherals */
   LL_USART_DeInit(_usart);
@@ -166,6 +195,7 @@ ssize_t UartTx<BUF_SIZE>::write(OFile &ofile, const char *buf, size_t count,
     return -EAGAIN;
 
   /* Move data to local contiguous buffer */
+  _lent = 0;
   std::copy_n(buf, count, _buf.data());
   startDMATransfer(count);
 
@@ -173,4 +203,91 @@ ssize_t UartTx<BUF_SIZE>::write(OFile &ofile, const char *buf, size_t count,
   return count;
 }
 
+template <size_t BUF_SIZE>
+int UartTx<BUF_SIZE>::ioctl(OFile &ofile, unsigned long request, void *arg) {
+  switch (request) {
+  case UART_IOC_GBAUD:
+    *static_cast<uint32_t *>(arg) = _usart_baud_rate;
+    return 0;
+
+  case UART_IOC_SBAUD: {
+    const auto baud_rate = *static_cast<const uint32_t *>(arg);
+    if (!baud_rate)
+      return -EINVAL;
+
+    /* Retune between transfers, with the lent buffer still valid */
+    while (isSending()) {
+      if (ofile.flags & FNONBLOCK)
+        return -EAGAIN;
+    }
+
+    LL_USART_Disable(_usart);
+    LL_USART_SetBaudRate(_usart, usart::getAPBClockFreq(_usart),
+                         _usart_over_sampling, baud_rate);
+    LL_USART_Enable(_usart);
+
+    _usart_baud_rate = baud_rate;
+    return 0;
+  }
+
+  default:
+    return -ENOTTY;
+  }
+}
+
+template <size_t BUF_SIZE>
+ssize_t UartTx<BUF_SIZE>::writev(OFile &ofile, const iovec *iov, int iovcnt,
+                                 off_t &pos) {
+  if (std::all_of(iov, iov + iovcnt, [](auto &v) { return !v.iov_len; }))
+    return 0;
+
+  /* Wait for ongoing transfer to complete */
+  if (!wait(ofile.flags & FNONBLOCK))
+    return -EAGAIN;
+
+  /* Gather as many segments as they fit */
+  _lent = 0;
+  size_t count = 0;
+  for (auto i = 0; i < iovcnt && count < _buf.size(); ++i) {
+    const auto len = std::min(iov[i].iov_len, _buf.size() - count);
+    std::copy_n(static_cast<const uint8_t *>(iov[i].iov_base), len,
+                _buf.data() + count);
+    count += len;
+  }
+  startDMATransfer(count);
+
+  pos += count;
+  return count;
+}
+
+template <size_t BUF_SIZE>
+ssize_t UartTx<BUF_SIZE>::acquire(OFile &ofile, char *&buf, size_t count) {
+  /* The buffer is in use by the ongoing transfer. TC is left set, as the
+   * loan may never be committed */
+  while (isSending()) {
+    if (ofile.flags & FNONBLOCK)
+      return -EAGAIN;
+  }
+
+  _lent = std::min(count, _buf.size());
+  buf = reinterpret_cast<char *>(_buf.data());
+  return _lent;
+}
+
+template <size_t BUF_SIZE>
+ssize_t UartTx<BUF_SIZE>::commit([[maybe_unused]] OFile &ofile, size_t count,
+                                 off_t &pos) {
+  if (!_lent || count > _lent)
+    return -EINVAL;
+
+  _lent = 0;
+  if (count) {
+    wait();
+    startDMATransfer(count);
+  }
+
+  pos += count;
+  return count;
+}
+
 #endif // UARTTTX_TPP
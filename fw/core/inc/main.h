@@ -9,23 +9,50 @@
 
 #include "FileManager.hpp"
 #include "HwAlarm.hpp"
+#include "Keyboard.hpp"
+#include "LTC2308.hpp"
 #include "PushButton.hpp"
+#include "SSegDisplay.hpp"
+#include "SpiMaster.hpp"
+#include "UartTx.hpp"
 #include "BStepper.h"
 
 /*
- * Lazy construction of the file manager
- * (the function members are invoked as implementation of system calls)
+ * Lazy construction of resources requiring exception handling
+ * (the function members are invoked as implementation of interrupt handlers)
  */
 
-using FileManagerType = FileManager<4>;
-FileManagerType &File_Manager();
+/* CH1 to the display scrolling, CH2 multiplexes the virtual alarms */
+#define NMAX_VIRTUAL_ALARM 16
+using HwAlarmType = HwAlarm<TIM9_BASE, NMAX_VIRTUAL_ALARM>;
+HwAlarmType &Hw_Alarm();
+
+/* Timestamps, from any context */
+using SteadyClock = HwAlarmType::SteadyClock;
+
+/* Character devices, constructed lazily in main.cpp */
+using SpiMasterType = SpiMaster<HwAlarmType, 2>;
+using StLinkUartTxType = UartTx<>;
+using SSegDisplayType = SSegDisplay<HwAlarmType, 80, false>;
+using LTC2308Type = LTC2308<SpiMasterType, HwAlarmType>;
+using KeyboardType = Keyboard<SpiMasterType, HwAlarmType>;
+
+/* Their transfer-complete interrupts notify the FileManager */
+StLinkUartTxType &St_Link_Uart_Tx();
+SSegDisplayType &SSeg_Display();
 
 /*
- * Lazy construction of resources requiring exception handling
- * (the function members are invoked as implementation of interrupt handlers)
+ * Lazy construction of the file manager
+ * (the function members are invoked as implementation of system calls,
+ * dispatched statically to the drivers)
  */
-using HwAlarmType = HwAlarm<TIM9_BASE>;
-HwAlarmType &Hw_Alarm();
+
+using FileManagerType = FileManager<
+    HwAlarmType, NodeDrivers<Node<"st_link_uart_tx", StLinkUartTxType>,
+                             Node<"sseg_display", SSegDisplayType>,
+                             Node<"ltc_2308", LTC2308Type>,
+                             Node<"kbd", KeyboardType>>>;
+FileManagerType &File_Manager();
 
 using PushButtonType = PushButton<HwAlarmType>;
 PushButtonType &Push_Button();
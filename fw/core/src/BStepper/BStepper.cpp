@@ -7,6 +7,7 @@
 #include "BStepper.h"
 
 #include <debug.h>
+#include <ramfunc.h>
 
 #include <numeric>
 
@@ -99,6 +100,8 @@ void BStepper::enable() const { _gpio->BSRR = _pins.en; }
 
 void BStepper::disable() const { _gpio->BSRR = _pins.en << 16; }
 
+bool BStepper::isBusy() const { return LL_TIM_IsEnabledCounter(_tim); }
+
 bool BStepper::calcTimeBase(SpeedType milli_rev_per_minute, StepType t,
                             TimRegType &psc, TimRegType &arr) const {
   constexpr auto psc_width = std::numeric_limits<TimRegType>::digits;
@@ -145,45 +148,72 @@ bool BStepper::calcTimeBase(SpeedType milli_rev_per_minute, StepType t,
   return true;
 }
 
+bool BStepper::compile(StepCountType steps, SpeedType milli_rev_per_minute,
+                       Direction d, Plan &p, StepType t) const {
+  constexpr auto rcr_width = std::numeric_limits<TimRCRType>::digits;
+  constexpr auto max_hw_reps = static_cast<StepCountType>(1U << rcr_width);
+
+  p.steps = 0;
+  if (!steps) return false;
+
+  /* Get TIM configuration parameters */
+  if (!calcTimeBase(milli_rev_per_minute, t, p.psc, p.arr)) return false;
+
+  /* If the number of steps fits the repetition counter, the counter is
+   * forced to stop at the UEV. Otherwise, the repetition counter is set to
+   * its maximum value, and the UEVs are counted in software */
+  if (steps <= max_hw_reps) {
+    p.sw_reps = 0;
+    p.hw_reps = 0;
+    p.rcr = steps - 1;
+  } else {
+    p.sw_reps = steps >> rcr_width;
+    p.hw_reps = steps & (max_hw_reps - 1); /* [0, 256) */
+    p.rcr = max_hw_reps - 1;
+  }
+
+  p.steps = steps;
+  p.direction = d;
+  p.type = t;
+  return true;
+}
+
 bool BStepper::rotate(StepCountType steps, SpeedType milli_rev_per_minute,
                       Direction d, bool block, StepType t) {
-  if (!steps) return false;
   if (LL_TIM_IsEnabledCounter(_tim)) return false;
 
-  /* Get TIM configuration parameters */
-  constexpr auto rcr_width = std::numeric_limits<TimRCRType>::digits;
-  constexpr auto max_hw_reps = static_cast<StepCountType>(1U << rcr_width);
+  Plan p;
+  if (!compile(steps, milli_rev_per_minute, d, p, t)) return false;
+
+  return rotate(p, block);
+}
 
-  TimRegType psc, arr;
-  if (!calcTimeBase(milli_rev_per_minute, t, psc, arr)) return false;
+bool BStepper::rotate(const Plan &p, bool block) {
+  if (!p.steps) return false;
+  if (LL_TIM_IsEnabledCounter(_tim)) return false;
 
   /* Reset DMA transfer */
   LL_DMA_DisableStream(_dma, _dma_stream);
 
   /* Set reload period to one step time */
-  LL_TIM_SetPrescaler(_tim, psc);
-  LL_TIM_SetAutoReload(_tim, arr);
+  LL_TIM_SetPrescaler(_tim, p.psc);
+  LL_TIM_SetAutoReload(_tim, p.arr);
+
+  /* The repetition counter is preloaded: load and force update now */
+  LL_TIM_SetRepetitionCounter(_tim, p.rcr);
+  LL_TIM_GenerateEvent_UPDATE(_tim);
 
   /* If the number of steps fits the repetition counter,
    * force the counter to stop at the UEV */
-  if (steps <= max_hw_reps) {
-    /* The repetition counter is preloaded: load and force update now */
-    LL_TIM_SetRepetitionCounter(_tim, steps - 1);
-    LL_TIM_GenerateEvent_UPDATE(_tim);
-
+  if (!p.sw_reps) {
     LL_TIM_SetOnePulseMode(_tim, LL_TIM_ONEPULSEMODE_SINGLE);
   }
-  /* Otherwise, set the repetition counter to its maximum value, and
-   * count the UEVs in software, allowing the counter to reload at the UEV.
-   * Following the last software-counted repetition, the behavior should be
-   * the same as the case when the steps fit the repetition counter */
+  /* Otherwise, allow the counter to reload at the UEV. Following the last
+   * software-counted repetition, the behavior should be the same as the case
+   * when the steps fit the repetition counter */
   else {
-    _sw_reps = steps >> rcr_width;
-    _hw_reps = steps & (max_hw_reps - 1); /* [0, 256) */
-
-    /* The repetition counter is preloaded: load and force update now */
-    LL_TIM_SetRepetitionCounter(_tim, max_hw_reps - 1);
-    LL_TIM_GenerateEvent_UPDATE(_tim);
+    _sw_reps = p.sw_reps;
+    _hw_reps = p.hw_reps;
 
     /* If there is only one software repetition, the next UEV
      * starts the hardware-counted repetitions. The RCR value
@@ -202,13 +232,14 @@ bool BStepper::rotate(StepCountType steps, SpeedType milli_rev_per_minute,
   LL_TIM_DisableDMAReq_CC1(_tim);
 
   /* Configure DMA stream */
-  LL_DMA_SetMemoryAddress(
-      _dma, _dma_stream, reinterpret_cast<uintptr_t>(_tr.advance(steps, d, t)));
-  LL_DMA_SetDataLength(_dma, _dma_stream, Translator::getSequenceLen(t));
+  LL_DMA_SetMemoryAddress(_dma, _dma_stream,
+                          reinterpret_cast<uintptr_t>(
+                              _tr.advance(p.steps, p.direction, p.type)));
+  LL_DMA_SetDataLength(_dma, _dma_stream, Translator::getSequenceLen(p.type));
   LL_DMA_EnableStream(_dma, _dma_stream);
 
   /* Fire DMA request just before reloading */
-  LL_TIM_OC_SetCompareCH1(_tim, arr);
+  LL_TIM_OC_SetCompareCH1(_tim, p.arr);
   LL_TIM_EnableDMAReq_CC1(_tim);
 
   /* Start rotation */
@@ -217,7 +248,7 @@ bool BStepper::rotate(StepCountType steps, SpeedType milli_rev_per_minute,
   return true;
 }
 
-void BStepper::handler() {
+RAMFUNC void BStepper::handler() {
   if (LL_TIM_IsActiveFlag_UPDATE(_tim)) {
     LL_TIM_ClearFlag_UPDATE(_tim);
 
@@ -0,0 +1,22 @@
+/**
+ * @file     dwt.cpp
+ * @author   Fabio Scatozza <s315216@studenti.polito.it>
+ * @date     18.10.2026
+ */
+
+#include "dwt.h"
+
+namespace dwt {
+
+void init() {
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CYCCNT = 0;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+uint32_t toMicros(uint32_t start) {
+  return static_cast<uint64_t>(getCycles() - start) * 1'000'000U /
+         SystemCoreClock;
+}
+
+} // namespace dwt
@@ -5,10 +5,11 @@
  */
 
 #include "flash.h"
+#include "ramfunc.h"
 
 namespace flash {
 
-bool isBusy() { return FLASH->SR & FLASH_SR_BSY; }
+RAMFUNC bool isBusy() { return FLASH->SR & FLASH_SR_BSY; }
 
 bool isActive(const Flag &f, bool clear) {
   const bool tmp = FLASH->SR & f;
@@ -50,11 +51,33 @@ void setOperation(const Op &op) {
   clearOperation();
   FLASH->CR |= static_cast<uint32_t>(op);
 }
-void startErase() {
+/* Spin in RAM: returning to flash-resident code would stall the core */
+RAMFUNC void startErase() {
   FLASH->CR |= FLASH_CR_STRT;
+
+  while (isBusy()) {
+  }
 }
 void clearOperation() {
   FLASH->CR &= ~(FLASH_CR_MER | FLASH_CR_SER | FLASH_CR_PG);
 }
 
+RAMFUNC void programAt(uintptr_t addr, uint32_t data, size_t size) {
+  /* An access size not matching PSIZE raises PGPERR */
+  switch (size) {
+  case 1:
+    *reinterpret_cast<volatile uint8_t *>(addr) = data;
+    break;
+  case 2:
+    *reinterpret_cast<volatile uint16_t *>(addr) = data;
+    break;
+  default:
+    *reinterpret_cast<volatile uint32_t *>(addr) = data;
+    break;
+  }
+
+  while (isBusy()) {
+  }
+}
+
 } // namespace flash
\ No newline at end of file
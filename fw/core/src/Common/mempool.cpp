@@ -0,0 +1,57 @@
+/**
+ * @file     mempool.cpp
+ * @author   Fabio Scatozza <s315216@studenti.polito.it>
+ * @date     18.10.2026
+ */
+
+#include "mempool.h"
+
+#include <cstdint>
+
+/* Symbols from linker script */
+extern unsigned char __pool_start[];
+extern unsigned char __pool_end[];
+extern unsigned char end[];
+extern unsigned char __heap_limit[];
+extern unsigned char __stack_limit[];
+extern unsigned char __stack_base[];
+
+namespace mempool {
+
+static constexpr uint32_t PAINT = 0xDEADBEEF;
+
+static unsigned char *heap_end = end;
+static unsigned char *heap_max = end;
+
+void paintStack() {
+  /* Up to a margin below the caller frame */
+  const auto top = static_cast<unsigned char *>(__builtin_frame_address(0));
+  for (auto p = reinterpret_cast<uint32_t *>(__stack_limit);
+       p < reinterpret_cast<uint32_t *>(top - 64); ++p)
+    *p = PAINT;
+}
+
+void *sbrk(ptrdiff_t incr) {
+  if (heap_end + incr > __heap_limit || heap_end + incr < end) return nullptr;
+
+  const auto prev = heap_end;
+  heap_end += incr;
+  if (heap_end > heap_max) heap_max = heap_end;
+  return prev;
+}
+
+size_t poolSize() { return __pool_end - __pool_start; }
+size_t heapSize() { return __heap_limit - end; }
+size_t stackSize() { return __stack_base - __stack_limit; }
+
+size_t heapHighWater() { return heap_max - end; }
+
+size_t stackHighWater() {
+  auto p = reinterpret_cast<const uint32_t *>(__stack_limit);
+  while (p < reinterpret_cast<const uint32_t *>(__stack_base) && *p == PAINT)
+    ++p;
+
+  return __stack_base - reinterpret_cast<const unsigned char *>(p);
+}
+
+} // namespace mempool
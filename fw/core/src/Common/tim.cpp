@@ -5,38 +5,11 @@
  */
 
 #include "tim.h"
+#include "ramfunc.h"
 #include "stm32f4xx_ll_rcc.h"
 
 #define CCR_OFFSET(ch)
 
-static constexpr void (*enable_it_cc[])(TIM_TypeDef *) {
-  LL_TIM_EnableIT_CC1,
-  LL_TIM_EnableIT_CC2,
-  LL_TIM_EnableIT_CC3,
-  LL_TIM_EnableIT_CC4,
-};
-
-static constexpr void (*disable_it_cc[])(TIM_TypeDef *) {
-  LL_TIM_DisableIT_CC1,
-  LL_TIM_DisableIT_CC2,
-  LL_TIM_DisableIT_CC3,
-  LL_TIM_DisableIT_CC4,
-};
-
-static constexpr void (*clear_flag_cc[])(TIM_TypeDef *) {
-  LL_TIM_ClearFlag_CC1,
-  LL_TIM_ClearFlag_CC2,
-  LL_TIM_ClearFlag_CC3,
-  LL_TIM_ClearFlag_CC4,
-};
-
-static constexpr uint32_t (*is_active_flag_cc[])(const TIM_TypeDef *) {
-  LL_TIM_IsActiveFlag_CC1,
-  LL_TIM_IsActiveFlag_CC2,
-  LL_TIM_IsActiveFlag_CC3,
-  LL_TIM_IsActiveFlag_CC4,
-};
-
 namespace tim {
 
 IRQn_Type getIRQn(const TIM_TypeDef *tim, IRQAdvancedTIM irqt) {
@@ -92,20 +65,24 @@ void enableClock(const TIM_TypeDef *tim) {
   enableClock(reinterpret_cast<uintptr_t>(tim));
 }
 
-void enableItCC(TIM_TypeDef *tim, size_t ch) {
-  enable_it_cc[ch](tim);
+/*
+ * Called from interrupt handlers: the CCxIE and CCxIF bits are contiguous, so
+ * no table of LL functions is needed (it would be read from the flash)
+ */
+RAMFUNC void enableItCC(TIM_TypeDef *tim, size_t ch) {
+  SET_BIT(tim->DIER, TIM_DIER_CC1IE << ch);
 }
 
-void disableItCC(TIM_TypeDef *tim, size_t ch) {
-  disable_it_cc[ch](tim);
+RAMFUNC void disableItCC(TIM_TypeDef *tim, size_t ch) {
+  CLEAR_BIT(tim->DIER, TIM_DIER_CC1IE << ch);
 }
 
-void clearFlagCC(TIM_TypeDef *tim, size_t ch) {
-  clear_flag_cc[ch](tim);
+RAMFUNC void clearFlagCC(TIM_TypeDef *tim, size_t ch) {
+  WRITE_REG(tim->SR, ~(TIM_SR_CC1IF << ch));
 }
 
-bool isActiveFlagCC(const TIM_TypeDef *tim, size_t ch) {
-  return is_active_flag_cc[ch](tim);
+RAMFUNC bool isActiveFlagCC(const TIM_TypeDef *tim, size_t ch) {
+  return READ_BIT(tim->SR, TIM_SR_CC1IF << ch) == (TIM_SR_CC1IF << ch);
 }
 
 }
\ No newline at end of file
@@ -18,4 +18,32 @@ void enableClock(USART_TypeDef *usart) {
     LL_APB2_GRP1_EnableClock(LL_APB2_GRP1_PERIPH_USART6);
 }
 
+uint32_t getAPBClockFreq(const USART_TypeDef *usart,
+                         LL_RCC_ClocksTypeDef *clocks) {
+  LL_RCC_ClocksTypeDef this_clocks;
+  uint32_t fclk = 0;
+
+  if (clocks)
+    this_clocks = *clocks;
+  else
+    LL_RCC_GetSystemClocksFreq(&this_clocks);
+
+  if (usart == USART1)
+    fclk = this_clocks.PCLK2_Frequency;
+  else if (usart == USART2)
+    fclk = this_clocks.PCLK1_Frequency;
+  else if (usart == USART6)
+    fclk = this_clocks.PCLK2_Frequency;
+
+  return fclk;
+}
+
+IRQn_Type getIRQn(const USART_TypeDef *usart) {
+  if (usart == USART1)
+    return USART1_IRQn;
+  if (usart == USART2)
+    return USART2_IRQn;
+  return USART6_IRQn;
+}
+
 }
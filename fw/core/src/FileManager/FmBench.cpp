@@ -0,0 +1,97 @@
+/**
+ * @file     FmBench.cpp
+ * @author   Fabio Scatozza <s315216@studenti.polito.it>
+ * @date     18.10.2026
+ */
+
+#include "FmBench.h"
+
+#ifdef FM_BENCH
+
+#include "FileManager.hpp"
+#include "debug.h"
+#include "dwt.h"
+#include "main.h"
+
+namespace {
+
+constexpr auto NITER = 1000U;
+
+/* Driver paths as short as Keyboard::read() returning _peek */
+class NullFile : public IFile {
+ public:
+  int open([[maybe_unused]] OFile &ofile) override { return 0; }
+  int close([[maybe_unused]] OFile &ofile) override { return 0; }
+
+  off_t llseek([[maybe_unused]] OFile &ofile, off_t offset,
+               [[maybe_unused]] int whence) override {
+    return offset;
+  }
+
+  ssize_t read([[maybe_unused]] OFile &ofile, char *buf, size_t count,
+               [[maybe_unused]] off_t &pos) override {
+    if (!count) return 0;
+    *buf = _c;
+    return 1;
+  }
+
+  ssize_t write([[maybe_unused]] OFile &ofile, const char *buf, size_t count,
+                [[maybe_unused]] off_t &pos) override {
+    if (count) _c = *buf;
+    return count;
+  }
+
+  __poll_t poll([[maybe_unused]] OFile &ofile) override {
+    return EPOLLIN | EPOLLOUT;
+  }
+
+ private:
+  char _c = 0;
+};
+
+/* Average cycles of a call, loop overhead included */
+template <typename Fn>
+uint32_t measure(Fn &&fn) {
+  const auto start = dwt::getCycles();
+  for (auto i = 0U; i < NITER; ++i) fn();
+  return (dwt::getCycles() - start) / NITER;
+}
+
+template <typename FM>
+void run(const char *dispatch, FM &fm) {
+  const auto fd = fm.template open<"null">(O_RDWR);
+  if (fd < 0) return;
+
+  char c = 'x';
+  const auto wr = measure([&] { fm.write(fd, &c, 1); });
+  const auto rd = measure([&] { fm.read(fd, &c, 1); });
+  const auto ls = measure([&] { fm.lseek(fd, 0, SEEK_SET); });
+
+  const auto sl = measure([&] {
+    timeval tv{};
+    fd_set rfds{};
+    FD_SET(fd, &rfds);
+    fm.select(fd + 1, &rfds, nullptr, nullptr, &tv);
+  });
+
+  PRINTD("%s: write %" PRIu32 ", read %" PRIu32 ", lseek %" PRIu32
+         ", select %" PRIu32 " cycles",
+         dispatch, wr, rd, ls, sl);
+  fm.close(fd);
+}
+
+}  // namespace
+
+void fmBench() {
+  static NullFile vt_null, st_null;
+
+  static FileManager<HwAlarmType, NodeNames<"null">> vt_fm{
+      Hw_Alarm(), Node<"null">{vt_null}};
+  static FileManager<HwAlarmType, NodeDrivers<Node<"null", NullFile>>> st_fm{
+      Hw_Alarm(), Node<"null", NullFile>{st_null}};
+
+  run("vtable", vt_fm);
+  run("static", st_fm);
+}
+
+#endif  // FM_BENCH
@@ -0,0 +1,65 @@
+/**
+ * @file     FmtBench.cpp
+ * @author   Fabio Scatozza <s315216@studenti.polito.it>
+ * @date     18.10.2026
+ */
+
+#include "FmtBench.h"
+
+#ifdef FMT_BENCH
+
+#include <cstdio>
+
+#include "Format.hpp"
+#include "debug.h"
+#include "dwt.h"
+
+namespace {
+
+constexpr auto NITER = 100U;
+
+/* Defeats constant propagation into the formatting code */
+volatile unsigned Idx = 7;
+volatile int Milli_Rpm = 123456;
+volatile int Angle_X10 = -905;
+
+/* Average cycles of a call, loop overhead included */
+template <typename Fn>
+uint32_t measure(Fn &&fn) {
+  const auto start = dwt::getCycles();
+  for (auto i = 0U; i < NITER; ++i) fn();
+  return (dwt::getCycles() - start) / NITER;
+}
+
+}  // namespace
+
+void fmtBench() {
+  char buf[128];
+
+  /* Display line, as printed by main() */
+  const auto sseg_libc = measure([&] {
+    snprintf(buf, sizeof(buf), "[%u] %u.%03u %d.%01d\n", Idx, Milli_Rpm / 1000,
+             Milli_Rpm % 1000, Angle_X10 / 10, Angle_X10 % 10);
+  });
+  const auto sseg_fmt = measure([&] {
+    fmt::format<"[%u] %u %d\n">(buf, sizeof(buf), Idx,
+                                fmt::fixed<3>(Milli_Rpm),
+                                fmt::fixed<1>(Angle_X10));
+  });
+
+  /* Log line, with the prefix of PRINTD */
+  const auto log_libc = measure([&] {
+    snprintf(buf, sizeof(buf), "%s: line %u:\r\n%s:\r\n\tADC: %u.%03u mV\r\n\n",
+             __FILE__, __LINE__, __func__, Milli_Rpm / 1000, Milli_Rpm % 1000);
+  });
+  const auto log_fmt = measure([&] {
+    fmt::format<"%s: line %u:\r\n%s:\r\n\tADC: %u mV\r\n\n">(
+        buf, sizeof(buf), __FILE__, __LINE__, __func__,
+        fmt::fixed<3>(Milli_Rpm));
+  });
+
+  PRINTD("display: snprintf %u, fmt %u cycles", sseg_libc, sseg_fmt);
+  PRINTD("log: snprintf %u, fmt %u cycles", log_libc, log_fmt);
+}
+
+#endif  // FMT_BENCH
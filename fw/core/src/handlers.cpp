@@ -5,15 +5,42 @@
  */
 
 #include "main.h"
+#include "ramfunc.h"
 
-void TIM1_BRK_TIM9_IRQHandler() {
+/* Served while the flash is programmed or erased */
+RAMFUNC void TIM1_BRK_TIM9_IRQHandler() {
   Hw_Alarm().handler();
 }
 
-void TIM1_UP_TIM10_IRQHandler() {
+RAMFUNC void TIM1_UP_TIM10_IRQHandler() {
   Stepper().handler();
 }
 
-void EXTI15_10_IRQHandler() {
+RAMFUNC void EXTI15_10_IRQHandler() {
   Push_Button().handler();
 }
+
+RAMFUNC void USART1_IRQHandler() {
+  SSeg_Display().handler();
+}
+
+RAMFUNC void USART2_IRQHandler() {
+  St_Link_Uart_Tx().handler();
+}
+
+/*
+ * Out-of-line instances of the template members above, even if inlined here:
+ * the linker script checks that they were placed in .ramfunc (GCC < 14 ignores
+ * RAMFUNC on template members, see PR70435)
+ */
+template void HwAlarmType::handler();
+template void PushButtonType::handler();
+template void PushButtonType::alarm();
+template void PushButtonType::CallbackType::operator()() const;
+template void AlarmHeap<NMAX_VIRTUAL_ALARM>::remove(AlarmNode &node);
+template void StLinkUartTxType::handler();
+/* The USART1 handler and the DMA start of the scroll alarm are the base's */
+template void SSegDisplayType::UartTx::handler();
+template void SSegDisplayType::alarm();
+template void SSegDisplayType::UartTx::startDMATransfer(
+    SSegDisplayType::BufferType::const_iterator first, size_t count) const;
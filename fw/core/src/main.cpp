@@ -6,60 +6,64 @@
 
 #include "main.h"
 
+#include "FmBench.h"
+#include "Format.hpp"
+#include "FmtBench.h"
 #include "Keyboard.hpp"
 #include "LTC2308.hpp"
+#include "MotionConfig.hpp"
 #include "MotionPattern.hpp"
+#include "MotionVM.hpp"
 #include "SSegDisplay.hpp"
 #include "SpiMaster.hpp"
 #include "UartTx.hpp"
 #include "ctre.hpp"
 #include "debug.h"
+#include "dwt.h"
 #include "gpio.h"
+#include "mempool.h"
+#include "ramfunc.h"
 #include "stm32f4xx_ll_bus.h"
 #include "stm32f4xx_ll_pwr.h"
 #include "stm32f4xx_ll_rcc.h"
 #include "stm32f4xx_ll_system.h"
 #include "stm32f4xx_ll_utils.h"
-#include "utils.hpp"
+#include "tim.h"
+
+#include <algorithm>
 
 using namespace std::chrono_literals;
 
 static constexpr auto HCLK_FREQUENCY_HZ = 64000000;
-static constexpr auto NMAX_MOTION_SEGMENTS = 8;
-static constexpr auto STEPS_PER_REV = 200;
 static constexpr auto NDISPLAYS_SSEG = 6;
 static constexpr auto MIN_SCROLL_TIMES = 2;
 static constexpr auto SCROLL_DELAY = 500ms;
 static constexpr auto DISPLAY_HOLD = 2s;
+static constexpr auto SELECT_TIMEOUT = 50ms; /* Button latency, while idle */
 static constexpr auto SPI_FCLK_MAX_Hz = 8e6;
 static constexpr auto IBUF_SIZE = 80;
+static constexpr auto STDOUT_BUF_SIZE = 128;
+static constexpr auto KBD_BUF_SIZE = 16;
+static constexpr auto DISPLAY_BUF_SIZE = 80;
 static constexpr ctll::fixed_string RX_PATTERN =
     R"((?:\+|-)?([0-9]{1,3})(?:\.([0-9]))?\n)";
-static constexpr auto DEGREES_360 = 360;
-static constexpr auto ADC_FULLSCALE_mV = 4096;
-static constexpr auto MILLI_RPM_MIN = 2'500;
-static constexpr auto MILLI_RPM_SOL = 25'000;
-static constexpr auto MILLI_RPM_MAX = 400'000;
 
 /* Lazy construction of local resource managers */
-using SpiMasterType = SpiMaster<HwAlarmType, 2>;
 static SpiMasterType &Spi_Master();
 
 /* Lazy construction of character devices */
-using StLinkUartTxType = UartTx<>;
-static StLinkUartTxType &St_Link_Uart_Tx();
-
-using SSegDisplayType = SSegDisplay<HwAlarmType, 80, false>;
-static SSegDisplayType &SSeg_Display();
-
-using LTC2308Type = LTC2308<SpiMasterType, HwAlarmType>;
 static LTC2308Type &Ltc_2308();
-
-using KeyboardType = Keyboard<SpiMasterType, HwAlarmType>;
 static KeyboardType &Kbd();
 
 /* Platform configuration */
 static void systemClockConfig();
+static void printMemUsage();
+
+/* Stream buffers, from the static pool rather than the heap */
+POOL static char Stdout_Buf[STDOUT_BUF_SIZE];
+POOL static char Adc_Buf[sizeof(uint16_t)];
+POOL static char Kbd_Buf[KBD_BUF_SIZE];
+POOL static char Display_Buf[DISPLAY_BUF_SIZE];
 
 [[noreturn]] int main() {
   /* Configure system clock tree */
@@ -74,31 +78,45 @@ static void systemClockConfig();
   St_Link_Uart_Tx().setFrame(LL_USART_PARITY_NONE, LL_USART_STOPBITS_1);
   St_Link_Uart_Tx().setBaudRate(115200, LL_USART_OVERSAMPLING_16);
   St_Link_Uart_Tx().setDMATransfer(LL_DMA_STREAM_6, LL_DMA_CHANNEL_4);
-  File_Manager().stdStreamAttach(STDERR_FILENO, "st_link_uart_tx");
-  File_Manager().stdStreamAttach(STDOUT_FILENO, "st_link_uart_tx");
+  St_Link_Uart_Tx().setIRQPriority(1); /* Completion tolerates latency */
+  File_Manager().stdStreamAttach<"st_link_uart_tx">(STDERR_FILENO);
+  File_Manager().stdStreamAttach<"st_link_uart_tx">(STDOUT_FILENO);
+  setvbuf(stdout, Stdout_Buf, _IOLBF, sizeof(Stdout_Buf));
   PRINTD("Logging facility running ...");
 
   /* Hardware timer: ticks @ 64 kHz, (2 channels, 16 bit) */
   Hw_Alarm().init(15625ns);
 
-  /* Initialize motion pattern */
-  using MotionPatternType = MotionPattern<NMAX_MOTION_SEGMENTS>;
-  MotionPatternType mp(flash::Sector::S7);
-  PRINTD("MotionPatter cache: %u/%u", mp.size(), mp.max_size());
-
   /* Initialize stepper motor */
   Stepper().setPins({.en = EN_Pin,
                      .ph = {.a = {.pos = AP_Pin, .neg = AN_Pin},
                             .b = {.pos = BP_Pin, .neg = BN_Pin}}});
   Stepper().setDMATransfer(LL_DMA_STREAM_1, LL_DMA_CHANNEL_6);
-  Stepper().setResolution(STEPS_PER_REV);
+  Stepper().setResolution(motion::STEPS_PER_REV);
   Stepper().init();
 
+  /* Initialize motion pattern (compiled for the configured stepper) */
+  using MotionPatternType = MotionPattern<motion::NMAX_SEGMENTS, true>;
+  using MotionVMType = MotionVM<MotionPatternType>;
+  dwt::init();
+#ifdef FM_BENCH
+  fmBench();
+#endif
+#ifdef FMT_BENCH
+  fmtBench();
+#endif
+  const auto mp_boot_start = dwt::getCycles();
+  MotionPatternType mp(flash::Sector::S7, Stepper());
+  const auto mp_boot_us = dwt::toMicros(mp_boot_start);
+  PRINTD("MotionPatter cache: %u/%u (loaded in %u us)", mp.size(),
+         mp.max_size(), mp_boot_us);
+
   /* Initialize 7-Segment display over USART1 */
   SSeg_Display().setPin(SSEG_URX_GPIO_Port, SSEG_URX_Pin, SSEG_URX_Alternate);
   SSeg_Display().setFrame(LL_USART_PARITY_EVEN, LL_USART_STOPBITS_1);
   SSeg_Display().setBaudRate(115200, LL_USART_OVERSAMPLING_16);
   SSeg_Display().setDMATransfer(LL_DMA_STREAM_7, LL_DMA_CHANNEL_4);
+  SSeg_Display().setIRQPriority(1);
   SSeg_Display().setDisplay(NDISPLAYS_SSEG, MIN_SCROLL_TIMES, SCROLL_DELAY);
 
   /* Initialize SPI master over SPI3 */
@@ -131,17 +149,17 @@ static void systemClockConfig();
   /* Connect ADC (binary buffered mode, block matching one 12 bit sample) */
   const auto adc = fopen("ltc_2308", "rb");
   if (!adc) exit(-1);
-  setvbuf(adc, nullptr, _IOFBF, sizeof(uint16_t));
+  setvbuf(adc, Adc_Buf, _IOFBF, sizeof(Adc_Buf));
 
   /* Connect keyboard (line buffered) */
   const auto kbd = fopen("kbd", "r");
   if (!kbd) exit(-1);
-  setlinebuf(kbd);
+  setvbuf(kbd, Kbd_Buf, _IOLBF, sizeof(Kbd_Buf));
 
   /* Connect display (line buffered mode) */
   const auto display_out = fopen("sseg_display", "w");
   if (!display_out) exit(-1);
-  setlinebuf(display_out);
+  setvbuf(display_out, Display_Buf, _IOLBF, sizeof(Display_Buf));
 
   /*
    * The underlying file descriptor will be added to the set of those
@@ -152,64 +170,122 @@ static void systemClockConfig();
   if (kbd_fd < 0) exit(-1);
 
   /* Sign of life */
-  fprintf(display_out, "Run...\n");
+  fmt::print<"Run...\n">(display_out);
   Stepper().enable();
-  Stepper().rotate(STEPS_PER_REV, MILLI_RPM_SOL, BStepper::CCW, true);
-  Stepper().rotate(STEPS_PER_REV, MILLI_RPM_SOL, BStepper::CW, true);
+  Stepper().rotate(motion::STEPS_PER_REV, motion::MILLI_RPM_SOL,
+                   BStepper::CCW, true);
+  Stepper().rotate(motion::STEPS_PER_REV, motion::MILLI_RPM_SOL, BStepper::CW,
+                   true);
   Stepper().disable();
   PRINTD("Sign of life completed");
+  printMemUsage();
 
   /* Notify idle state */
-  fprintf(display_out, "\rIdle\n");
+  fmt::print<"\rIdle\n">(display_out);
   PRINTD("Starting in IDLE state");
 
   while (true) {
     if (Push_Button().longPress()) {
-      fprintf(display_out, "\rClear\n");
+      fmt::print<"\rClear\n">(display_out);
       Hw_Alarm().delay(DISPLAY_HOLD);
 
       mp.clear();
       PRINTD("MotionPatter cache cleared: %u/%u", mp.size(), mp.max_size());
+      PRINTD("Worst alarm latency since last clear: %u ns",
+             static_cast<uint32_t>(Hw_Alarm().maxLatency(true).count()));
+      printMemUsage();
 
-      fprintf(display_out, "\rIdle\n");
+      fmt::print<"\rIdle\n">(display_out);
       PRINTD("Back to IDLE state");
     }
 
     if (Push_Button().shortPress()) {
       if (!mp.empty()) {
-        fprintf(display_out, "\rPlay\n");
+        fmt::print<"\rPlay\n">(display_out);
         Hw_Alarm().delay(DISPLAY_HOLD);
         PRINTD("Starting movement pattern execution");
 
+        /* Control instructions are resolved while the motor turns, the
+         * segments are compiled from flash as they are reached. The VM cost
+         * per instruction is measured against the shortest step period */
+        MotionVMType vm(mp);
+        MotionVMType::Action action{};
+        uint32_t t0;
+        uint32_t vm_cycles = 0;
+        uint32_t vm_max_cycles = 0;
+        uint64_t step_cycles = UINT64_MAX;
+        const auto psc_clk_hz = tim::getPscClock(TIM1);
+
+        const auto advance = [&] {
+          const auto start = dwt::getCycles();
+          action = vm.next();
+          t0 = dwt::getCycles();
+
+          const auto elapsed = t0 - start;
+          vm_max_cycles = std::max(vm_max_cycles, elapsed);
+          if (vm.fetched())
+            vm_cycles = std::max<uint32_t>(vm_cycles, elapsed / vm.fetched());
+
+          if (action.kind == MotionVMType::MOVE)
+            step_cycles = std::min(
+                step_cycles, uint64_t{action.plan->psc + 1U} *
+                                 (action.plan->arr + 1U) * SystemCoreClock /
+                                 psc_clk_hz);
+        };
+        advance();
+
         Stepper().enable();
-        auto ms_it = mp.begin();
-        do {
-          if (Stepper().rotate(ms_it->steps, ms_it->milli_rev_per_minute,
-                               ms_it->direction)) {
-            if (++ms_it == mp.end()) ms_it = mp.begin();
+        while (action.kind != MotionVMType::HALT) {
+          /* A short press resumes from WAIT, otherwise it stops */
+          if (Push_Button().longPress()) break;
+          if (Push_Button().shortPress()) {
+            if (action.kind != MotionVMType::WAIT) break;
+            advance();
           }
-        } while (!(Push_Button().shortPress() || Push_Button().longPress()));
+
+          if (action.kind == MotionVMType::MOVE) {
+            if (Stepper().rotate(*action.plan)) advance();
+          } else if (action.kind == MotionVMType::DWELL) {
+            /* Counted in milliseconds from the end of the rotation */
+            if (Stepper().isBusy()) {
+              t0 = dwt::getCycles();
+            } else if (dwt::toMicros(t0) >= 1000) {
+              t0 += SystemCoreClock / 1000;
+              if (!--action.ms) advance();
+            }
+          }
+        }
 
         Stepper().disable();
+        PRINTD("MotionVM: %" PRIu32 " cycles per instruction, %" PRIu32
+               " per action, shortest step period %" PRIu64 " cycles",
+               vm_cycles, vm_max_cycles,
+               step_cycles == UINT64_MAX ? 0 : step_cycles);
+        if (action.kind == MotionVMType::HALT) {
+          rewind(display_out);
+          fmt::print<"Err-6 Bad program\n">(display_out);
+          Hw_Alarm().delay(DISPLAY_HOLD);
+        }
         PRINTD("Stopped movement pattern execution");
       } else {
         rewind(display_out);
-        fprintf(display_out, "Err-1 No data\n");
+        fmt::print<"Err-1 No data\n">(display_out);
         Hw_Alarm().delay(DISPLAY_HOLD);
         PRINTD("Movement pattern execution aborted");
       }
 
-      fprintf(display_out, "\rIdle\n");
+      fmt::print<"\rIdle\n">(display_out);
       PRINTD("Back to IDLE state");
     }
 
-    /* Prepare to monitor for reading readiness */
-    timeval tv{};
+    /* Prepare to monitor for reading readiness, sleeping meanwhile */
+    timeval tv{.tv_sec = 0,
+               .tv_usec = std::chrono::microseconds(SELECT_TIMEOUT).count()};
     fd_set rfds{};
     FD_SET(kbd_fd, &rfds);
 
     if (select(kbd_fd + 1, &rfds, nullptr, nullptr, &tv) > 0) {
-      fprintf(display_out, "\rInput\n");
+      fmt::print<"\rInput\n">(display_out);
       PRINTD("Input data available");
 
       /* Acquire full line while blocking */
@@ -230,7 +306,7 @@ static void systemClockConfig();
         if (const auto mr =
                 ctre::match<RX_PATTERN>(buf.cbegin(), buf.cbegin() + len)) {
           /* Check for available space in the NVS */
-          if (const auto ms_idx = mp.size(); ms_idx < mp.max_size()) {
+          if (const auto ms_idx = mp.size(); !mp.full()) {
             /* Acquire ADC sample */
             if (uint16_t pot_mv; fread(&pot_mv, sizeof(pot_mv), 1, adc)) {
               PRINTD("ADC: %u.%0u mV", pot_mv / 1000, pot_mv % 1000);
@@ -244,29 +320,24 @@ static void systemClockConfig();
               auto angle_x10 = mr.get<1>().to_number() * 10 +
                                (mr.get<2>() ? mr.get<2>().to_number() : 0);
 
-              ms.steps = iround(angle_x10 * (STEPS_PER_REV / 10), DEGREES_360);
+              ms.steps = motion::stepsFromAngle(angle_x10);
               ms.direction = buf.front() != '-' ? BStepper::CCW : BStepper::CW;
 
               /* Angular velocity generated by mapping the ADC reading of
                * the potentiometer wiper voltage from the input dynamic of
                * the ADC to [50, 400] rpm */
-              ms.milli_rev_per_minute =
-                  MILLI_RPM_MIN +
-                  iround(pot_mv * (MILLI_RPM_MAX - MILLI_RPM_MIN),
-                         ADC_FULLSCALE_mV);
+              ms.milli_rev_per_minute = motion::milliRpmFromMv(pot_mv);
 
               /* Log new motion segment in proper units after rounding */
-              angle_x10 = (ms.steps * DEGREES_360 * 10) / STEPS_PER_REV;
-              auto [rpm_ip, rpm_fp] = std::div(ms.milli_rev_per_minute, 1000);
-              auto [angle_ip, angle_fp] = std::div(angle_x10, 10);
-              angle_ip *= (ms.direction == BStepper::CCW ? 1 : -1);
+              angle_x10 = motion::angleFromSteps(ms.steps);
+              const auto rpm = fmt::fixed<3>(ms.milli_rev_per_minute);
+              const auto angle = fmt::fixed<1>(
+                  ms.direction == BStepper::CCW ? angle_x10 : -angle_x10);
 
               rewind(display_out);
-              fprintf(display_out, "[%u] %u.%03u %d.%01d\n", ms_idx, rpm_ip,
-                      rpm_fp, angle_ip, angle_fp);
+              fmt::print<"[%u] %u %d\n">(display_out, ms_idx, rpm, angle);
               Hw_Alarm().delay(DISPLAY_HOLD);
-              PRINTD("Motion segment: [%u] %u.%03u rpm %d.%01d deg", ms_idx,
-                     rpm_ip, rpm_fp, angle_ip, angle_fp);
+              PRINTD("Motion segment: [%u] %u rpm %d deg", ms_idx, rpm, angle);
 
               /* Commit to NVS */
               if (!mp.pushBack(ms))
@@ -274,30 +345,30 @@ static void systemClockConfig();
 
             } else {
               rewind(display_out);
-              fprintf(display_out, "Err-4 ADC Fail\n");
+              fmt::print<"Err-4 ADC Fail\n">(display_out);
               Hw_Alarm().delay(DISPLAY_HOLD);
-              PRINTD("fread(, adc) failed", ms_idx, mp.max_size());
+              PRINTD("fread(, adc) failed");
             }
           } else {
             rewind(display_out);
-            fprintf(display_out, "Err-3 Full\n");
+            fmt::print<"Err-3 Full\n">(display_out);
             Hw_Alarm().delay(DISPLAY_HOLD);
             PRINTD("MotionPattern cache is full: %u/%u", ms_idx, mp.max_size());
           }
         } else {
           rewind(display_out);
-          fprintf(display_out, "Err-2 Bad pattern\n");
+          fmt::print<"Err-2 Bad pattern\n">(display_out);
           Hw_Alarm().delay(DISPLAY_HOLD);
           PRINTD("Line validation failed");
         }
       } else {
         rewind(display_out);
-        fprintf(display_out, "Err-5 IO Failure\n");
+        fmt::print<"Err-5 IO Failure\n">(display_out);
         Hw_Alarm().delay(DISPLAY_HOLD);
         PRINTD("fgets(, kbd) failed");
       }
 
-      fprintf(display_out, "\rIdle\n");
+      fmt::print<"\rIdle\n">(display_out);
       PRINTD("Back to IDLE state");
     }
   }
@@ -342,18 +413,24 @@ static void systemClockConfig() {
   LL_SetSystemCoreClock(HCLK_FREQUENCY_HZ);
 }
 
+static void printMemUsage() {
+  PRINTD("Memory: pool %u B, heap %u/%u B, stack %u/%u B",
+         mempool::poolSize(), mempool::heapHighWater(), mempool::heapSize(),
+         mempool::stackHighWater(), mempool::stackSize());
+}
+
 static SpiMasterType &Spi_Master() {
   static SpiMasterType obj(SPI3, Hw_Alarm());
   return obj;
 }
 
-static StLinkUartTxType &St_Link_Uart_Tx() {
-  static StLinkUartTxType obj(USART2, DMA1);
+RAMFUNC StLinkUartTxType &St_Link_Uart_Tx() {
+  POOL static StLinkUartTxType obj(USART2, DMA1);
   return obj;
 }
 
-static SSegDisplayType &SSeg_Display() {
-  static SSegDisplayType obj(USART1, DMA2, Hw_Alarm());
+RAMFUNC SSegDisplayType &SSeg_Display() {
+  POOL static SSegDisplayType obj(USART1, DMA2, Hw_Alarm());
   return obj;
 }
 
@@ -369,25 +446,26 @@ static KeyboardType &Kbd() {
 
 FileManagerType &File_Manager() {
   static FileManagerType fm{
-      Node{"st_link_uart_tx", St_Link_Uart_Tx()},
-      Node{"sseg_display", SSeg_Display()},
-      Node{"ltc_2308", Ltc_2308()},
-      Node{"kbd", Kbd()},
+      Hw_Alarm(),
+      Node<"st_link_uart_tx", StLinkUartTxType>{St_Link_Uart_Tx()},
+      Node<"sseg_display", SSegDisplayType>{SSeg_Display()},
+      Node<"ltc_2308", LTC2308Type>{Ltc_2308()},
+      Node<"kbd", KeyboardType>{Kbd()},
   };
   return fm;
 }
 
-HwAlarmType &Hw_Alarm() {
+RAMFUNC HwAlarmType &Hw_Alarm() {
   static HwAlarmType obj;
   return obj;
 }
 
-PushButtonType &Push_Button() {
+RAMFUNC PushButtonType &Push_Button() {
   static PushButtonType obj{B1_GPIO_Port, B1_Pin, Hw_Alarm(), 35ms};
   return obj;
 }
 
-BStepper &Stepper() {
+RAMFUNC BStepper &Stepper() {
   static BStepper obj{AB_GPIO_Port, TIM1, DMA2};
   return obj;
 }
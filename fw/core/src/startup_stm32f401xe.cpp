@@ -8,6 +8,7 @@
 #include <cstddef>
 #include <cstdlib>
 #include <debug.h>
+#include <mempool.h>
 #include <stm32f4xx.h>
 
 /* Symbols from linker script */
@@ -17,6 +18,14 @@ extern unsigned char __data_vstart[];
 extern unsigned char __data_lstart[];
 extern unsigned char __data_size[];
 
+extern unsigned char __ramfunc_vstart[];
+extern unsigned char __ramfunc_lstart[];
+extern unsigned char __ramfunc_size[];
+
+extern unsigned char __ram_vector_start[];
+extern unsigned char __isr_vector_lstart[];
+extern unsigned char __isr_vector_size[];
+
 /* Prevent name mangling for these symbols */
 extern "C" {
 
@@ -33,6 +42,18 @@ extern "C" {
   __builtin_memcpy(__data_vstart, __data_lstart,
                    reinterpret_cast<size_t>(__data_size));
 
+  /* Copy RAM-resident code, and relocate the vector table next to it:
+   * interrupts are then served while the flash is programmed or erased */
+  __builtin_memcpy(__ramfunc_vstart, __ramfunc_lstart,
+                   reinterpret_cast<size_t>(__ramfunc_size));
+  __builtin_memcpy(__ram_vector_start, __isr_vector_lstart,
+                   reinterpret_cast<size_t>(__isr_vector_size));
+  SCB->VTOR = reinterpret_cast<uintptr_t>(__ram_vector_start);
+  __DSB();
+
+  /* High-water mark of the stack */
+  mempool::paintStack();
+
   /* C/C++ entry point */
   _start();
 }
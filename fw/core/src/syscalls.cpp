@@ -35,6 +35,7 @@
 
 #include "debug.h"
 #include "main.h"
+#include "mempool.h"
 #include "stm32f4xx.h"
 
 /*
@@ -45,33 +46,21 @@
 #undef errno
 extern int errno;
 
-/* Symbols from linker script */
-extern unsigned char end[];
-
-/*
- * Global variable linked with the core register used as stack pointer
- * (see: https://github.com/ARM-software/abi-aa/blob/main/aapcs32/aapcs32.rst
- *       https://gcc.gnu.org/onlinedocs/gcc/Global-Register-Variables.html )
- */
-register unsigned char *stack_ptr asm("sp");
-
 /* System calls */
 static auto &fm = File_Manager();
 
 /* (prevent name mangling for these symbols) */
 extern "C" {
 
-/* Memory management */
+/* Memory management, within the heap arena */
 void *_sbrk(ptrdiff_t incr) {
-  static unsigned char *heap_end = end;
-  unsigned char *prev_heap_end = heap_end;
+  const auto prev_heap_end = mempool::sbrk(incr);
 
-  if (heap_end + incr > stack_ptr) {
+  if (!prev_heap_end) {
     errno = ENOMEM;
     return reinterpret_cast<void *>(-1);
   }
 
-  heap_end += incr;
   return prev_heap_end;
 }
 
@@ -144,7 +133,60 @@ int fcntl(int fd, int cmd, ...) {
   return wrapCall(ret);
 }
 
+/* Variadic function, the argument being optional */
+int ioctl(int fd, unsigned long request, ...) {
+  va_list vlist;
+
+  va_start(vlist, request);
+  auto ret = fm.vioctl(fd, request, vlist);
+  va_end(vlist);
+
+  return wrapCall(ret);
+}
+
 int select(int n, fd_set *inp, fd_set *outp, fd_set *exp, timeval *tvp) {
   return wrapCall(fm.select(n, inp, outp, exp, tvp));
 }
+
+int epoll_create1(int flags) { return wrapCall(fm.epollCreate(flags)); }
+
+int epoll_ctl(int epfd, int op, int fd, epoll_event *event) {
+  return wrapCall(fm.epollCtl(epfd, op, fd, event));
+}
+
+int epoll_wait(int epfd, epoll_event *events, int maxevents, int timeout) {
+  return wrapCall(fm.epollWait(epfd, events, maxevents, timeout));
+}
+
+int pipe(int fds[2]) { return wrapCall(fm.pipe(fds)); }
+
+int pipe2(int fds[2], int flags) { return wrapCall(fm.pipe(fds, flags)); }
+
+ssize_t readv(int fd, const iovec *iov, int iovcnt) {
+  return wrapCall(fm.readv(fd, iov, iovcnt));
+}
+
+ssize_t writev(int fd, const iovec *iov, int iovcnt) {
+  return wrapCall(fm.writev(fd, iov, iovcnt));
+}
+
+ssize_t writebuf_acquire(int fd, void **buf, size_t count) {
+  return wrapCall(fm.writeBufAcquire(fd, buf, count));
+}
+
+ssize_t writebuf_commit(int fd, size_t count) {
+  return wrapCall(fm.writeBufCommit(fd, count));
+}
+
+ssize_t fmap(int fd, int prot, void **addr) {
+  return wrapCall(fm.fmap(fd, prot, addr));
+}
+
+int io_ring_submit(const io_sqe *sqes, unsigned nr) {
+  return wrapCall(fm.ioSubmit(sqes, nr));
+}
+
+int io_ring_wait(io_cqe *cqes, unsigned min, unsigned max, int timeout) {
+  return wrapCall(fm.ioWait(cqes, min, max, timeout));
+}
 }
\ No newline at end of file
@@ -0,0 +1,50 @@
+/**
+ * @file     BStepper.h
+ * @author   Fabio Scatozza <s315216@studenti.polito.it>
+ * @date     18.10.2026
+ *
+ * Host double of the motor driver: MotionPattern only depends on its types and
+ * on compile(), which here validates the segment without a timer to target
+ */
+
+#ifndef BSTEPPER_H
+#define BSTEPPER_H
+
+#include <array>
+#include <cstdint>
+
+class BStepper {
+ public:
+  using StepCountType = uint16_t;
+  using SpeedType = uint32_t;
+
+  enum Direction : uint8_t { CCW = 0, CW };
+  enum StepType : uint8_t { FULL = 0, HALF };
+
+  using TimRegType = uint16_t;
+  using TimRCRType = uint8_t;
+
+  struct Plan {
+    TimRegType psc;
+    TimRegType arr;
+    TimRCRType rcr;
+    TimRCRType hw_reps;
+    StepCountType sw_reps;
+    StepCountType steps;
+    Direction direction;
+    StepType type;
+  };
+
+  bool compile(StepCountType steps, SpeedType milli_rev_per_minute, Direction d,
+               Plan &p, StepType t = FULL) const {
+    p = {};
+    if (!steps || !milli_rev_per_minute) return false;
+
+    p.steps = steps;
+    p.direction = d;
+    p.type = t;
+    return true;
+  }
+};
+
+#endif  // BSTEPPER_H
@@ -0,0 +1,41 @@
+/**
+ * @file     Check.h
+ * @author   Fabio Scatozza <s315216@studenti.polito.it>
+ * @date     18.10.2026
+ *
+ * Failure accounting of the host checks: CHECK() reports the expression and
+ * the line of a check that fails, counted in failures, from any thread.
+ */
+
+#ifndef CHECK_H
+#define CHECK_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+
+namespace check {
+
+using Clock = std::chrono::steady_clock;
+
+inline std::atomic<uint64_t> failures = 0;
+
+inline void verify(bool ok, const char *what, int line) {
+  if (ok) return;
+
+  fprintf(stderr, "line %d: %s\n", line, what);
+  ++failures;
+}
+
+inline int64_t elapsedMs(Clock::time_point start) {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() -
+                                                               start)
+      .count();
+}
+
+} // namespace check
+
+#define CHECK(expr) check::verify((expr), #expr, __LINE__)
+
+#endif // CHECK_H
@@ -0,0 +1,56 @@
+/**
+ * @file     CoreSim.h
+ * @author   Fabio Scatozza <s315216@studenti.polito.it>
+ * @date     18.10.2026
+ *
+ * Emulated Cortex-M4 core, for the firmware running as a single host thread.
+ * Interrupt handlers only run within __WFI(), which waits on:
+ *   - interrupt lines, raised by a host file descriptor turning ready for
+ *     the armed poll(2) events. A line is masked as it fires, and re-armed
+ *     by its driver, for the events that are not pending anymore: this
+ *     models edge-triggered peripherals
+ *   - one-shot timers, on the host monotonic clock
+ *   - NVIC lines, driven by the level of an emulated peripheral. While high
+ *     and enabled, the handler runs at each __WFI(), before waiting
+ * With nothing to wait on, __WFI() would never return: the deadlock aborts.
+ * The DWT cycle counter follows the host monotonic clock at SystemCoreClock.
+ */
+
+#ifndef CORESIM_H
+#define CORESIM_H
+
+#include <chrono>
+#include <cstdint>
+
+namespace core::sim {
+
+using Isr = void (*)(void *ctx);
+using Clock = std::chrono::steady_clock;
+
+/* Interrupt line, initially masked. Returns its id */
+int attach(int fd, Isr isr, void *ctx);
+void detach(int line);
+
+/* Unmask the line for the poll(2) events (POLLIN, POLLOUT), 0 to mask */
+void arm(int line, short events);
+
+/* One-shot timer, identified by ctx, which it is re-armed with */
+void setTimer(Clock::time_point deadline, Isr isr, void *ctx);
+void clearTimer(void *ctx);
+
+/* NVIC line, by IRQ number, and its handler */
+void attachIrq(int irqn, Isr isr, void *ctx);
+void enableIrq(int irqn, bool enable);
+void setIrqLevel(int irqn, bool high);
+
+/* Wait for the next interrupt, and run its handler */
+void wfi();
+
+/* Exception number of the running NVIC handler, 0 otherwise */
+uint32_t ipsr();
+
+uint32_t cycles();
+
+} // namespace core::sim
+
+#endif // CORESIM_H
@@ -0,0 +1,62 @@
+/**
+ * @file     FlashSim.h
+ * @author   Fabio Scatozza <s315216@studenti.polito.it>
+ * @date     18.10.2026
+ *
+ * Control interface of the emulated STM32F401 flash. The array is mapped
+ * read-only at its physical address, so that firmware code can read it
+ * through plain pointers, while any store bypassing flash::programAt()
+ * faults. The emulator enforces:
+ *   - programming only clears bits (1 -> 0); attempts to set bits are
+ *     counted as violations and the stored value is the bitwise AND
+ *   - the operation sequence (PGSERR), parallelism (PGPERR) and alignment
+ *     (PGAERR) rules
+ *   - sector erase granularity, with typical program/erase times charged to
+ *     a virtual clock
+ * A power cut can be armed on any program or erase step: the operation is
+ * torn and flash::sim::PowerCut is thrown, with the registers at their reset
+ * values.
+ */
+
+#ifndef FLASHSIM_H
+#define FLASHSIM_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace flash::sim {
+
+constexpr uintptr_t Base_Addr = 0x0800'0000U;
+constexpr size_t Size = 0x1UL << 19;
+
+/* Thrown at the power cut, after tearing the operation */
+struct PowerCut {
+  uintptr_t addr;
+  bool erase;
+};
+
+struct Stats {
+  uint64_t programs;   /* Program operations */
+  uint64_t erases;     /* Sector or mass erase operations */
+  uint64_t violations; /* Programs attempting 0 -> 1 transitions */
+  uint64_t errors;     /* Programs or erases rejected with an error flag */
+};
+
+/* Map the array (fully erased) and reset the registers. Returns false if the
+ * physical address range is not available */
+bool init(uint64_t seed = 0);
+
+/* Reset the registers, as after a power-on */
+void reset();
+
+/* Tear the n-th program/erase step from now (n > 0), or disarm (n = 0) */
+void armPowerCut(uint64_t n);
+bool isArmed();
+
+/* Virtual time spent programming and erasing */
+uint64_t now_us();
+const Stats &stats();
+
+} // namespace flash::sim
+
+#endif // FLASHSIM_H
@@ -0,0 +1,110 @@
+/**
+ * @file     HwAlarm.h
+ * @author   Fabio Scatozza <s315216@studenti.polito.it>
+ * @date     18.10.2026
+ *
+ * Host double of HwAlarm, with the interface of the 2-channel, 16-bit timer
+ * instance the FileManager is built with: one channel alarm, the other channel
+ * multiplexing the virtual alarms, more than on target. Alarms fire within
+ * __WFI(), from the timers of the core emulator.
+ */
+
+#ifndef HWALARM_H
+#define HWALARM_H
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+
+#include "AlarmHeap.hpp"
+#include "CallbackUtils.hpp"
+#include "CoreSim.h"
+#include "WaitQueue.h"
+
+class HwAlarm {
+ public:
+  using DurationRep = uint64_t;
+  using NanoSeconds = std::chrono::duration<DurationRep, std::nano>;
+  using MicroSeconds = std::chrono::duration<DurationRep, std::micro>;
+  using MilliSeconds = std::chrono::duration<DurationRep, std::milli>;
+  using ICallbackType = ICallback<void()>;
+  using Cnt = uint16_t;
+  using SteadyClock = core::sim::Clock;
+
+  enum AlarmState {
+    INVALID_CALLBACK = -4,
+    CHANNELS_BUSY,
+    INVALID_DELAY,
+    DELAY_TOO_SHORT,
+    STARTED = 0,
+    STOPPED,
+    CHANGED
+  };
+
+  class VirtualAlarm : AlarmNode {
+   public:
+    explicit VirtualAlarm(const ICallbackType *icb)
+        : icb(icb), reps(0), period{} {}
+
+   private:
+    friend HwAlarm;
+
+    const ICallbackType *icb;
+    uint32_t reps;
+    core::sim::Clock::duration period;
+  };
+
+  static constexpr size_t NMAX_VIRTUAL = 1024;
+
+  HwAlarm();
+  ~HwAlarm();
+
+  bool setResolution(const NanoSeconds &tick);
+
+  AlarmState setAlarm(const NanoSeconds &delay, const ICallbackType *icb,
+                      uint32_t reps = 1);
+  AlarmState setAlarm(const ICallbackType *icb, uint32_t reps,
+                      const NanoSeconds &delay = NanoSeconds::zero(),
+                      const ICallbackType *icb_new = nullptr);
+
+  AlarmState setAlarm(const NanoSeconds &delay, VirtualAlarm &va,
+                      uint32_t reps = 1);
+  AlarmState setAlarm(VirtualAlarm &va, uint32_t reps,
+                      const NanoSeconds &delay = NanoSeconds::zero());
+
+  /* Sleeps within __WFI() on a virtual alarm, serving the others */
+  void delay(const NanoSeconds &t);
+
+  NanoSeconds maxDelay() const;
+
+ private:
+  static constexpr size_t _nch = 1;
+
+  struct Alarm {
+    HwAlarm *owner;
+    const ICallbackType *icb;
+    uint32_t reps;
+    core::sim::Clock::duration period;
+    core::sim::Clock::time_point deadline;
+  };
+
+  static void _handler(void *ctx);
+  bool _toPeriod(const NanoSeconds &delay,
+                 core::sim::Clock::duration &period) const;
+
+  /* Deadlines are keyed by the host clock count */
+  static uint64_t _toKey(core::sim::Clock::time_point t);
+  static core::sim::Clock::time_point _fromKey(uint64_t key);
+  static void _virtualHandler(void *ctx);
+  void _armVirtual();
+  void _wake() { _delay_wq.wake(); }
+
+  std::array<Alarm, _nch> _alarms;
+  AlarmHeap<NMAX_VIRTUAL> _vheap;
+  MemFnCallback<HwAlarm, void()> _delay_cb;
+  VirtualAlarm _delay_alarm;
+  WaitQueue _delay_wq;
+  NanoSeconds _tick;
+};
+
+#endif // HWALARM_H
@@ -0,0 +1,60 @@
+/**
+ * @file     PosixFile.h
+ * @author   Fabio Scatozza <s315216@studenti.polito.it>
+ * @date     18.10.2026
+ *
+ * Node backed by host file descriptors: reads from one, writes to the other
+ * (the two ends of a pipe loop back). Their readiness raises the interrupt
+ * lines of the core emulator, so that select() and epoll_wait() sleep and are
+ * woken up as by the target drivers.
+ */
+
+#ifndef POSIXFILE_H
+#define POSIXFILE_H
+
+#include <vector>
+
+#include "IFile.h"
+
+class PosixFile final : public IFile {
+ public:
+  /* Takes ownership of the descriptors */
+  PosixFile(int rfd, int wfd);
+  explicit PosixFile(int fd) : PosixFile(fd, fd) {}
+  ~PosixFile() override;
+
+  PosixFile(const PosixFile &) = delete;
+  PosixFile &operator=(const PosixFile &) = delete;
+
+  int open(OFile &ofile) override;
+  int close(OFile &ofile) override;
+  off_t llseek(OFile &ofile, off_t offset, int whence) override;
+  ssize_t read(OFile &ofile, char *buf, size_t count, off_t &pos) override;
+  ssize_t write(OFile &ofile, const char *buf, size_t count,
+                off_t &pos) override;
+  __poll_t poll(OFile &ofile) override;
+  /* Regular files only, mapped shared until the file is closed. Once per
+   * open file, unless resized or with more permissions */
+  ssize_t mmap(OFile &ofile, int prot, void *&addr) override;
+
+ private:
+  static void _isr(void *ctx);
+
+  /* Wait for the event while blocking, or arm its line */
+  bool _wait(const OFile &ofile, int line, short event);
+
+  int _rfd;
+  int _wfd;
+  int _rline;
+  int _wline;
+
+  struct Map {
+    const OFile *ofile;
+    void *addr;
+    size_t len;
+    int prot;
+  };
+  std::vector<Map> _maps;
+};
+
+#endif // POSIXFILE_H
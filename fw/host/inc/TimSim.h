@@ -0,0 +1,50 @@
+/**
+ * @file     TimSim.h
+ * @author   Fabio Scatozza <s315216@studenti.polito.it>
+ * @date     18.10.2026
+ *
+ * Emulated STM32F401 general-purpose timers, upcounting from the internal
+ * clock (SystemCoreClock, with the APB prescalers at 1). The registers are
+ * mapped at their physical address, so that firmware code reaches them
+ * through the base address, as on target. The counter follows the host
+ * monotonic clock, and every register access first brings it up to date:
+ *   - CNT advances while CR1.CEN is set, wrapping at ARR and setting UIF
+ *   - CCxIF is set as CNT reaches CCRx, the CCR registers being plain memory
+ *   - SR is cleared by writing 0, EGR generates the UG and CCxG events (UIF
+ *     by UG unless CR1.URS), PSC is loaded at the update event
+ * The interrupt line, SR & DIER, is level-sensitive and served by the core
+ * emulator within __WFI(). A host timer wakes it up at the next flag that is
+ * enabled to interrupt.
+ */
+
+#ifndef TIMSIM_H
+#define TIMSIM_H
+
+#include <cstdint>
+
+namespace tim::sim {
+
+uint32_t read(const uint32_t *reg);
+void write(uint32_t *reg, uint32_t value);
+
+/* Register with the access semantics of the emulated peripheral */
+class Reg {
+ public:
+  operator uint32_t() const { return read(&_value); }
+  Reg &operator=(uint32_t value) {
+    write(&_value, value);
+    return *this;
+  }
+  Reg &operator|=(uint32_t bits) { return *this = *this | bits; }
+  Reg &operator&=(uint32_t bits) { return *this = *this & bits; }
+
+ private:
+  uint32_t _value;
+};
+
+/* Map the instance at base, in its reset state, stopped */
+void attach(uintptr_t base);
+
+} // namespace tim::sim
+
+#endif // TIMSIM_H
@@ -0,0 +1,23 @@
+/**
+ * @file     fcntl.h
+ * @author   Fabio Scatozza <s315216@studenti.polito.it>
+ * @date     18.10.2026
+ *
+ * Host extension of the C library header with what the firmware takes from
+ * newlib: the kernel-style file mode and flags, and the fd_set bitmap member
+ */
+
+#ifndef HOST_FCNTL_H
+#define HOST_FCNTL_H
+
+#include_next <fcntl.h>
+#include <sys/select.h>
+
+#define FREAD 1
+#define FWRITE 2
+#define FTRUNC O_TRUNC
+#define O_BINARY 0
+
+#define __fds_bits fds_bits
+
+#endif // HOST_FCNTL_H
@@ -0,0 +1,171 @@
+/**
+ * @file     stm32f4xx.h
+ * @author   Fabio Scatozza <s315216@studenti.polito.it>
+ * @date     18.10.2026
+ *
+ * Host replacement of the CMSIS device header: only the flash interface,
+ * backed by the emulator in src/flash.cpp, the core intrinsics, NVIC and DWT
+ * cycle counter, backed by the one in src/core.cpp, and the general-purpose
+ * timers, backed by the one in src/tim_sim.cpp, are provided
+ */
+
+#ifndef STM32F4XX_H
+#define STM32F4XX_H
+
+#include <cstdint>
+
+#include "CoreSim.h"
+#include "TimSim.h"
+
+/* Register access, as in CMSIS */
+#define SET_BIT(REG, BIT) ((REG) |= (BIT))
+#define CLEAR_BIT(REG, BIT) ((REG) &= ~(BIT))
+#define READ_BIT(REG, BIT) ((REG) & (BIT))
+#define WRITE_REG(REG, VAL) ((REG) = (VAL))
+#define READ_REG(REG) ((REG))
+
+struct FLASH_TypeDef {
+  volatile uint32_t ACR;
+  volatile uint32_t KEYR;
+  volatile uint32_t OPTKEYR;
+  volatile uint32_t SR;
+  volatile uint32_t CR;
+  volatile uint32_t OPTCR;
+};
+
+extern FLASH_TypeDef Host_Flash;
+#define FLASH (&Host_Flash)
+
+/* Bit definitions, as in stm32f401xe.h */
+#define FLASH_SR_EOP (0x1UL << 0)
+#define FLASH_SR_SOP (0x1UL << 1)
+#define FLASH_SR_WRPERR (0x1UL << 4)
+#define FLASH_SR_PGAERR (0x1UL << 5)
+#define FLASH_SR_PGPERR (0x1UL << 6)
+#define FLASH_SR_PGSERR (0x1UL << 7)
+#define FLASH_SR_BSY (0x1UL << 16)
+
+#define FLASH_CR_PG (0x1UL << 0)
+#define FLASH_CR_SER (0x1UL << 1)
+#define FLASH_CR_MER (0x1UL << 2)
+#define FLASH_CR_SNB_Pos (3U)
+#define FLASH_CR_SNB (0xFUL << FLASH_CR_SNB_Pos)
+#define FLASH_CR_PSIZE_Pos (8U)
+#define FLASH_CR_PSIZE (0x3UL << FLASH_CR_PSIZE_Pos)
+#define FLASH_CR_STRT (0x1UL << 16)
+#define FLASH_CR_EOPIE (0x1UL << 24)
+#define FLASH_CR_ERRIE (0x1UL << 25)
+#define FLASH_CR_LOCK (0x1UL << 31)
+
+/*
+ * Core: handlers only run within __WFI(), in thread mode, so masking the
+ * interrupts is a no-op
+ */
+inline void __disable_irq() {}
+inline void __enable_irq() {}
+inline uint32_t __get_PRIMASK() { return 0; }
+inline void __set_PRIMASK(uint32_t) {}
+inline void __ISB() {}
+inline void __WFI() { core::sim::wfi(); }
+inline uint32_t __get_IPSR() { return core::sim::ipsr(); }
+
+/* Interrupt numbers, as in stm32f401xe.h */
+enum IRQn_Type {
+  NonMaskableInt_IRQn = -14,
+  TIM1_BRK_TIM9_IRQn = 24,
+  TIM1_UP_TIM10_IRQn = 25,
+  TIM1_TRG_COM_TIM11_IRQn = 26,
+  TIM1_CC_IRQn = 27,
+  TIM2_IRQn = 28,
+  TIM3_IRQn = 29,
+  TIM4_IRQn = 30,
+  TIM5_IRQn = 50
+};
+
+/* Level-sensitive lines: clearing a pending one is only a re-evaluation */
+inline void NVIC_EnableIRQ(IRQn_Type irqn) { core::sim::enableIrq(irqn, true); }
+inline void NVIC_DisableIRQ(IRQn_Type irqn) {
+  core::sim::enableIrq(irqn, false);
+}
+inline void NVIC_ClearPendingIRQ(IRQn_Type) {}
+inline uint32_t NVIC_GetPriorityGrouping() { return 0; }
+inline uint32_t NVIC_EncodePriority(uint32_t, uint32_t preempt, uint32_t) {
+  return preempt;
+}
+inline void NVIC_SetPriority(IRQn_Type, uint32_t) {}
+
+extern uint32_t SystemCoreClock;
+
+struct CoreDebug_Type {
+  volatile uint32_t DHCSR;
+  volatile uint32_t DCRSR;
+  volatile uint32_t DCRDR;
+  volatile uint32_t DEMCR;
+};
+
+extern CoreDebug_Type Host_CoreDebug;
+#define CoreDebug (&Host_CoreDebug)
+
+#define CoreDebug_DEMCR_TRCENA_Msk (0x1UL << 24)
+
+struct DWT_Type {
+  volatile uint32_t CTRL;
+  volatile uint32_t CYCCNT;
+};
+
+/* CYCCNT is refreshed from the host clock at each access */
+DWT_Type *Host_Dwt();
+#define DWT (Host_Dwt())
+
+#define DWT_CTRL_CYCCNTENA_Msk (0x1UL << 0)
+
+/* CR1 and CR2 are also <termios.h> macros, on the host */
+#pragma push_macro("CR1")
+#pragma push_macro("CR2")
+#undef CR1
+#undef CR2
+struct TIM_TypeDef {
+  tim::sim::Reg CR1;
+  tim::sim::Reg CR2;
+  tim::sim::Reg SMCR;
+  tim::sim::Reg DIER;
+  tim::sim::Reg SR;
+  tim::sim::Reg EGR;
+  tim::sim::Reg CCMR1;
+  tim::sim::Reg CCMR2;
+  tim::sim::Reg CCER;
+  tim::sim::Reg CNT;
+  tim::sim::Reg PSC;
+  tim::sim::Reg ARR;
+  tim::sim::Reg RCR;
+  tim::sim::Reg CCR1;
+  tim::sim::Reg CCR2;
+  tim::sim::Reg CCR3;
+  tim::sim::Reg CCR4;
+  tim::sim::Reg BDTR;
+  tim::sim::Reg DCR;
+  tim::sim::Reg DMAR;
+  tim::sim::Reg OR;
+};
+#pragma pop_macro("CR1")
+#pragma pop_macro("CR2")
+
+#define TIM2_BASE 0x40000000UL
+#define TIM3_BASE 0x40000400UL
+#define TIM4_BASE 0x40000800UL
+#define TIM5_BASE 0x40000C00UL
+#define TIM1_BASE 0x40010000UL
+#define TIM9_BASE 0x40014000UL
+#define TIM10_BASE 0x40014400UL
+#define TIM11_BASE 0x40014800UL
+
+#define TIM_CR1_CEN (0x1U << 0)
+#define TIM_CR1_URS (0x1U << 2)
+#define TIM_DIER_UIE (0x1U << 0)
+#define TIM_DIER_CC1IE (0x1U << 1)
+#define TIM_SR_UIF (0x1U << 0)
+#define TIM_SR_CC1IF (0x1U << 1)
+#define TIM_EGR_UG (0x1U << 0)
+#define TIM_EGR_CC1G (0x1U << 1)
+
+#endif // STM32F4XX_H
@@ -0,0 +1,27 @@
+/**
+ * @file     stm32f4xx_ll_bus.h
+ * @author   Fabio Scatozza <s315216@studenti.polito.it>
+ * @date     18.10.2026
+ *
+ * Host replacement of the LL bus driver: the emulated peripherals are always
+ * clocked
+ */
+
+#ifndef STM32F4XX_LL_BUS_H
+#define STM32F4XX_LL_BUS_H
+
+#include <cstdint>
+
+#define LL_APB1_GRP1_PERIPH_TIM2 (0x1UL << 0)
+#define LL_APB1_GRP1_PERIPH_TIM3 (0x1UL << 1)
+#define LL_APB1_GRP1_PERIPH_TIM4 (0x1UL << 2)
+#define LL_APB1_GRP1_PERIPH_TIM5 (0x1UL << 3)
+#define LL_APB2_GRP1_PERIPH_TIM1 (0x1UL << 0)
+#define LL_APB2_GRP1_PERIPH_TIM9 (0x1UL << 16)
+#define LL_APB2_GRP1_PERIPH_TIM10 (0x1UL << 17)
+#define LL_APB2_GRP1_PERIPH_TIM11 (0x1UL << 18)
+
+inline void LL_APB1_GRP1_EnableClock(uint32_t) {}
+inline void LL_APB2_GRP1_EnableClock(uint32_t) {}
+
+#endif // STM32F4XX_LL_BUS_H
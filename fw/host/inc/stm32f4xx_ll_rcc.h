@@ -0,0 +1,27 @@
+/**
+ * @file     stm32f4xx_ll_rcc.h
+ * @author   Fabio Scatozza <s315216@studenti.polito.it>
+ * @date     18.10.2026
+ *
+ * Host replacement of the LL RCC driver: the APB buses run at SystemCoreClock,
+ * and so do the timers
+ */
+
+#ifndef STM32F4XX_LL_RCC_H
+#define STM32F4XX_LL_RCC_H
+
+#include <cstdint>
+
+#define LL_RCC_APB1_DIV_1 0x0UL
+#define LL_RCC_APB1_DIV_2 (0x4UL << 10)
+#define LL_RCC_APB2_DIV_1 0x0UL
+#define LL_RCC_APB2_DIV_2 (0x4UL << 13)
+
+#define __LL_RCC_CALC_PCLK1_FREQ(HCLK, APB1PRESCALER) (HCLK)
+#define __LL_RCC_CALC_PCLK2_FREQ(HCLK, APB2PRESCALER) (HCLK)
+
+constexpr uint32_t LL_RCC_GetTIMPrescaler() { return 0; }
+constexpr uint32_t LL_RCC_GetAPB1Prescaler() { return LL_RCC_APB1_DIV_1; }
+constexpr uint32_t LL_RCC_GetAPB2Prescaler() { return LL_RCC_APB2_DIV_1; }
+
+#endif // STM32F4XX_LL_RCC_H
@@ -0,0 +1,47 @@
+/**
+ * @file     stm32f4xx_ll_tim.h
+ * @author   Fabio Scatozza <s315216@studenti.polito.it>
+ * @date     18.10.2026
+ *
+ * Host replacement of the LL timer driver: the functions in use, over the
+ * emulated registers
+ */
+
+#ifndef STM32F4XX_LL_TIM_H
+#define STM32F4XX_LL_TIM_H
+
+#include "stm32f4xx.h"
+
+inline void LL_TIM_EnableCounter(TIM_TypeDef *TIMx) {
+  SET_BIT(TIMx->CR1, TIM_CR1_CEN);
+}
+
+inline uint32_t LL_TIM_IsEnabledCounter(const TIM_TypeDef *TIMx) {
+  return READ_BIT(TIMx->CR1, TIM_CR1_CEN) == TIM_CR1_CEN;
+}
+
+inline void LL_TIM_SetPrescaler(TIM_TypeDef *TIMx, uint32_t Prescaler) {
+  WRITE_REG(TIMx->PSC, Prescaler);
+}
+
+inline void LL_TIM_SetAutoReload(TIM_TypeDef *TIMx, uint32_t AutoReload) {
+  WRITE_REG(TIMx->ARR, AutoReload);
+}
+
+inline void LL_TIM_EnableIT_UPDATE(TIM_TypeDef *TIMx) {
+  SET_BIT(TIMx->DIER, TIM_DIER_UIE);
+}
+
+inline void LL_TIM_ClearFlag_UPDATE(TIM_TypeDef *TIMx) {
+  WRITE_REG(TIMx->SR, ~(TIM_SR_UIF));
+}
+
+inline uint32_t LL_TIM_IsActiveFlag_UPDATE(const TIM_TypeDef *TIMx) {
+  return READ_BIT(TIMx->SR, TIM_SR_UIF) == TIM_SR_UIF;
+}
+
+inline void LL_TIM_GenerateEvent_UPDATE(TIM_TypeDef *TIMx) {
+  SET_BIT(TIMx->EGR, TIM_EGR_UG);
+}
+
+#endif // STM32F4XX_LL_TIM_H
@@ -0,0 +1,219 @@
+/**
+ * @file     HwAlarm.cpp
+ * @author   Fabio Scatozza <s315216@studenti.polito.it>
+ * @date     18.10.2026
+ */
+
+#include "HwAlarm.h"
+
+#include <algorithm>
+#include <limits>
+#include <thread>
+
+HwAlarm::HwAlarm()
+    : _alarms{},
+      _delay_cb(this, &HwAlarm::_wake),
+      _delay_alarm(&_delay_cb),
+      _tick(15'625) {
+  for (auto &a : _alarms) a.owner = this;
+}
+
+HwAlarm::~HwAlarm() {
+  for (auto &a : _alarms) core::sim::clearTimer(&a);
+  core::sim::clearTimer(this);
+}
+
+bool HwAlarm::setResolution(const NanoSeconds &tick) {
+  if (tick == NanoSeconds::zero()) return false;
+
+  _tick = tick;
+  return true;
+}
+
+bool HwAlarm::_toPeriod(const NanoSeconds &delay,
+                        core::sim::Clock::duration &period) const {
+  /* Rounded to the resolution, within the 16-bit counter */
+  const auto ticks = (delay + _tick / 2) / _tick;
+  if (!ticks || ticks > std::numeric_limits<Cnt>::max()) return false;
+
+  period =
+      std::chrono::duration_cast<core::sim::Clock::duration>(ticks * _tick);
+  return true;
+}
+
+auto HwAlarm::setAlarm(const NanoSeconds &delay, const ICallbackType *icb,
+                       uint32_t reps) -> AlarmState {
+  const auto now = core::sim::Clock::now();
+
+  if (!icb || !*icb) return INVALID_CALLBACK;
+
+  const auto a = std::find_if(_alarms.begin(), _alarms.end(),
+                              [](const Alarm &a) { return !a.icb; });
+  if (a == _alarms.end()) return CHANNELS_BUSY;
+
+  if (!_toPeriod(delay, a->period)) return INVALID_DELAY;
+
+  a->icb = icb;
+  a->reps = !reps ? std::numeric_limits<uint32_t>::max() : reps;
+  a->deadline = now + a->period;
+  core::sim::setTimer(a->deadline, _handler, &*a);
+  return STARTED;
+}
+
+auto HwAlarm::setAlarm(const ICallbackType *icb, uint32_t reps,
+                       const NanoSeconds &delay, const ICallbackType *icb_new)
+    -> AlarmState {
+  if (!icb || (icb_new && !*icb_new)) return INVALID_CALLBACK;
+
+  const auto a = std::find_if(_alarms.begin(), _alarms.end(),
+                              [icb](const Alarm &a) { return a.icb == icb; });
+  if (a == _alarms.end()) return INVALID_CALLBACK;
+
+  if (!reps) {
+    a->icb = nullptr;
+    core::sim::clearTimer(&*a);
+    return STOPPED;
+  }
+
+  a->reps = reps;
+
+  if (delay != NanoSeconds::zero()) {
+    /* From the original time instant */
+    const auto start = a->deadline - a->period;
+
+    if (!_toPeriod(delay, a->period)) {
+      a->icb = nullptr;
+      core::sim::clearTimer(&*a);
+      return INVALID_DELAY;
+    }
+
+    a->deadline = start + a->period;
+    if (a->deadline < core::sim::Clock::now()) {
+      a->icb = nullptr;
+      core::sim::clearTimer(&*a);
+      return DELAY_TOO_SHORT;
+    }
+    core::sim::setTimer(a->deadline, _handler, &*a);
+  }
+
+  if (icb_new) a->icb = icb_new;
+  return CHANGED;
+}
+
+void HwAlarm::_handler(void *ctx) {
+  auto &a = *static_cast<Alarm *>(ctx);
+  const auto icb = a.icb;
+
+  /* Done ? Free the channel, before the callback may take it again */
+  if (a.reps != std::numeric_limits<uint32_t>::max() && 0 == --a.reps) {
+    a.icb = nullptr;
+  } else {
+    a.deadline += a.period;
+    core::sim::setTimer(a.deadline, _handler, &a);
+  }
+
+  (*icb)();
+}
+
+uint64_t HwAlarm::_toKey(core::sim::Clock::time_point t) {
+  return t.time_since_epoch().count();
+}
+
+core::sim::Clock::time_point HwAlarm::_fromKey(uint64_t key) {
+  return core::sim::Clock::time_point(core::sim::Clock::duration(key));
+}
+
+void HwAlarm::_armVirtual() {
+  if (const auto top = _vheap.top())
+    core::sim::setTimer(_fromKey(top->deadline), _virtualHandler, this);
+  else
+    core::sim::clearTimer(this);
+}
+
+auto HwAlarm::setAlarm(const NanoSeconds &delay, VirtualAlarm &va,
+                       uint32_t reps) -> AlarmState {
+  const auto now = core::sim::Clock::now();
+
+  if (!va.icb || !*va.icb) return INVALID_CALLBACK;
+
+  core::sim::Clock::duration period;
+  if (!_toPeriod(delay, period)) return INVALID_DELAY;
+
+  if (va.linked()) _vheap.remove(va);
+  if (_vheap.full()) return CHANNELS_BUSY;
+
+  va.reps = !reps ? std::numeric_limits<uint32_t>::max() : reps;
+  va.period = period;
+  va.deadline = _toKey(now + period);
+
+  _vheap.push(va);
+  _armVirtual();
+  return STARTED;
+}
+
+auto HwAlarm::setAlarm(VirtualAlarm &va, uint32_t reps,
+                       const NanoSeconds &delay) -> AlarmState {
+  if (!va.linked()) return INVALID_CALLBACK;
+
+  if (!reps) {
+    _vheap.remove(va);
+    _armVirtual();
+    return STOPPED;
+  }
+
+  va.reps = reps;
+
+  if (delay != NanoSeconds::zero()) {
+    /* From the original time instant */
+    const auto start = _fromKey(va.deadline) - va.period;
+
+    if (!_toPeriod(delay, va.period)) {
+      _vheap.remove(va);
+      _armVirtual();
+      return INVALID_DELAY;
+    }
+
+    if (start + va.period < core::sim::Clock::now()) {
+      _vheap.remove(va);
+      _armVirtual();
+      return DELAY_TOO_SHORT;
+    }
+    _vheap.update(va, _toKey(start + va.period));
+    _armVirtual();
+  }
+
+  return CHANGED;
+}
+
+void HwAlarm::_virtualHandler(void *ctx) {
+  auto &self = *static_cast<HwAlarm *>(ctx);
+
+  /* One at a time, as the callbacks may change the heap */
+  for (;;) {
+    const auto va = static_cast<VirtualAlarm *>(self._vheap.top());
+    if (!va || _fromKey(va->deadline) > core::sim::Clock::now()) break;
+
+    const auto icb = va->icb;
+    if (va->reps != std::numeric_limits<uint32_t>::max() && 0 == --va->reps)
+      self._vheap.remove(*va);
+    else
+      self._vheap.update(*va, _toKey(_fromKey(va->deadline) + va->period));
+
+    (*icb)();
+  }
+
+  self._armVirtual();
+}
+
+void HwAlarm::delay(const NanoSeconds &t) {
+  /* Shorter than a tick, or longer than an alarm */
+  if (setAlarm(t, _delay_alarm) != STARTED) {
+    std::this_thread::sleep_for(t);
+    return;
+  }
+  _delay_wq.sleep();
+}
+
+auto HwAlarm::maxDelay() const -> NanoSeconds {
+  return std::numeric_limits<Cnt>::max() * _tick;
+}
@@ -0,0 +1,137 @@
+/**
+ * @file     PosixFile.cpp
+ * @author   Fabio Scatozza <s315216@studenti.polito.it>
+ * @date     18.10.2026
+ */
+
+#include "PosixFile.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/poll.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+
+#include "CoreSim.h"
+
+PosixFile::PosixFile(int rfd, int wfd)
+    : _rfd(rfd),
+      _wfd(wfd),
+      _rline(core::sim::attach(rfd, _isr, this)),
+      _wline(core::sim::attach(wfd, _isr, this)) {
+  /* Blocking is up to the node, which keeps the core running meanwhile */
+  ::fcntl(_rfd, F_SETFL, ::fcntl(_rfd, F_GETFL) | O_NONBLOCK);
+  ::fcntl(_wfd, F_SETFL, ::fcntl(_wfd, F_GETFL) | O_NONBLOCK);
+}
+
+PosixFile::~PosixFile() {
+  for (const auto &map : _maps) ::munmap(map.addr, map.len);
+
+  core::sim::detach(_rline);
+  core::sim::detach(_wline);
+
+  ::close(_rfd);
+  if (_wfd != _rfd) ::close(_wfd);
+}
+
+int PosixFile::open(OFile &ofile) {
+  if ((ofile.flags & FTRUNC) && (ofile.mode & FWRITE) &&
+      ::ftruncate(_wfd, 0) < 0 && errno != EINVAL)
+    return -errno;
+
+  return 0;
+}
+
+int PosixFile::close(OFile &ofile) {
+  std::erase_if(_maps, [&](const Map &map) {
+    return map.ofile == &ofile && !::munmap(map.addr, map.len);
+  });
+  return 0;
+}
+
+off_t PosixFile::llseek([[maybe_unused]] OFile &ofile, off_t offset,
+                        int whence) {
+  const auto pos = ::lseek(_rfd, offset, whence);
+  return pos < 0 ? -errno : pos;
+}
+
+bool PosixFile::_wait(const OFile &ofile, int line, short event) {
+  if (errno != EAGAIN) return false;
+
+  core::sim::arm(line, event);
+  if (ofile.flags & FNONBLOCK) return false;
+
+  __WFI();
+  return true;
+}
+
+ssize_t PosixFile::read(OFile &ofile, char *buf, size_t count,
+                        [[maybe_unused]] off_t &pos) {
+  ssize_t ret;
+  while ((ret = ::read(_rfd, buf, count)) < 0 && _wait(ofile, _rline, POLLIN));
+
+  return ret < 0 ? -errno : ret;
+}
+
+ssize_t PosixFile::write(OFile &ofile, const char *buf, size_t count,
+                         [[maybe_unused]] off_t &pos) {
+  if (ofile.flags & FAPPEND) ::lseek(_wfd, 0, SEEK_END);
+
+  ssize_t ret;
+  while ((ret = ::write(_wfd, buf, count)) < 0 &&
+         _wait(ofile, _wline, POLLOUT));
+
+  return ret < 0 ? -errno : ret;
+}
+
+__poll_t PosixFile::poll(OFile &ofile) {
+  pollfd fds[] = {{_rfd, POLLIN, 0}, {_wfd, POLLOUT, 0}};
+  ::poll(fds, 2, 0);
+
+  __poll_t mask = 0;
+  if (ofile.mode & FREAD) {
+    if (fds[0].revents & POLLIN) mask |= EPOLLIN | EPOLLRDNORM;
+    if (fds[0].revents & POLLHUP) mask |= EPOLLHUP;
+    if (fds[0].revents & POLLERR) mask |= EPOLLERR;
+
+    /* Edge-triggered lines: only what is not ready can raise them */
+    core::sim::arm(_rline, (fds[0].revents & POLLIN) ? 0 : POLLIN);
+  }
+  if (ofile.mode & FWRITE) {
+    if (fds[1].revents & POLLOUT) mask |= EPOLLOUT | EPOLLWRNORM;
+    if (fds[1].revents & POLLERR) mask |= EPOLLERR;
+
+    core::sim::arm(_wline, (fds[1].revents & POLLOUT) ? 0 : POLLOUT);
+  }
+  return mask;
+}
+
+ssize_t PosixFile::mmap(OFile &ofile, int prot, void *&addr) {
+  struct stat st;
+  if (::fstat(_rfd, &st) < 0) return -errno;
+  if (!S_ISREG(st.st_mode)) return -ENODEV;
+
+  /* Nothing to map */
+  addr = nullptr;
+  if (!st.st_size) return 0;
+
+  /* The open file's mapping, unless the file was resized since */
+  const size_t len = st.st_size;
+  for (const auto &map : _maps) {
+    if (map.ofile == &ofile && map.len == len && (map.prot & prot) == prot) {
+      addr = map.addr;
+      return len;
+    }
+  }
+
+  const auto map = ::mmap(nullptr, len, prot, MAP_SHARED, _rfd, 0);
+  if (map == MAP_FAILED) return -errno;
+
+  _maps.push_back({&ofile, map, len, prot});
+  addr = map;
+  return len;
+}
+
+void PosixFile::_isr(void *ctx) { static_cast<PosixFile *>(ctx)->notify(); }
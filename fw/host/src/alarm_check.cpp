@@ -0,0 +1,325 @@
+/**
+ * @file     alarm_check.cpp
+ * @author   Fabio Scatozza <s315216@studenti.polito.it>
+ * @date     18.10.2026
+ *
+ * Runs HwAlarm, as instantiated by the firmware, on an emulated TIM9: checks
+ * the channel alarm, the virtual alarms multiplexed on the other channel
+ * (firing order, cancellation, CHANNELS_BUSY), that delay() sleeps while
+ * they are served, and the extension of the counter behind ticks() and
+ * SteadyClock. Then, on TIM5, thousands of virtual alarms armed and cancelled
+ * at random, checking the heap after each operation.
+ *
+ * usage: alarm_check [seed]
+ */
+
+#include <stdlib.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "Check.h"
+#include "HwAlarm.hpp"
+#include "TimSim.h"
+
+namespace {
+
+using namespace std::chrono_literals;
+using Clock = std::chrono::steady_clock;
+using HwAlarmType = HwAlarm<TIM9_BASE, 16>;
+using MilliSeconds = HwAlarmType::MilliSeconds;
+
+/* As the firmware, ticking at 64 kHz */
+constexpr auto TICK = 15625ns;
+
+/* A heap of thousands, on a timer of its own, whose tick is a whole number of
+ * timer clocks: delays of k ticks are exactly k */
+constexpr size_t NMAX_HEAP = 4096;
+using HeapAlarmType = HwAlarm<TIM5_BASE, NMAX_HEAP>;
+constexpr auto HEAP_TICK = 12500ns;
+
+using check::elapsedMs;
+using check::failures;
+
+/*
+ * Serve the alarms until done() or the timeout. The host may run the handler
+ * later than a period: the channel alarm then fires again past a wrap of the
+ * counter, after 1 s at most, as on target
+ */
+template <typename Fn>
+void waitFor(Fn &&done, int64_t ms = 3000) {
+  const auto start = Clock::now();
+  while (!done() && elapsedMs(start) < ms) __WFI();
+}
+
+struct Counter {
+  Counter() : cb(this, &Counter::fire) {}
+  void fire() { ++n; }
+
+  MemFnCallback<Counter, void()> cb;
+  uint32_t n = 0;
+};
+
+struct Probe {
+  Probe() : cb(this, &Probe::fire), va(&cb) {}
+  void fire() { fired->push_back(this); }
+
+  MemFnCallback<Probe, void()> cb;
+  HwAlarmType::VirtualAlarm va;
+  std::vector<const Probe *> *fired = nullptr;
+  uint32_t ms = 0;
+};
+
+/* TIM9 has two channels: one for the channel alarms, one multiplexing */
+void checkChannel(HwAlarmType &alarm) {
+  Counter a, b;
+
+  CHECK(alarm.setAlarm(0ns, &a.cb) == HwAlarmType::INVALID_DELAY);
+  CHECK(alarm.setAlarm(alarm.maxDelay() + 1ms, &a.cb) ==
+        HwAlarmType::INVALID_DELAY);
+
+  CHECK(alarm.setAlarm(MilliSeconds(2), &a.cb, 2) == HwAlarmType::STARTED);
+  CHECK(alarm.setAlarm(MilliSeconds(1), &b.cb) == HwAlarmType::CHANNELS_BUSY);
+  CHECK(alarm.setAlarm(&b.cb, 0) == HwAlarmType::INVALID_CALLBACK);
+
+  const auto t0 = Clock::now();
+  waitFor([&] { return a.n == 2; });
+  CHECK(a.n == 2 && elapsedMs(t0) >= 4);
+
+  /* Released after the last repetition */
+  CHECK(alarm.setAlarm(MilliSeconds(1), &b.cb) == HwAlarmType::STARTED);
+  CHECK(alarm.setAlarm(&b.cb, 0) == HwAlarmType::STOPPED);
+  CHECK(alarm.setAlarm(MilliSeconds(10), &a.cb, 0) == HwAlarmType::STARTED);
+  waitFor([&] { return a.n == 5; });
+  CHECK(alarm.setAlarm(&a.cb, 0) == HwAlarmType::STOPPED);
+  CHECK(a.n == 5 && !b.n);
+}
+
+void checkVirtualAlarm(HwAlarmType &alarm) {
+  std::vector<const Probe *> fired;
+  std::vector<Probe> probes(16);
+
+  /* The first one is periodic, thrice */
+  for (size_t i = 0; i < probes.size(); ++i) {
+    probes[i].fired = &fired;
+    probes[i].ms = 1 + (i * 7919) % 40;
+    CHECK(alarm.setAlarm(MilliSeconds(probes[i].ms), probes[i].va,
+                         i ? 1 : 3) == HwAlarmType::STARTED);
+  }
+  Probe extra;
+  CHECK(alarm.setAlarm(MilliSeconds(1), extra.va) ==
+        HwAlarmType::CHANNELS_BUSY);
+
+  size_t expected = 3;
+  for (size_t i = 1; i < probes.size(); ++i) {
+    if (i % 3)
+      ++expected;
+    else
+      CHECK(alarm.setAlarm(probes[i].va, 0) == HwAlarmType::STOPPED);
+  }
+  CHECK(alarm.setAlarm(probes[3].va, 0) == HwAlarmType::INVALID_CALLBACK);
+
+  waitFor([&] { return fired.size() >= expected; });
+  CHECK(fired.size() == expected);
+
+  uint32_t last = 0;
+  for (const auto p : fired) {
+    const auto i = p - probes.data();
+    CHECK(i % 3 || !i);
+    if (!i) continue;
+
+    CHECK(p->ms >= last);
+    last = p->ms;
+  }
+
+  /* A delay sleeps, while the other alarms are served. It is rounded to the
+   * tick, from a counter that may be about to increment. It spins the wake-up
+   * cost calibrated at init(), inflated by any host hiccup meanwhile: long
+   * enough to sleep anyway */
+  fired.clear();
+  CHECK(alarm.setAlarm(MilliSeconds(5), probes[0].va) == HwAlarmType::STARTED);
+  const auto t0 = Clock::now();
+  alarm.delay(MilliSeconds(100));
+  const auto elapsed = Clock::now() - t0;
+  CHECK(elapsed >= 100ms - 2 * TICK);
+  CHECK(fired.size() == 1);
+
+  /* Not left linked, past the lifetime of the probes */
+  CHECK(alarm.setAlarm(probes[0].va, 0) == HwAlarmType::INVALID_CALLBACK);
+}
+
+/*
+ * The counter is extended by the overflow ISR, which is only served within
+ * __WFI(): ticks() reads a pending overflow past it in the meantime. The
+ * counter is moved close to the overflow, stopped not to race with it
+ */
+void checkTicks() {
+  constexpr uint32_t nwraps = 8;
+  constexpr uint32_t near_top = 0xFFF0;
+  const auto tim = reinterpret_cast<TIM_TypeDef *>(TIM9_BASE);
+
+  const auto t0 = HwAlarmType::ticks();
+  auto last = t0;
+  bool monotonic = true;
+
+  for (uint32_t i = 0; i < nwraps; ++i) {
+    tim->CR1 &= ~TIM_CR1_CEN;
+    if (tim->CNT < near_top) tim->CNT = near_top;
+    tim->CR1 |= TIM_CR1_CEN;
+
+    /* pending, for the next 16 ticks at most, then handled */
+    const auto start = Clock::now();
+    const auto wraps = HwAlarmType::ticks() >> 16;
+    while (HwAlarmType::ticks() >> 16 == wraps && elapsedMs(start) < 100) {
+      const auto t = HwAlarmType::ticks();
+      monotonic &= t >= last;
+      last = t;
+    }
+    __WFI();
+    const auto t = HwAlarmType::ticks();
+    monotonic &= t >= last;
+    last = t;
+  }
+
+  CHECK(monotonic);
+  CHECK((last >> 16) - (t0 >> 16) == nwraps);
+}
+
+/* The steady clock follows the counter, bracketed by the host clock */
+void checkSteadyClock(HwAlarmType &alarm) {
+  using Steady = HwAlarmType::SteadyClock;
+
+  const auto h0 = Clock::now();
+  const auto s0 = Steady::now();
+  const auto h1 = Clock::now();
+  waitFor([&] { return false; }, 50);
+  const auto h2 = Clock::now();
+  const auto s1 = Steady::now();
+  const auto h3 = Clock::now();
+
+  CHECK(s1 - s0 >= h2 - h1 - 2 * TICK);
+  CHECK(s1 - s0 <= h3 - h0 + 2 * TICK);
+
+  /* Not while virtual alarms are running: their deadlines are in ticks */
+  Probe probe;
+  std::vector<const Probe *> fired;
+  probe.fired = &fired;
+  CHECK(alarm.setAlarm(MilliSeconds(10), probe.va) == HwAlarmType::STARTED);
+  CHECK(!alarm.setResolution(2 * TICK));
+  waitFor([&] { return !fired.empty(); });
+  CHECK(fired.size() == 1);
+
+  /* And continues across a change of resolution */
+  const auto s2 = Steady::now();
+  CHECK(alarm.setResolution(2 * TICK));
+  const auto s3 = Steady::now();
+  CHECK(alarm.setResolution(TICK));
+  const auto s4 = Steady::now();
+  CHECK(s2 <= s3 && s3 <= s4);
+  CHECK(s4 - s2 < 100ms);
+}
+
+/*
+ * Arm NMAX_HEAP alarms with random delays, cancel a random half, then check
+ * that the others fire in deadline order. A deadline is known within the
+ * ticks() read before and after arming
+ */
+void checkVirtualHeap(HeapAlarmType &alarm, uint64_t seed) {
+  struct HeapProbe {
+    HeapProbe() : cb(this, &HeapProbe::fire), va(&cb) {}
+    void fire() {
+      fired->push_back(this);
+      *valid &= alarm->checkVirtual();
+    }
+
+    MemFnCallback<HeapProbe, void()> cb;
+    HeapAlarmType::VirtualAlarm va;
+    std::vector<const HeapProbe *> *fired;
+    const HeapAlarmType *alarm;
+    bool *valid;
+    uint64_t lo, hi;
+    bool cancelled = false;
+  };
+
+  std::mt19937_64 rng(seed);
+  std::vector<const HeapProbe *> fired;
+  std::vector<HeapProbe> probes(NMAX_HEAP);
+  bool valid = true;
+  fired.reserve(probes.size());
+
+  for (auto &p : probes) {
+    const auto k = 1 + rng() % 4000;
+    p.fired = &fired;
+    p.alarm = &alarm;
+    p.valid = &valid;
+
+    p.lo = HeapAlarmType::ticks() + k;
+    CHECK(alarm.setAlarm(k * HEAP_TICK, p.va) == HeapAlarmType::STARTED);
+    p.hi = HeapAlarmType::ticks() + k;
+    valid &= alarm.checkVirtual();
+  }
+  HeapProbe extra;
+  CHECK(alarm.setAlarm(HEAP_TICK, extra.va) == HeapAlarmType::CHANNELS_BUSY);
+
+  std::vector<HeapProbe *> order;
+  for (auto &p : probes) order.push_back(&p);
+  std::shuffle(order.begin(), order.end(), rng);
+  order.resize(order.size() / 2);
+
+  for (const auto p : order) {
+    CHECK(alarm.setAlarm(p->va, 0) == HeapAlarmType::STOPPED);
+    p->cancelled = true;
+    valid &= alarm.checkVirtual();
+  }
+
+  const auto expected = probes.size() - order.size();
+  waitFor([&] { return fired.size() >= expected; });
+  CHECK(fired.size() == expected);
+  CHECK(valid);
+
+  bool in_order = true;
+  bool cancelled = false;
+  const HeapProbe *last = nullptr;
+  for (const auto p : fired) {
+    cancelled |= p->cancelled;
+    if (last) in_order &= last->lo <= p->hi;
+    last = p;
+  }
+  CHECK(in_order);
+  CHECK(!cancelled);
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  const uint64_t seed = argc > 1 ? strtoull(argv[1], nullptr, 0) : 1;
+  static HwAlarmType alarm;
+  static HeapAlarmType heap_alarm;
+
+  tim::sim::attach(TIM9_BASE);
+  core::sim::attachIrq(
+      TIM1_BRK_TIM9_IRQn,
+      [](void *ctx) { static_cast<HwAlarmType *>(ctx)->handler(); }, &alarm);
+
+  CHECK(alarm.init(TICK));
+  checkChannel(alarm);
+  checkVirtualAlarm(alarm);
+  checkTicks();
+  checkSteadyClock(alarm);
+
+  tim::sim::attach(TIM5_BASE);
+  core::sim::attachIrq(
+      TIM5_IRQn,
+      [](void *ctx) { static_cast<HeapAlarmType *>(ctx)->handler(); },
+      &heap_alarm);
+
+  CHECK(heap_alarm.init(HEAP_TICK));
+  checkVirtualHeap(heap_alarm, seed);
+
+  printf("%" PRIu64 " failures\n", failures.load());
+  return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,181 @@
+/**
+ * @file     core.cpp
+ * @author   Fabio Scatozza <s315216@studenti.polito.it>
+ * @date     18.10.2026
+ *
+ * Host implementation of the core emulator, over ppoll(2)
+ */
+
+#include "CoreSim.h"
+#include "stm32f4xx.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <utility>
+#include <vector>
+
+#include <sys/poll.h>
+
+uint32_t SystemCoreClock = 84'000'000U;
+CoreDebug_Type Host_CoreDebug;
+
+namespace {
+
+struct Line {
+  int fd;
+  core::sim::Isr isr;
+  void *ctx;
+  short armed;
+};
+
+struct Timer {
+  core::sim::Clock::time_point deadline;
+  core::sim::Isr isr;
+  void *ctx;
+};
+
+struct Irq {
+  core::sim::Isr isr;
+  void *ctx;
+  bool enabled;
+  bool high;
+};
+
+struct Core {
+  std::vector<Line> lines;
+  std::vector<Timer> timers;
+  std::vector<Irq> irqs;
+  uint32_t ipsr = 0;
+  core::sim::Clock::time_point boot = core::sim::Clock::now();
+};
+Core core_;
+DWT_Type dwt_;
+
+Irq &irq(int irqn) {
+  if (core_.irqs.size() <= static_cast<size_t>(irqn))
+    core_.irqs.resize(irqn + 1);
+  return core_.irqs.at(irqn);
+}
+
+/* The first line that is high and enabled, as by priority */
+bool serveIrq() {
+  for (size_t n = 0; n < core_.irqs.size(); ++n) {
+    const auto l = core_.irqs[n]; /* The handler may attach more */
+    if (!l.isr || !l.enabled || !l.high) continue;
+
+    const auto ipsr = std::exchange(core_.ipsr, 16 + n);
+    l.isr(l.ctx);
+    core_.ipsr = ipsr;
+    return true;
+  }
+  return false;
+}
+
+} // namespace
+
+namespace core::sim {
+
+int attach(int fd, Isr isr, void *ctx) {
+  auto it = std::find_if(core_.lines.begin(), core_.lines.end(),
+                         [](const Line &l) { return !l.isr; });
+  if (it == core_.lines.end()) it = core_.lines.emplace(core_.lines.end());
+
+  *it = {fd, isr, ctx, 0};
+  return std::distance(core_.lines.begin(), it);
+}
+
+void detach(int line) { core_.lines.at(line) = {-1, nullptr, nullptr, 0}; }
+
+void arm(int line, short events) { core_.lines.at(line).armed = events; }
+
+void setTimer(Clock::time_point deadline, Isr isr, void *ctx) {
+  clearTimer(ctx);
+  core_.timers.push_back({deadline, isr, ctx});
+}
+
+void clearTimer(void *ctx) {
+  std::erase_if(core_.timers, [ctx](const Timer &t) { return t.ctx == ctx; });
+}
+
+void attachIrq(int irqn, Isr isr, void *ctx) {
+  auto &l = irq(irqn);
+  l.isr = isr;
+  l.ctx = ctx;
+}
+
+void enableIrq(int irqn, bool enable) { irq(irqn).enabled = enable; }
+
+void setIrqLevel(int irqn, bool high) { irq(irqn).high = high; }
+
+void wfi() {
+  /* Already pending: WFI returns at once */
+  if (serveIrq()) return;
+
+  std::vector<pollfd> fds;
+  std::vector<int> ids;
+  for (size_t i = 0; i < core_.lines.size(); ++i) {
+    if (core_.lines[i].isr && core_.lines[i].armed) {
+      fds.push_back({core_.lines[i].fd, core_.lines[i].armed, 0});
+      ids.push_back(i);
+    }
+  }
+
+  const auto next = std::min_element(
+      core_.timers.begin(), core_.timers.end(),
+      [](const Timer &a, const Timer &b) { return a.deadline < b.deadline; });
+
+  if (fds.empty() && next == core_.timers.end()) {
+    fputs("core::sim: WFI without any interrupt source\n", stderr);
+    abort();
+  }
+
+  timespec ts{};
+  if (next != core_.timers.end()) {
+    const auto dt = std::max(next->deadline - Clock::now(), Clock::duration{});
+    const auto ns =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(dt).count();
+    ts = {static_cast<time_t>(ns / 1'000'000'000),
+          static_cast<long>(ns % 1'000'000'000)};
+  }
+
+  ppoll(fds.data(), fds.size(),
+        next != core_.timers.end() ? &ts : nullptr, nullptr);
+
+  /* Handlers may arm or clear timers: collect the expired ones first */
+  const auto now = Clock::now();
+  std::vector<Timer> expired;
+  std::erase_if(core_.timers, [&](const Timer &t) {
+    if (t.deadline > now) return false;
+    expired.push_back(t);
+    return true;
+  });
+  for (const auto &t : expired) t.isr(t.ctx);
+
+  for (size_t i = 0; i < fds.size(); ++i) {
+    auto &l = core_.lines[ids[i]];
+    if (!fds[i].revents || !l.isr) continue;
+
+    l.armed = 0;
+    l.isr(l.ctx);
+  }
+
+  /* Raised by the peripherals meanwhile */
+  serveIrq();
+}
+
+uint32_t ipsr() { return core_.ipsr; }
+
+uint32_t cycles() {
+  const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                      Clock::now() - core_.boot)
+                      .count();
+  return static_cast<uint64_t>(ns) * SystemCoreClock / 1'000'000'000U;
+}
+
+} // namespace core::sim
+
+DWT_Type *Host_Dwt() {
+  if (dwt_.CTRL & DWT_CTRL_CYCCNTENA_Msk) dwt_.CYCCNT = core::sim::cycles();
+  return &dwt_;
+}
@@ -0,0 +1,228 @@
+/**
+ * @file     flash.cpp
+ * @author   Fabio Scatozza <s315216@studenti.polito.it>
+ * @date     18.10.2026
+ *
+ * Host implementation of the flash interface over an emulated array
+ */
+
+#include "flash.h"
+#include "FlashSim.h"
+
+#include <algorithm>
+#include <random>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+FLASH_TypeDef Host_Flash;
+
+namespace {
+
+/* Typical times from the STM32F401xE datasheet, at 2.7-3.6 V */
+constexpr uint64_t Program_us = 16;
+
+uint64_t eraseTime_us(size_t sec_size, flash::PSize p) {
+  /* x8, x16, x32 (x64 needs an external VPP: timed as x32) */
+  constexpr uint64_t t16k[] = {400'000, 300'000, 250'000, 250'000};
+  constexpr uint64_t t64k[] = {1'200'000, 700'000, 550'000, 550'000};
+  constexpr uint64_t t128k[] = {2'000'000, 1'300'000, 1'000'000, 1'000'000};
+
+  const auto i = static_cast<size_t>(p);
+  if (sec_size <= (0x1UL << 14)) return t16k[i];
+  if (sec_size <= (0x1UL << 16)) return t64k[i];
+  return t128k[i];
+}
+
+struct Device {
+  uint8_t *rw = nullptr; /* Writable alias of the read-only mapping */
+  std::mt19937_64 rng;
+  uint64_t cut_in = 0;
+  uint64_t now_us = 0;
+  flash::sim::Stats stats{};
+};
+Device dev;
+
+flash::PSize psize() {
+  return static_cast<flash::PSize>((FLASH->CR & FLASH_CR_PSIZE) >>
+                                   FLASH_CR_PSIZE_Pos);
+}
+
+/* Count a step toward the armed power cut */
+bool cutNow() {
+  return dev.cut_in && !--dev.cut_in;
+}
+
+[[noreturn]] void powerCut(uintptr_t addr, bool erase) {
+  flash::sim::reset();
+  throw flash::sim::PowerCut{addr, erase};
+}
+
+void eraseRange(uintptr_t base, size_t size) {
+  const auto off = base - flash::sim::Base_Addr;
+  const auto t = eraseTime_us(size, psize());
+
+  ++dev.stats.erases;
+
+  if (cutNow()) {
+    /* Erasure proceeds word by word: a random prefix is erased */
+    const auto n_words = std::uniform_int_distribution<size_t>(
+        0, size / 4 - 1)(dev.rng);
+    std::fill_n(dev.rw + off, n_words * 4, 0xFF);
+    dev.now_us += t * n_words / (size / 4);
+    powerCut(base, true);
+  }
+
+  std::fill_n(dev.rw + off, size, 0xFF);
+  dev.now_us += t;
+}
+
+} // namespace
+
+namespace flash {
+
+bool isBusy() { return FLASH->SR & FLASH_SR_BSY; }
+
+bool isActive(const Flag &f, bool clear) {
+  const bool tmp = FLASH->SR & f;
+  if (clear)
+    FLASH->SR &= ~f;
+  return tmp;
+}
+bool isEnabledIt(const It &it) { return FLASH->CR & it; }
+bool isLocked() { return FLASH->CR & FLASH_CR_LOCK; }
+
+bool unlock() {
+  FLASH->CR &= ~FLASH_CR_LOCK;
+  return true;
+}
+void lock() { FLASH->CR |= FLASH_CR_LOCK; }
+
+void enableIt(const It &it) { FLASH->CR |= it; }
+void disableIt(const It &it) { FLASH->CR &= ~it; }
+
+void setSector(const Sector &s) {
+  FLASH->CR &= ~FLASH_CR_SNB;
+  FLASH->CR |= static_cast<uint32_t>(s) << FLASH_CR_SNB_Pos;
+}
+
+void setOperation(const Op &op) {
+  clearOperation();
+  FLASH->CR |= static_cast<uint32_t>(op);
+}
+
+void startErase() {
+  if (isLocked()) {
+    FLASH->SR |= FLASH_SR_PGSERR;
+    ++dev.stats.errors;
+    return;
+  }
+
+  if (FLASH->CR & FLASH_CR_MER) {
+    for (auto s = 0U; s <= static_cast<uint32_t>(Sector::S7); ++s)
+      eraseRange(getBaseAddr(static_cast<Sector>(s)),
+                 getSize(static_cast<Sector>(s)));
+  } else if (FLASH->CR & FLASH_CR_SER) {
+    const auto s = static_cast<Sector>((FLASH->CR & FLASH_CR_SNB) >>
+                                       FLASH_CR_SNB_Pos);
+    eraseRange(getBaseAddr(s), getSize(s));
+  } else {
+    FLASH->SR |= FLASH_SR_PGSERR;
+    ++dev.stats.errors;
+    return;
+  }
+
+  FLASH->SR |= FLASH_SR_EOP;
+}
+
+void clearOperation() {
+  FLASH->CR &= ~(FLASH_CR_MER | FLASH_CR_SER | FLASH_CR_PG);
+}
+
+void programAt(uintptr_t addr, uint32_t data, size_t size) {
+  constexpr size_t psize_bytes[] = {1, 2, 4, 8};
+
+  uint32_t err = 0;
+  if (addr < sim::Base_Addr || addr + size > sim::Base_Addr + sim::Size)
+    err = FLASH_SR_PGSERR;
+  else if (isLocked() || !(FLASH->CR & FLASH_CR_PG))
+    err = FLASH_SR_PGSERR;
+  else if (size != psize_bytes[static_cast<size_t>(psize())])
+    err = FLASH_SR_PGPERR;
+  else if (addr % size)
+    err = FLASH_SR_PGAERR;
+
+  if (err) {
+    FLASH->SR |= err;
+    ++dev.stats.errors;
+    return;
+  }
+
+  auto *p = dev.rw + (addr - sim::Base_Addr);
+  ++dev.stats.programs;
+
+  for (size_t i = 0; i < size; ++i) {
+    const auto b = static_cast<uint8_t>(data >> (8 * i));
+    if (b & ~p[i]) ++dev.stats.violations;
+  }
+
+  if (cutNow()) {
+    /* Each bit being cleared may or may not have been programmed */
+    for (size_t i = 0; i < size; ++i) {
+      const auto b = static_cast<uint8_t>(data >> (8 * i));
+      const auto mask = static_cast<uint8_t>(dev.rng());
+      p[i] &= b | mask;
+    }
+    dev.now_us += Program_us / 2;
+    powerCut(addr, false);
+  }
+
+  for (size_t i = 0; i < size; ++i)
+    p[i] &= static_cast<uint8_t>(data >> (8 * i));
+
+  dev.now_us += Program_us;
+  FLASH->SR |= FLASH_SR_EOP;
+}
+
+namespace sim {
+
+bool init(uint64_t seed) {
+  dev.rng.seed(seed);
+
+  if (!dev.rw) {
+    const int fd = memfd_create("flash", 0);
+    if (fd < 0 || ftruncate(fd, Size)) return false;
+
+    void *ro = mmap(reinterpret_cast<void *>(Base_Addr), Size, PROT_READ,
+                    MAP_SHARED | MAP_FIXED_NOREPLACE, fd, 0);
+    void *rw = mmap(nullptr, Size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+
+    if (ro != reinterpret_cast<void *>(Base_Addr) || rw == MAP_FAILED)
+      return false;
+
+    dev.rw = static_cast<uint8_t *>(rw);
+  }
+
+  std::fill_n(dev.rw, Size, 0xFF);
+  dev.cut_in = 0;
+  dev.now_us = 0;
+  dev.stats = {};
+  reset();
+  return true;
+}
+
+void reset() {
+  FLASH->SR = 0;
+  FLASH->CR = FLASH_CR_LOCK;
+}
+
+void armPowerCut(uint64_t n) { dev.cut_in = n; }
+bool isArmed() { return dev.cut_in; }
+
+uint64_t now_us() { return dev.now_us; }
+const Stats &stats() { return dev.stats; }
+
+} // namespace sim
+
+} // namespace flash
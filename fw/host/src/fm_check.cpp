@@ -0,0 +1,526 @@
+/**
+ * @file     fm_check.cpp
+ * @author   Fabio Scatozza <s315216@studenti.polito.it>
+ * @date     18.10.2026
+ *
+ * Runs the FileManager system calls against nodes backed by a host pipe
+ * (looped back), a temporary file and a pseudo-terminal, whose other side is
+ * driven by a host thread. Checks their conformance to the POSIX error
+ * semantics (fd exhaustion, EBADF, EAGAIN, timeouts and wake-ups), the
+ * anonymous pipes, fmap(), the I/O ring and the virtual alarms the timeouts
+ * run on, then compares the cost of open/close, read and select with the host
+ * ones.
+ *
+ * usage: fm_check [iterations]
+ */
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/select.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "Check.h"
+#include "FileManager.hpp"
+#include "HwAlarm.h"
+#include "PosixFile.h"
+#include "dwt.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+using FileManagerType =
+    FileManager<HwAlarm, NodeDrivers<Node<"pipe", PosixFile>,
+                                     Node<"file", PosixFile>,
+                                     Node<"pty", PosixFile>>>;
+
+constexpr int NMAX_FD = NRESERVED_FD + 3 + NMAX_EPOLL + 2 * NMAX_PIPE;
+
+/* From the writer threads as well */
+using check::elapsedMs;
+using check::failures;
+
+/* Write to the slave side of the pty, after a delay */
+std::thread writeLater(int fd, const char *s, std::chrono::milliseconds t) {
+  return std::thread([=] {
+    std::this_thread::sleep_for(t);
+    CHECK(::write(fd, s, strlen(s)) == static_cast<ssize_t>(strlen(s)));
+  });
+}
+
+void checkOpen(FileManagerType &fm) {
+  CHECK(fm.open("none", O_RDONLY) == -ENOENT);
+  CHECK(fm.open("pipe", O_RDONLY | O_SYNC) == -EINVAL);
+
+  /* Exhaustion: every fd past the reserved ones, then EMFILE */
+  int fds[NMAX_FD];
+  int n = 0;
+  for (int fd; n < NMAX_FD && (fd = fm.open("file", O_RDONLY)) >= 0; ++n)
+    fds[n] = fd;
+
+  CHECK(n == NMAX_FD - NRESERVED_FD);
+  CHECK(fm.open("file", O_RDONLY) == -EMFILE);
+  CHECK(fm.epollCreate(0) == -EMFILE);
+  int pfds[2];
+  CHECK(fm.pipe(pfds) == -EMFILE);
+
+  for (int i = 0; i < n; ++i) CHECK(fm.close(fds[i]) == 0);
+  CHECK(fm.open("file", O_RDONLY) == NRESERVED_FD);
+  CHECK(fm.close(NRESERVED_FD) == 0);
+}
+
+void checkBadFd(FileManagerType &fm) {
+  char c = 0;
+
+  for (const auto fd : {-1, NRESERVED_FD, NMAX_FD}) {
+    CHECK(fm.close(fd) == -EBADF);
+    CHECK(fm.read(fd, &c, 1) == -EBADF);
+    CHECK(fm.write(fd, &c, 1) == -EBADF);
+    CHECK(fm.lseek(fd, 0, SEEK_SET) == -EBADF);
+  }
+
+  /* Access mode */
+  const auto rd = fm.open("pipe", O_RDONLY);
+  const auto wr = fm.open("pipe", O_WRONLY);
+  CHECK(fm.write(rd, &c, 1) == -EBADF);
+  CHECK(fm.read(wr, &c, 1) == -EBADF);
+
+  fd_set set;
+  FD_ZERO(&set);
+  FD_SET(NMAX_FD - 1, &set);
+  timeval tv{};
+  CHECK(fm.select(NMAX_FD, &set, nullptr, nullptr, &tv) == -EBADF);
+
+  fm.close(rd);
+  fm.close(wr);
+}
+
+void checkPipe(FileManagerType &fm) {
+  char buf[16];
+  const auto rd = fm.open("pipe", O_RDONLY | O_NONBLOCK);
+  const auto wr = fm.open("pipe", O_WRONLY);
+
+  CHECK(fm.read(rd, buf, sizeof(buf)) == -EAGAIN);
+  CHECK(fm.write(wr, "ping", 4) == 4);
+  CHECK(fm.read(rd, buf, sizeof(buf)) == 4 && !memcmp(buf, "ping", 4));
+
+  /* Vectored, across segment boundaries */
+  iovec wv[] = {{const_cast<char *>("ab"), 2}, {nullptr, 0},
+                {const_cast<char *>("cde"), 3}};
+  CHECK(fm.writev(wr, wv, 3) == 5);
+  iovec rv[] = {{buf, 1}, {buf + 1, 3}, {buf + 4, 8}};
+  CHECK(fm.readv(rd, rv, 3) == 5 && !memcmp(buf, "abcde", 5));
+  CHECK(fm.readv(rd, rv, -1) == -EINVAL);
+
+  fm.close(rd);
+  fm.close(wr);
+}
+
+/* Anonymous pipes, not to be confused with the "pipe" node */
+void checkAnonPipe(FileManagerType &fm) {
+  char buf[PIPE_SIZE];
+  int fds[2];
+  CHECK(fm.pipe(fds, O_APPEND) == -EINVAL);
+  CHECK(fm.pipe(fds, O_NONBLOCK) == 0);
+  const auto [rd, wr] = fds;
+
+  struct stat st;
+  CHECK(fm.fstat(rd, &st) == 0 && S_ISFIFO(st.st_mode));
+  CHECK(fm.lseek(rd, 0, SEEK_SET) == -ESPIPE);
+  CHECK(fm.write(rd, "x", 1) == -EBADF);
+  CHECK(fm.read(rd, buf, 1) == -EAGAIN);
+
+  /* Non-blocking writes that fit are all-or-nothing */
+  memset(buf, 'a', sizeof(buf));
+  CHECK(fm.write(wr, buf, PIPE_SIZE - 2) == PIPE_SIZE - 2);
+  CHECK(fm.write(wr, "xyz", 3) == -EAGAIN);
+  CHECK(fm.read(rd, buf, PIPE_SIZE - 4) == PIPE_SIZE - 4);
+
+  /* Wrapping around */
+  CHECK(fm.write(wr, "wxyz", 4) == 4);
+  CHECK(fm.read(rd, buf, sizeof(buf)) == 6 && !memcmp(buf, "aawxyz", 6));
+
+  /* Zero-copy, with the data read back in one copy */
+  void *loan = nullptr;
+  CHECK(fm.writeBufAcquire(wr, &loan, sizeof(buf)) == PIPE_SIZE);
+  memcpy(loan, "loan", 4);
+  CHECK(fm.writeBufCommit(wr, 4) == 4);
+  CHECK(fm.writeBufCommit(wr, 4) == -EINVAL);
+
+  fd_set in, out;
+  FD_ZERO(&in);
+  FD_ZERO(&out);
+  FD_SET(rd, &in);
+  FD_SET(wr, &out);
+  timeval tv{};
+  CHECK(fm.select(wr + 1, &in, &out, nullptr, &tv) == 2);
+  CHECK(fm.read(rd, buf, sizeof(buf)) == 4 && !memcmp(buf, "loan", 4));
+
+  /* Hang-up: end of file once drained */
+  CHECK(fm.write(wr, "eof", 3) == 3);
+  CHECK(fm.close(wr) == 0);
+  CHECK(fm.read(rd, buf, sizeof(buf)) == 3);
+  CHECK(fm.read(rd, buf, sizeof(buf)) == 0);
+  CHECK(fm.close(rd) == 0);
+
+  /* Broken pipe, and the pipes in use */
+  int more[2];
+  CHECK(fm.pipe(fds) == 0 && fm.pipe(more) == 0);
+  CHECK(fm.pipe(more) == -ENFILE);
+
+  /* Blocking ends would wait forever, with nobody to serve the other end */
+  char over[PIPE_SIZE + 1] = {};
+  CHECK(fm.read(more[0], buf, 1) == -EDEADLK);
+  CHECK(fm.write(more[1], over, sizeof(over)) == PIPE_SIZE);
+  CHECK(fm.write(more[1], "x", 1) == -EDEADLK);
+  CHECK(fm.writeBufAcquire(more[1], &loan, 1) == -EDEADLK);
+  CHECK(fm.read(more[0], buf, sizeof(buf)) == PIPE_SIZE);
+  CHECK(fm.close(fds[0]) == 0);
+  CHECK(fm.write(fds[1], "x", 1) == -EPIPE);
+  for (const auto fd : {fds[1], more[0], more[1]}) CHECK(fm.close(fd) == 0);
+}
+
+void checkFile(FileManagerType &fm) {
+  char buf[16];
+  const auto fd = fm.open("file", O_RDWR | O_TRUNC);
+
+  CHECK(fm.write(fd, "hello", 5) == 5);
+  CHECK(fm.lseek(fd, 1, SEEK_SET) == 1);
+  CHECK(fm.read(fd, buf, sizeof(buf)) == 4 && !memcmp(buf, "ello", 4));
+  CHECK(fm.read(fd, buf, sizeof(buf)) == 0);
+  CHECK(fm.lseek(fd, -1, SEEK_SET) == -EINVAL);
+
+  fm.close(fd);
+}
+
+/* In-place access to the file, and to the stats table if FM_STATS */
+void checkFmap(FileManagerType &fm) {
+  void *addr = nullptr;
+  const auto rd = fm.open("pipe", O_RDONLY);
+  CHECK(fm.fmap(rd, PROT_READ, &addr) == -ENODEV);
+  CHECK(fm.fmap(rd, PROT_WRITE, &addr) == -EACCES);
+  CHECK(fm.fmap(rd, PROT_EXEC, &addr) == -EINVAL);
+  CHECK(fm.fmap(rd, PROT_READ, nullptr) == -EFAULT);
+  fm.close(rd);
+
+  char buf[8];
+  const auto fd = fm.open("file", O_RDWR | O_TRUNC);
+  CHECK(fm.lseek(fd, 0, SEEK_SET) == 0); /* Shared with the other checks */
+  CHECK(fm.write(fd, "hello", 5) == 5);
+  CHECK(fm.fmap(fd, PROT_READ | PROT_WRITE, &addr) == 5 &&
+        !memcmp(addr, "hello", 5));
+
+  static_cast<char *>(addr)[0] = 'j';
+  CHECK(fm.lseek(fd, 0, SEEK_SET) == 0);
+  CHECK(fm.read(fd, buf, sizeof(buf)) == 5 && !memcmp(buf, "jello", 5));
+
+  /* One mapping per open file, unmapped on close */
+  void *again = nullptr;
+  CHECK(fm.fmap(fd, PROT_READ, &again) == 5 && again == addr);
+  fm.close(fd);
+  CHECK(::msync(addr, 5, MS_ASYNC) < 0 && errno == ENOMEM);
+
+#ifdef FM_STATS
+  fm_node_stats copy[3];
+  const auto st = fm.open("stats", O_RDONLY);
+  CHECK(fm.fmap(st, PROT_READ | PROT_WRITE, &addr) == -EACCES);
+  CHECK(fm.fmap(st, PROT_READ, &addr) == sizeof(copy));
+  CHECK(fm.read(st, copy, sizeof(copy)) == sizeof(copy));
+  CHECK(!memcmp(addr, copy, sizeof(copy)));
+  fm.close(st);
+#endif
+}
+
+void checkSelect(FileManagerType &fm, int slave) {
+  char buf[16];
+  const auto pty = fm.open("pty", O_RDWR | O_NONBLOCK);
+  const auto wr = fm.open("pipe", O_WRONLY);
+
+  fd_set rd, wrs;
+  FD_ZERO(&rd);
+  FD_SET(pty, &rd);
+  FD_ZERO(&wrs);
+  FD_SET(wr, &wrs);
+
+  /* Always writable */
+  timeval tv{};
+  CHECK(fm.select(wr + 1, nullptr, &wrs, nullptr, &tv) == 1);
+  CHECK(FD_ISSET(wr, &wrs));
+
+  /* Timeout */
+  tv = {0, 30'000};
+  auto start = Clock::now();
+  CHECK(fm.select(pty + 1, &rd, nullptr, nullptr, &tv) == 0);
+  const auto timeout_ms = elapsedMs(start);
+  CHECK(timeout_ms >= 30 && timeout_ms < 80);
+  CHECK(!FD_ISSET(pty, &rd));
+
+  /* Woken up by the node, well before the timeout */
+  FD_SET(pty, &rd);
+  tv = {5, 0};
+  start = Clock::now();
+  auto writer = writeLater(slave, "x", std::chrono::milliseconds(20));
+  CHECK(fm.select(pty + 1, &rd, nullptr, nullptr, &tv) == 1);
+  CHECK(elapsedMs(start) < 1000);
+  CHECK(FD_ISSET(pty, &rd));
+  writer.join();
+
+  CHECK(fm.read(pty, buf, sizeof(buf)) == 1 && buf[0] == 'x');
+  CHECK(fm.read(pty, buf, sizeof(buf)) == -EAGAIN);
+
+  /* Blocking read, through the core emulator */
+  const auto bpty = fm.open("pty", O_RDONLY);
+  writer = writeLater(slave, "yz", std::chrono::milliseconds(20));
+  CHECK(fm.read(bpty, buf, sizeof(buf)) == 2 && !memcmp(buf, "yz", 2));
+  writer.join();
+
+  /* Edge-triggered epoll: one event per write */
+  const auto ep = fm.epollCreate(0);
+  epoll_event ev{EPOLLIN | EPOLLET, 7};
+  CHECK(fm.epollCtl(ep, EPOLL_CTL_ADD, pty, &ev) == 0);
+  CHECK(fm.epollWait(ep, &ev, 1, 0) == 0);
+
+  writer = writeLater(slave, "w", std::chrono::milliseconds(20));
+  CHECK(fm.epollWait(ep, &ev, 1, 5000) == 1 && ev.data == 7);
+  writer.join();
+  CHECK(fm.epollWait(ep, &ev, 1, 0) == 0);
+  CHECK(fm.read(pty, buf, sizeof(buf)) == 1 && buf[0] == 'w');
+
+  /* Output towards the slave */
+  CHECK(fm.write(pty, "out", 3) == 3);
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  CHECK(::read(slave, buf, sizeof(buf)) == 3 && !memcmp(buf, "out", 3));
+
+  fm.close(ep);
+  fm.close(bpty);
+  fm.close(wr);
+  fm.close(pty);
+}
+
+void checkIoRing(FileManagerType &fm, int slave) {
+  char in[8], out[] = "ring";
+  const auto pty = fm.open("pty", O_RDONLY);
+  const auto wr = fm.open("pipe", O_WRONLY);
+  const auto rd = fm.open("pipe", O_RDONLY);
+
+  /* The read waits for the pty, the others complete at submission */
+  const io_sqe sqes[] = {
+      {IORING_OP_READ, pty, in, sizeof(in), 1},
+      {IORING_OP_WRITE, wr, out, 4, 2},
+      {IORING_OP_READ, rd, in + 4, 4, 3},
+      {IORING_OP_WRITE, -1, out, 4, 4},
+  };
+  CHECK(fm.ioSubmit(sqes, 4) == 4);
+
+  io_cqe cqes[IORING_ENTRIES];
+  CHECK(fm.ioWait(cqes, 0, IORING_ENTRIES, 0) == 3);
+  CHECK(cqes[0].user_data == 2 && cqes[0].res == 4);
+  CHECK(cqes[1].user_data == 3 && cqes[1].res == 4);
+  CHECK(cqes[2].user_data == 4 && cqes[2].res == -EBADF);
+
+  auto writer = writeLater(slave, "abcd", std::chrono::milliseconds(20));
+  CHECK(fm.ioWait(cqes, 1, IORING_ENTRIES, 5000) == 1);
+  writer.join();
+  CHECK(cqes[0].user_data == 1 && cqes[0].res == 4);
+  CHECK(!memcmp(in, "abcdring", 8));
+
+  /* Full ring, then cancelled by close() */
+  io_sqe sqe{IORING_OP_READ, pty, in, sizeof(in), 5};
+  for (auto i = 0; i < IORING_ENTRIES; ++i) CHECK(fm.ioSubmit(&sqe, 1) == 1);
+  CHECK(fm.ioSubmit(&sqe, 1) == -EBUSY);
+  CHECK(fm.ioWait(cqes, 1, IORING_ENTRIES, 30) == 0);
+
+  fm.close(pty);
+  CHECK(fm.ioWait(cqes, 1, IORING_ENTRIES, 0) == IORING_ENTRIES);
+  CHECK(cqes[0].res == -ECANCELED);
+  CHECK(fm.ioWait(cqes, 1, 1, -1) == 0); /* Nothing in flight */
+
+  fm.close(rd);
+  fm.close(wr);
+}
+
+struct Probe {
+  Probe() : cb(this, &Probe::fire), va(&cb) {}
+  void fire() { fired->push_back(this); }
+
+  MemFnCallback<Probe, void()> cb;
+  HwAlarm::VirtualAlarm va;
+  std::vector<const Probe *> *fired = nullptr;
+  uint32_t ms = 0;
+};
+
+/*
+ * A full heap fires in deadline order, and the cancelled alarms never. Then
+ * delay() sleeps
+ */
+void checkVirtualAlarm(HwAlarm &alarm) {
+  using MilliSeconds = HwAlarm::MilliSeconds;
+
+  std::vector<const Probe *> fired;
+  std::vector<Probe> probes(HwAlarm::NMAX_VIRTUAL);
+
+  /* The first one is periodic, thrice */
+  for (size_t i = 0; i < probes.size(); ++i) {
+    probes[i].fired = &fired;
+    probes[i].ms = 1 + (i * 7919) % 40;
+    CHECK(alarm.setAlarm(MilliSeconds(probes[i].ms), probes[i].va,
+                         i ? 1 : 3) == HwAlarm::STARTED);
+  }
+  Probe extra;
+  CHECK(alarm.setAlarm(MilliSeconds(1), extra.va) == HwAlarm::CHANNELS_BUSY);
+
+  size_t expected = 3;
+  for (size_t i = 1; i < probes.size(); ++i) {
+    if (i % 3)
+      ++expected;
+    else
+      CHECK(alarm.setAlarm(probes[i].va, 0) == HwAlarm::STOPPED);
+  }
+  CHECK(alarm.setAlarm(probes[3].va, 0) == HwAlarm::INVALID_CALLBACK);
+
+  const auto start = Clock::now();
+  while (fired.size() < expected && elapsedMs(start) < 1000) __WFI();
+  CHECK(fired.size() == expected);
+
+  uint32_t last = 0;
+  for (const auto p : fired) {
+    const auto i = p - probes.data();
+    CHECK(i % 3 || !i);
+    if (!i) continue;
+
+    CHECK(p->ms >= last);
+    last = p->ms;
+  }
+
+  /* A delay sleeps, while the other alarms are served */
+  fired.clear();
+  probes[0].ms = 5;
+  CHECK(alarm.setAlarm(MilliSeconds(5), probes[0].va) == HwAlarm::STARTED);
+  const auto t0 = Clock::now();
+  alarm.delay(MilliSeconds(20));
+  CHECK(elapsedMs(t0) >= 20 && fired.size() == 1);
+}
+
+/* Mean host time of fn, over n iterations */
+template <typename Fn>
+double nsPerCall(uint64_t n, Fn &&fn) {
+  const auto start = Clock::now();
+  for (uint64_t i = 0; i < n; ++i) fn();
+
+  return std::chrono::duration<double, std::nano>(Clock::now() - start)
+             .count() /
+         n;
+}
+
+void bench(FileManagerType &fm, uint64_t n) {
+  char c = 0;
+  int p[2];
+  if (::pipe(p) < 0) return;
+
+  const auto null_fd = ::open("/dev/null", O_RDONLY);
+  const auto rd = fm.open("pipe", O_RDONLY | O_NONBLOCK);
+  const auto wr = fm.open("pipe", O_WRONLY);
+
+  const auto fm_open =
+      nsPerCall(n, [&] { fm.close(fm.open("file", O_RDONLY)); });
+  const auto host_open =
+      nsPerCall(n, [&] { ::close(::open("/dev/null", O_RDONLY)); });
+
+  const auto fm_read = nsPerCall(n, [&] {
+    fm.write(wr, &c, 1);
+    fm.read(rd, &c, 1);
+  });
+  const auto host_read = nsPerCall(n, [&] {
+    ::write(p[1], &c, 1);
+    ::read(p[0], &c, 1);
+  });
+
+  fd_set set;
+  timeval tv{};
+  const auto fm_select = nsPerCall(n, [&] {
+    FD_ZERO(&set);
+    FD_SET(wr, &set);
+    fm.select(wr + 1, nullptr, &set, nullptr, &tv);
+  });
+  const auto host_select = nsPerCall(n, [&] {
+    FD_ZERO(&set);
+    FD_SET(p[1], &set);
+    ::select(p[1] + 1, nullptr, &set, nullptr, &tv);
+  });
+
+  printf("%-14s %12s %12s\n", "ns/call", "FileManager", "host");
+  printf("%-14s %12.0f %12.0f\n", "open+close", fm_open, host_open);
+  printf("%-14s %12.0f %12.0f\n", "write+read", fm_read, host_read);
+  printf("%-14s %12.0f %12.0f\n", "select", fm_select, host_select);
+
+  fm.close(wr);
+  fm.close(rd);
+  ::close(null_fd);
+  ::close(p[0]);
+  ::close(p[1]);
+}
+
+/* Raw pseudo-terminal: returns the master, slave set to the other side */
+int openPty(int &slave) {
+  const auto master = posix_openpt(O_RDWR | O_NOCTTY);
+  if (master < 0 || grantpt(master) < 0 || unlockpt(master) < 0) return -1;
+
+  slave = ::open(ptsname(master), O_RDWR | O_NOCTTY);
+  if (slave < 0) return -1;
+
+  termios t;
+  tcgetattr(slave, &t);
+  cfmakeraw(&t);
+  tcsetattr(slave, TCSANOW, &t);
+  return master;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  const uint64_t n = argc > 1 ? strtoull(argv[1], nullptr, 0) : 100'000;
+
+  int p[2];
+  char path[] = "/tmp/fm_check.XXXXXX";
+  int slave;
+  const auto tmp = mkstemp(path);
+  const auto master = openPty(slave);
+
+  if (::pipe(p) < 0 || tmp < 0 || master < 0) {
+    perror("fm_check: host files");
+    return EXIT_FAILURE;
+  }
+  unlink(path);
+
+  dwt::init();
+  HwAlarm alarm;
+  PosixFile pipe_file(p[0], p[1]), tmp_file(tmp), pty_file(master);
+  FileManagerType fm{alarm, Node<"pipe", PosixFile>{pipe_file},
+                     Node<"file", PosixFile>{tmp_file},
+                     Node<"pty", PosixFile>{pty_file}};
+
+  checkOpen(fm);
+  checkBadFd(fm);
+  checkPipe(fm);
+  checkAnonPipe(fm);
+  checkFile(fm);
+  checkFmap(fm);
+  checkSelect(fm, slave);
+  checkIoRing(fm, slave);
+  checkVirtualAlarm(alarm);
+
+  printf("%" PRIu64 " failures\n", failures.load());
+  if (n) bench(fm, n);
+
+  ::close(slave);
+  return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,172 @@
+/**
+ * @file     fmt_check.cpp
+ * @author   Fabio Scatozza <s315216@studenti.polito.it>
+ * @date     18.10.2026
+ *
+ * Formats random values with the compile-time engine and with the host
+ * snprintf, over the conversions, flags, widths and precisions in use, and
+ * checks that the outputs match, that they are truncated alike and that
+ * maxLength() bounds them. Fixed-point values are checked against their
+ * integer and fractional parts. Then compares the cost of the display line.
+ *
+ * usage: fmt_check [iterations] [seed]
+ */
+
+#include <stdlib.h>
+
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <random>
+
+#include "Check.h"
+#include "Format.hpp"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+using check::failures;
+
+/* The same format string, as a template argument and as a literal */
+#define CHECK_FORMAT(fmt_str, ...) \
+  checkFormat<fmt_str>(fmt_str, __LINE__, ##__VA_ARGS__)
+
+template <FixedString FMT, typename... Args>
+void checkFormat(const char *fmt_str, int line, const Args &...args) {
+  char ref[256];
+  char out[256];
+
+  const auto ref_len = snprintf(ref, sizeof(ref), fmt_str, args...);
+  const auto len = fmt::format<FMT>(out, sizeof(out), args...);
+
+  if (ref_len < 0 || len != static_cast<size_t>(ref_len) ||
+      memcmp(out, ref, len) || len > fmt::maxLength<FMT, Args...>()) {
+    fprintf(stderr, "line %d: \"%s\": \"%.*s\" != \"%s\"\n", line, fmt_str,
+            static_cast<int>(std::min(len, sizeof(out))), out, ref);
+    ++failures;
+    return;
+  }
+
+  /* Truncated: the whole length, and the prefix that fits */
+  const auto cap = len / 2;
+  std::fill_n(out, sizeof(out), '\0');
+  if (fmt::format<FMT>(out, cap, args...) != len || memcmp(out, ref, cap) ||
+      out[cap]) {
+    fprintf(stderr, "line %d: \"%s\" truncated to %zu\n", line, fmt_str, cap);
+    ++failures;
+  }
+}
+
+/* Scaled by 10^3, against sign, integer part and fractional part */
+void checkFixed(int32_t v, uint32_t u) {
+  char ref[48];
+  char out[48];
+
+  const auto mag = v < 0 ? -static_cast<int64_t>(v) : int64_t{v};
+  char u_ref[16];
+  snprintf(u_ref, sizeof(u_ref), "%u.%03u", u / 1000, u % 1000);
+
+  const auto ref_len =
+      snprintf(ref, sizeof(ref), "%s%" PRId64 ".%03" PRId64 "|%-8s|",
+               v < 0 ? "-" : "", mag / 1000, mag % 1000, u_ref);
+  const auto len = fmt::format<"%d|%-8u|">(out, sizeof(out), fmt::fixed<3>(v),
+                                           fmt::fixed<3>(u));
+
+  if (len != static_cast<size_t>(ref_len) || memcmp(out, ref, len)) {
+    fprintf(stderr, "fixed %" PRId32 ", %" PRIu32 ": \"%.*s\" != \"%s\"\n",
+            v, u, static_cast<int>(len), out, ref);
+    ++failures;
+  }
+}
+
+/* Mean host time of fn, over n iterations */
+template <typename Fn>
+double nsPerCall(uint64_t n, Fn &&fn) {
+  const auto start = Clock::now();
+  for (uint64_t i = 0; i < n; ++i) fn();
+
+  return std::chrono::duration<double, std::nano>(Clock::now() - start)
+             .count() /
+         n;
+}
+
+void bench(uint64_t n) {
+  char buf[64];
+  volatile unsigned idx = 7;
+  volatile int milli_rpm = 123456;
+  volatile int angle_x10 = -905;
+
+  const auto libc = nsPerCall(n, [&] {
+    snprintf(buf, sizeof(buf), "[%u] %u.%03u %d.%01d\n", idx, milli_rpm / 1000,
+             milli_rpm % 1000, angle_x10 / 10, angle_x10 % 10);
+  });
+  const auto fmt = nsPerCall(n, [&] {
+    fmt::format<"[%u] %u %d\n">(buf, sizeof(buf), idx,
+                                fmt::fixed<3>(milli_rpm),
+                                fmt::fixed<1>(angle_x10));
+  });
+
+  printf("%-14s %12s %12s\n", "ns/call", "fmt", "snprintf");
+  printf("%-14s %12.0f %12.0f\n", "display line", fmt, libc);
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  const uint64_t n = argc > 1 ? strtoull(argv[1], nullptr, 0) : 100'000;
+  const auto seed = argc > 2 ? strtoul(argv[2], nullptr, 0) : 1U;
+
+  std::mt19937_64 rng(seed);
+  const auto pick = [&rng]<typename T>(T) {
+    /* Small magnitudes as often as wide ones */
+    const auto bits = rng() % (8 * sizeof(T) + 1);
+    const auto v = bits ? rng() >> (64 - bits) : 0;
+    return static_cast<T>(v);
+  };
+
+  CHECK_FORMAT("literal only");
+  CHECK_FORMAT("%% %c%c|%5c|%-3c|", 'a', '%', 'b', 'c');
+  CHECK_FORMAT("%s|%8s|%-8s|%.2s|%5.1s|", "abc", "abc", "abc", "abc", "abc");
+  CHECK_FORMAT("%p|%12p|", static_cast<void *>(&failures),
+               static_cast<void *>(&failures));
+
+  for (uint64_t i = 0; i < n; ++i) {
+    const auto i32 = pick(int32_t{});
+    const auto u32 = pick(uint32_t{});
+    const auto i64 = pick(int64_t{});
+    const auto u64 = pick(uint64_t{});
+    const auto u8 = pick(uint8_t{});
+    const auto i16 = pick(int16_t{});
+
+    CHECK_FORMAT("[%u] %u.%03u %d.%01d\n", u32, u32 / 1000, u32 % 1000,
+                 i32 / 10, abs(i32 % 10));
+    CHECK_FORMAT("%d|%i|%5d|%-5d|%05d|%+d|% d|%.3d|%8.3d|%-+6d|", i32, i32,
+                 i32, i32, i32, i32, i32, i32, i32, i32);
+    CHECK_FORMAT("%u|%x|%X|%o|%#x|%#X|%#o|%08x|%-10u|%.0u|", u32, u32, u32,
+                 u32, u32, u32, u32, u32, u32, u32);
+    CHECK_FORMAT("%" PRId64 "|%" PRIu64 "|%" PRIx64 "|%24" PRId64 "|", i64, u64,
+                 u64, i64);
+    CHECK_FORMAT("%hhu|%02hhX|%hd|%hu|%d|%u|", u8, u8, i16, i16, i16, i16);
+    CHECK_FORMAT("%zu|%lu|%ld|", static_cast<size_t>(u64),
+                 static_cast<unsigned long>(u64), static_cast<long>(i64));
+
+    checkFixed(i32, u32);
+  }
+
+  /* Edge values */
+  for (const auto v :
+       {INT32_MIN, -1000, -999, -1, 0, 1, 999, 1000, INT32_MAX}) {
+    CHECK_FORMAT("%d|%u|%x|%.0d|%#.0o|", v, v, v, v, v);
+    checkFixed(v, static_cast<uint32_t>(v));
+  }
+
+  /* Fixed-point across the whole 32-bit range, including UINT32_MAX */
+  for (uint64_t u = 0; u <= UINT32_MAX; u += 65'537)
+    checkFixed(static_cast<int32_t>(u), static_cast<uint32_t>(u));
+
+  bench(n);
+  printf("%" PRIu64 " failures\n", failures.load());
+  return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,359 @@
+/**
+ * @file     mp_compile.cpp
+ * @author   Fabio Scatozza <s315216@studenti.polito.it>
+ * @date     18.10.2026
+ *
+ * Compiles a text pattern into the flash image of MotionPattern, to be
+ * programmed at the base of the NVS sector, so that the firmware boots
+ * straight into it. One instruction per line, moves either as CSV or
+ * G-code-like:
+ *   <rpm>, <degrees>
+ *   G1 A<degrees> F<rpm>
+ *   REPEAT <count> <length> | CALL <target> | RET | DWELL <ms> | WAIT
+ * Degrees take the keyboard format (sign, up to three integer digits and one
+ * decimal), the direction being CW iff negative; speeds take up to three
+ * decimals. Targets are instruction positions, from 0 (see MotionVM.hpp).
+ * Text following '#' or ';' is ignored.
+ * The moves are converted as the keyboard input is, committed as a single
+ * batch over the emulated flash, and checked by reloading the pattern and
+ * running the program for a while, both mirrored in RAM and flash resident,
+ * which must agree on every action. The whole sector is then dumped, as the
+ * format word the firmware checks at boot is programmed at its end.
+ *
+ * usage: mp_compile <input> <image.bin>
+ */
+
+#include "FlashSim.h"
+#include "MotionConfig.hpp"
+#include "MotionPattern.hpp"
+#include "MotionVM.hpp"
+
+#include <cctype>
+#include <cinttypes>
+#include <cstring>
+#include <strings.h>
+#include <vector>
+
+namespace {
+
+constexpr auto Sector = flash::Sector::S7;
+using Pattern = MotionPattern<motion::NMAX_SEGMENTS>;
+/* Same layout, played back from flash */
+using ResidentPattern = MotionPattern<motion::NMAX_SEGMENTS, true>;
+using Segment = Pattern::MotionSegment;
+
+/* Actions the program must run through without halting */
+constexpr size_t Dry_Run_Actions = 64 * Pattern::max_size();
+
+enum class Parse { BLANK, OK, ERROR };
+
+struct Mnemonic {
+  const char *name;
+  Pattern::Opcode op;
+  int nargs;
+};
+
+constexpr Mnemonic Mnemonics[] = {{"REPEAT", Pattern::REPEAT, 2},
+                                  {"CALL", Pattern::CALL, 1},
+                                  {"RET", Pattern::RET, 0},
+                                  {"DWELL", Pattern::DWELL, 1},
+                                  {"WAIT", Pattern::WAIT, 0}};
+
+/* Signed fixed point number, scaled by 10^max_frac. Advances p past it */
+bool parseFixed(const char *&p, int max_int, int max_frac, bool &neg,
+                int &val) {
+  neg = (*p == '-');
+  if (*p == '+' || *p == '-') ++p;
+
+  int n = 0;
+  for (val = 0; isdigit(*p); ++p, ++n) val = val * 10 + (*p - '0');
+  if (!n || n > max_int) return false;
+
+  n = 0;
+  if (*p == '.')
+    for (++p; isdigit(*p); ++p, ++n) val = val * 10 + (*p - '0');
+  if (n > max_frac) return false;
+
+  for (; n < max_frac; ++n) val *= 10;
+  return true;
+}
+
+const char *skipBlanks(const char *p) { return p + strspn(p, " \t"); }
+
+Parse parseControl(const char *p, Segment &ms, const char *&err) {
+  const auto len = strcspn(p, " \t");
+
+  for (const auto &m : Mnemonics) {
+    if (strlen(m.name) != len || strncasecmp(p, m.name, len)) continue;
+
+    unsigned long args[2] = {};
+    p += len;
+    for (int i = 0; i < m.nargs; ++i) {
+      char *end;
+      p = skipBlanks(p);
+      args[i] = strtoul(p, &end, 10);
+      if (!isdigit(*p) || (*end && !isblank(*end))) {
+        err = "expected unsigned operands";
+        return Parse::ERROR;
+      }
+      p = end;
+    }
+
+    if (*skipBlanks(p)) {
+      err = "too many operands";
+      return Parse::ERROR;
+    }
+
+    const auto a = m.op == Pattern::REPEAT || m.op == Pattern::DWELL
+                       ? args[0] : 0;
+    const auto b = m.op == Pattern::REPEAT ? args[1]
+                   : m.op == Pattern::CALL ? args[0] : 0;
+
+    if (a > std::numeric_limits<BStepper::SpeedType>::max() ||
+        b > std::numeric_limits<BStepper::StepCountType>::max()) {
+      err = "operand out of range";
+      return Parse::ERROR;
+    }
+
+    ms = {static_cast<BStepper::SpeedType>(a),
+          static_cast<BStepper::StepCountType>(b), BStepper::CCW, m.op};
+    return Parse::OK;
+  }
+
+  err = "unknown instruction";
+  return Parse::ERROR;
+}
+
+Parse parseLine(char *line, Segment &ms, const char *&err) {
+  line[strcspn(line, "#;\r\n")] = '\0';
+  const char *p = skipBlanks(line);
+  if (!*p) return Parse::BLANK;
+
+  if (isalpha(*p) && toupper(*p) != 'G') return parseControl(p, ms, err);
+
+  int milli_rpm, angle_x10;
+  bool rpm_neg, angle_neg;
+
+  if (toupper(*p) == 'G') {
+    char *end;
+    if (strtol(p + 1, &end, 10) != 1 || end == p + 1) {
+      err = "only G1 moves are supported";
+      return Parse::ERROR;
+    }
+
+    bool has_a = false, has_f = false;
+    for (p = skipBlanks(end); *p; p = skipBlanks(p)) {
+      const auto word = toupper(*p++);
+      bool ok = false;
+
+      if (word == 'A' && !has_a)
+        ok = has_a = parseFixed(p, 3, 1, angle_neg, angle_x10);
+      else if (word == 'F' && !has_f)
+        ok = has_f = parseFixed(p, 3, 3, rpm_neg, milli_rpm);
+
+      if (!ok || (*p && !isblank(*p))) {
+        err = "expected A<degrees> and F<rpm> words";
+        return Parse::ERROR;
+      }
+    }
+
+    if (!has_a || !has_f) {
+      err = "expected A<degrees> and F<rpm> words";
+      return Parse::ERROR;
+    }
+
+  } else {
+    if (!parseFixed(p, 3, 3, rpm_neg, milli_rpm) ||
+        *(p = skipBlanks(p)) != ',' ||
+        !parseFixed(p = skipBlanks(p + 1), 3, 1, angle_neg, angle_x10) ||
+        *skipBlanks(p)) {
+      err = "expected <rpm>, <degrees>";
+      return Parse::ERROR;
+    }
+  }
+
+  if (rpm_neg || milli_rpm < motion::MILLI_RPM_MIN ||
+      milli_rpm > motion::MILLI_RPM_MAX) {
+    err = "speed out of range";
+    return Parse::ERROR;
+  }
+
+  /* Same conversions as the keyboard input */
+  ms.milli_rev_per_minute = milli_rpm;
+  ms.steps = motion::stepsFromAngle(angle_x10);
+  ms.direction = angle_neg ? BStepper::CW : BStepper::CCW;
+
+  if (!ms.steps) {
+    err = "displacement rounds to zero steps";
+    return Parse::ERROR;
+  }
+  return Parse::OK;
+}
+
+bool read(const char *path, std::vector<Segment> &segs) {
+  FILE *in = fopen(path, "r");
+  if (!in) {
+    perror(path);
+    return false;
+  }
+
+  char line[128];
+  unsigned lineno = 0;
+  bool ok = true;
+
+  while (fgets(line, sizeof(line), in)) {
+    ++lineno;
+
+    if (!strchr(line, '\n') && !feof(in)) {
+      fprintf(stderr, "%s:%u: line too long\n", path, lineno);
+      ok = false;
+      break;
+    }
+
+    Segment ms;
+    const char *err;
+    switch (parseLine(line, ms, err)) {
+    case Parse::BLANK:
+      break;
+    case Parse::OK:
+      segs.push_back(ms);
+      break;
+    case Parse::ERROR:
+      fprintf(stderr, "%s:%u: %s\n", path, lineno, err);
+      ok = false;
+      break;
+    }
+  }
+
+  fclose(in);
+  return ok;
+}
+
+bool matches(const Pattern &mp, const std::vector<Segment> &segs) {
+  if (mp.size() != segs.size()) return false;
+
+  for (size_t i = 0; i < segs.size(); ++i)
+    if (mp[i].milli_rev_per_minute != segs[i].milli_rev_per_minute ||
+        mp[i].steps != segs[i].steps || mp[i].direction != segs[i].direction ||
+        mp[i].op != segs[i].op)
+      return false;
+  return true;
+}
+
+/* Both patterns must run through the same actions, without halting */
+bool dryRun(const Pattern &mp, const ResidentPattern &fmp) {
+  MotionVM vm(mp);
+  MotionVM fvm(fmp);
+
+  for (size_t i = 0; i < Dry_Run_Actions; ++i) {
+    const auto a = vm.next();
+    const auto fa = fvm.next();
+
+    if (a.kind == decltype(vm)::HALT) {
+      fprintf(stderr, "The program halts within %zu actions\n",
+              Dry_Run_Actions);
+      return false;
+    }
+
+    /* The action kinds of the two machines are distinct types */
+    if (+fa.kind != +a.kind || fa.ms != a.ms || fvm.pc() != vm.pc() ||
+        (a.plan && a.plan->steps != fa.plan->steps)) {
+      fprintf(stderr, "Flash resident playback diverges at action %zu\n", i);
+      return false;
+    }
+  }
+  return true;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  if (argc != 3) {
+    fprintf(stderr, "usage: %s <input> <image.bin>\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  std::vector<Segment> segs;
+  if (!read(argv[1], segs)) return EXIT_FAILURE;
+
+  if (segs.empty() || segs.size() > Pattern::max_size()) {
+    fprintf(stderr, "%s: %zu segments, expected 1 to %zu\n", argv[1],
+            segs.size(), Pattern::max_size());
+    return EXIT_FAILURE;
+  }
+
+  if (!flash::sim::init()) {
+    fprintf(stderr, "Failed mapping the flash array at 0x%08" PRIxPTR "\n",
+            flash::sim::Base_Addr);
+    return EXIT_FAILURE;
+  }
+
+  /* Program the pattern as the firmware would, then reboot into it */
+  const BStepper stepper;
+  {
+    Pattern mp(Sector, stepper);
+
+    bool ok = mp.beginBatch();
+    for (const auto &ms : segs) ok = ok && mp.append(ms);
+
+    if (!ok || !mp.commit()) {
+      fprintf(stderr, "Failed programming the pattern\n");
+      return EXIT_FAILURE;
+    }
+  }
+
+  flash::sim::reset();
+  if (const Pattern mp(Sector, stepper); !matches(mp, segs)) {
+    fprintf(stderr, "The pattern did not survive the reboot\n");
+    return EXIT_FAILURE;
+  } else if (const ResidentPattern fmp(Sector, stepper); !dryRun(mp, fmp)) {
+    return EXIT_FAILURE;
+  }
+
+  for (size_t i = 0; i < segs.size(); ++i) {
+    const auto &ms = segs[i];
+    const auto angle_x10 = motion::angleFromSteps(ms.steps);
+
+    printf("[%zu] ", i);
+    switch (ms.op) {
+    case Pattern::MOVE:
+      printf("%3" PRIu32 ".%03" PRIu32 " rpm %c%d.%01d deg (%u steps)\n",
+             ms.milli_rev_per_minute / 1000, ms.milli_rev_per_minute % 1000,
+             ms.direction == BStepper::CCW ? '+' : '-', angle_x10 / 10,
+             angle_x10 % 10, ms.steps);
+      break;
+    case Pattern::REPEAT:
+      printf("REPEAT %" PRIu32 " %u\n", ms.milli_rev_per_minute, ms.steps);
+      break;
+    case Pattern::CALL:
+      printf("CALL %u\n", ms.steps);
+      break;
+    case Pattern::DWELL:
+      printf("DWELL %" PRIu32 " ms\n", ms.milli_rev_per_minute);
+      break;
+    default:
+      printf("%s\n", ms.op == Pattern::RET ? "RET" : "WAIT");
+      break;
+    }
+  }
+
+  const auto *base =
+      reinterpret_cast<const uint8_t *>(flash::getBaseAddr(Sector));
+  const size_t size = flash::getSize(Sector);
+
+  FILE *out = fopen(argv[2], "wb");
+  if (!out) {
+    perror(argv[2]);
+    return EXIT_FAILURE;
+  }
+
+  const bool written = fwrite(base, 1, size, out) == size;
+  if (fclose(out) || !written) {
+    perror(argv[2]);
+    return EXIT_FAILURE;
+  }
+
+  printf("%s: %zu bytes, to be programmed at 0x%08" PRIxPTR "\n", argv[2],
+         size, flash::getBaseAddr(Sector));
+  return EXIT_SUCCESS;
+}
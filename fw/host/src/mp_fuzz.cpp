@@ -0,0 +1,435 @@
+/**
+ * @file     mp_fuzz.cpp
+ * @author   Fabio Scatozza <s315216@studenti.polito.it>
+ * @date     18.10.2026
+ *
+ * Drives random pushBack/batch/replace/erase/clear/reboot sequences on
+ * MotionPattern over the emulated flash, with power cuts injected at random
+ * program/erase steps.
+ * After every reboot the loaded pattern is checked against a reference model:
+ * an interrupted operation must be either fully applied or not at all. Both
+ * the RAM-mirrored and the flash-resident ('f') patterns are exercised. A
+ * sector written before the layout was versioned must be rejected at boot,
+ * control instructions with operands out of range must not be stored, and
+ * a skipped loop must not escape the enclosing one.
+ *
+ * usage: mp_fuzz [iterations] [seed]
+ */
+
+#include "FlashSim.h"
+#include "MotionPattern.hpp"
+#include "MotionVM.hpp"
+
+#include <chrono>
+#include <cinttypes>
+#include <iterator>
+#include <optional>
+#include <random>
+#include <vector>
+
+namespace {
+
+constexpr auto Sector = flash::Sector::S7;
+
+/* Mean and maximum of a latency */
+struct Latency {
+  uint64_t n = 0;
+  uint64_t sum = 0;
+  uint64_t max = 0;
+
+  void add(uint64_t t) {
+    ++n;
+    sum += t;
+    max = std::max(max, t);
+  }
+  uint64_t mean() const { return n ? sum / n : 0; }
+};
+
+struct Report {
+  Latency commit_us;   /* pushBack, virtual time */
+  Latency batch_us;    /* beginBatch to commit, virtual time */
+  Latency edit_us;     /* replace and erase, virtual time */
+  Latency clear_us;    /* clear, virtual time */
+  Latency boot_us;     /* constructor, virtual time */
+  Latency boot_ns;     /* constructor, host time */
+  uint64_t cuts = 0;
+  uint64_t failures = 0;
+};
+
+enum class Action { PUSH, BATCH, REPLACE, ERASE, CLEAR, REBOOT };
+
+template <size_t N, bool FLASH_RESIDENT>
+class Fuzzer {
+public:
+  using Pattern = MotionPattern<N, FLASH_RESIDENT>;
+  using Segment = typename Pattern::MotionSegment;
+  using Model = std::vector<Segment>;
+
+  explicit Fuzzer(uint64_t seed) : _rng(seed) {}
+
+  Report run(uint64_t iterations) {
+    boot({_model});
+
+    for (uint64_t i = 0; i < iterations && !_r.failures; ++i) {
+      const auto a = pickAction();
+      const auto seg = randomSegment();
+      const auto batch = randomBatch();
+      const auto pos = std::uniform_int_distribution<size_t>(
+          0, std::max<size_t>(_model.size(), 1) - 1)(_rng);
+
+      /* Arm a power cut on one of the next few flash steps */
+      if (std::bernoulli_distribution(0.25)(_rng))
+        flash::sim::armPowerCut(
+            std::uniform_int_distribution<uint64_t>(1, 6)(_rng));
+
+      try {
+        const auto t0 = flash::sim::now_us();
+
+        switch (a) {
+        case Action::PUSH:
+          if (_mp->pushBack(seg)) {
+            _r.commit_us.add(flash::sim::now_us() - t0);
+            _model.push_back(seg);
+          } else if (!_mp->full()) {
+            fail("pushBack() failed with free slots");
+          }
+          break;
+        case Action::BATCH:
+          if (runBatch(batch)) {
+            _r.batch_us.add(flash::sim::now_us() - t0);
+            _model.insert(_model.end(), batch.begin(), batch.end());
+          }
+          break;
+        case Action::REPLACE:
+          if (pos >= _model.size()) break;
+          /* Needs two slots: it may fail one short of full() */
+          if (!_mp->replace(pos, seg)) break;
+          _r.edit_us.add(flash::sim::now_us() - t0);
+          _model[pos] = seg;
+          break;
+        case Action::ERASE:
+          if (pos >= _model.size()) break;
+          if (!_mp->erase(pos)) {
+            if (!_mp->full()) fail("erase() failed with free slots");
+            break;
+          }
+          _r.edit_us.add(flash::sim::now_us() - t0);
+          _model.erase(_model.begin() + pos);
+          break;
+        case Action::CLEAR:
+          _mp->clear();
+          _r.clear_us.add(flash::sim::now_us() - t0);
+          _model.clear();
+          break;
+        case Action::REBOOT:
+          break;
+        }
+
+        check(*_mp, _model);
+
+        /* The boot may erase the sector: leave the cut armed for it */
+        if (a == Action::REBOOT) boot({_model});
+        flash::sim::armPowerCut(0);
+
+      } catch (const flash::sim::PowerCut &) {
+        ++_r.cuts;
+
+        /* The interrupted operation may or may not have taken effect */
+        Model applied = _model;
+        if (a == Action::PUSH) applied.push_back(seg);
+        if (a == Action::BATCH)
+          applied.insert(applied.end(), batch.begin(), batch.end());
+        if (a == Action::REPLACE && pos < applied.size()) applied[pos] = seg;
+        if (a == Action::ERASE && pos < applied.size())
+          applied.erase(applied.begin() + pos);
+        if (a == Action::CLEAR) applied.clear();
+
+        boot({_model, applied});
+      }
+    }
+
+    if (flash::sim::stats().violations)
+      fail("%" PRIu64 " programs attempted 0 -> 1 transitions",
+           flash::sim::stats().violations);
+
+    return _r;
+  }
+
+private:
+  Action pickAction() {
+    const auto p = std::uniform_int_distribution<int>(0, 99)(_rng);
+    if (p < 35) return Action::PUSH;
+    if (p < 45) return Action::BATCH;
+    if (p < 60) return Action::REPLACE;
+    if (p < 70) return Action::ERASE;
+    if (p < 85) return Action::CLEAR;
+    return Action::REBOOT;
+  }
+
+  Segment randomSegment() {
+    return {
+        std::uniform_int_distribution<BStepper::SpeedType>(2'500,
+                                                           400'000)(_rng),
+        std::uniform_int_distribution<BStepper::StepCountType>(1,
+                                                               0xFFFF)(_rng),
+        std::bernoulli_distribution(0.5)(_rng) ? BStepper::CW : BStepper::CCW};
+  }
+
+  Model randomBatch() {
+    Model b(std::uniform_int_distribution<size_t>(1, 4)(_rng));
+    for (auto &seg : b) seg = randomSegment();
+    return b;
+  }
+
+  /* A batch that does not fit is aborted, and must leave no trace */
+  bool runBatch(const Model &b) {
+    if (!_mp->beginBatch()) {
+      fail("beginBatch() failed");
+      return false;
+    }
+
+    for (const auto &seg : b) {
+      if (!_mp->append(seg)) {
+        if (_model.size() + b.size() <= Pattern::max_size() && !_mp->full())
+          fail("append() failed with free slots");
+        return false;
+      }
+    }
+
+    if (!_mp->commit()) {
+      fail("commit() failed");
+      return false;
+    }
+    return true;
+  }
+
+  /* Reboot, retrying while power cuts hit the boot itself. The loaded pattern
+   * must match one of the candidates, which becomes the model */
+  void boot(std::initializer_list<Model> candidates) {
+    for (;;) {
+      _mp.reset();
+      flash::sim::reset();
+
+      try {
+        const auto t0_us = flash::sim::now_us();
+        const auto t0 = std::chrono::steady_clock::now();
+
+        _mp.emplace(Sector, _stepper);
+
+        _r.boot_ns.add(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                           std::chrono::steady_clock::now() - t0)
+                           .count());
+        _r.boot_us.add(flash::sim::now_us() - t0_us);
+        break;
+      } catch (const flash::sim::PowerCut &) {
+        ++_r.cuts;
+      }
+    }
+    flash::sim::armPowerCut(0);
+
+    for (const auto &m : candidates) {
+      if (matches(*_mp, m)) {
+        _model = m;
+        return;
+      }
+    }
+    fail("Inconsistent pattern after reboot: %zu segments, expected %zu or %zu",
+         _mp->size(), candidates.begin()->size(),
+         (candidates.end() - 1)->size());
+  }
+
+  void check(const Pattern &mp, const Model &m) {
+    if (!matches(mp, m))
+      fail("Pattern diverged from model: %zu segments, expected %zu",
+           mp.size(), m.size());
+  }
+
+  static bool matches(const Pattern &mp, const Model &m) {
+    if (mp.size() != m.size() ||
+        static_cast<size_t>(std::distance(mp.begin(), mp.end())) != m.size())
+      return false;
+
+    size_t i = 0;
+    for (const auto &ms : mp) {
+      if (ms.milli_rev_per_minute != m[i].milli_rev_per_minute ||
+          ms.steps != m[i].steps || ms.direction != m[i].direction ||
+          mp[i].steps != m[i].steps || mp.plan(i).steps != m[i].steps)
+        return false;
+      ++i;
+    }
+    return true;
+  }
+
+  template <typename... Args>
+  void fail(const char *fmt, Args... args) {
+    ++_r.failures;
+    fprintf(stderr, "N = %zu%s: ", N, FLASH_RESIDENT ? "f" : "");
+    fprintf(stderr, fmt, args...);
+    fprintf(stderr, "\n");
+  }
+
+  std::mt19937_64 _rng;
+  BStepper _stepper;
+  std::optional<Pattern> _mp;
+  Model _model;
+  Report _r;
+};
+
+template <size_t N, bool FLASH_RESIDENT = false>
+bool fuzz(uint64_t iterations, uint64_t seed) {
+  if (!flash::sim::init(seed)) {
+    fprintf(stderr, "Failed mapping the flash array at 0x%08" PRIxPTR "\n",
+            flash::sim::Base_Addr);
+    return false;
+  }
+
+  const auto r = Fuzzer<N, FLASH_RESIDENT>(seed).run(iterations);
+  const auto &s = flash::sim::stats();
+
+  printf("%3zu%c %9" PRIu64 " %7" PRIu64 " %6" PRIu64 " | %6" PRIu64
+         " %6" PRIu64 " | %6" PRIu64 " %6" PRIu64 " | %6" PRIu64 " %6" PRIu64
+         " | %8" PRIu64 " %8" PRIu64
+         " | %8" PRIu64 " %8" PRIu64 " | %7" PRIu64 " %8" PRIu64 "\n",
+         N, FLASH_RESIDENT ? 'f' : ' ', s.programs, s.erases, r.cuts,
+         r.commit_us.mean(), r.commit_us.max,
+         r.batch_us.mean(), r.batch_us.max, r.edit_us.mean(), r.edit_us.max,
+         r.clear_us.mean(), r.clear_us.max,
+         r.boot_us.mean(), r.boot_us.max, r.boot_ns.mean(), r.boot_ns.max);
+
+  return !r.failures;
+}
+
+/* A sector holding an unversioned layout must be rejected, not misread */
+bool checkFormat(uint64_t seed) {
+  using Pattern = MotionPattern<8>;
+  const BStepper stepper;
+
+  if (!flash::sim::init(seed)) return false;
+
+  /* Committed segments, as written before the layout was versioned */
+  const auto base = flash::getBaseAddr(Sector);
+  flash::unlock();
+  flash::setOperation(flash::Op::PG);
+  flash::setParallelism(flash::PSize::x32);
+  /* Past the chunk attribute, left erased */
+  for (uintptr_t a = base + 4; a < base + 68; a += 8) {
+    flash::programAt(a, 10'000, 4);
+    flash::programAt(a + 4, 0xAA00'0064U, 4);
+  }
+  flash::lock();
+
+  bool ok = true;
+  {
+    Pattern mp(Sector, stepper);
+    ok = mp.empty() && mp.pushBack(10'000, 100, BStepper::CW);
+  }
+
+  flash::sim::reset();
+  if (const Pattern mp(Sector, stepper); !ok || mp.size() != 1) {
+    fprintf(stderr, "Unversioned sector not rejected\n");
+    return false;
+  }
+  return true;
+}
+
+/* Control instructions are stored only with operands in range */
+bool checkOperands(uint64_t seed) {
+  using Pattern = MotionPattern<8>;
+  using Segment = Pattern::MotionSegment;
+  const BStepper stepper;
+
+  if (!flash::sim::init(seed)) return false;
+  Pattern mp(Sector, stepper);
+
+  const struct {
+    Segment ms;
+    bool valid;
+  } cases[] = {
+      {{3, 6, BStepper::CCW, Pattern::REPEAT}, true},  /* body 1..6 */
+      {{3, 7, BStepper::CCW, Pattern::REPEAT}, false}, /* past the end */
+      {{0, 7, BStepper::CCW, Pattern::CALL}, true},
+      {{0, 8, BStepper::CCW, Pattern::CALL}, false},
+      {{1, 7, BStepper::CCW, Pattern::CALL}, false},
+      {{50, 0, BStepper::CCW, Pattern::DWELL}, true},
+      {{50, 1, BStepper::CCW, Pattern::DWELL}, false},
+      {{0, 0, BStepper::CCW, Pattern::RET}, true},
+      {{0, 2, BStepper::CCW, Pattern::WAIT}, false},
+      {{0, 0, BStepper::CCW, Pattern::N_OPCODES}, false},
+  };
+
+  bool ok = true;
+  for (const auto &c : cases) {
+    if (static_cast<bool>(mp.pushBack(c.ms)) != c.valid) {
+      fprintf(stderr, "Opcode %u with operands %" PRIu32 ", %u %s\n",
+              c.ms.op, c.ms.milli_rev_per_minute, c.ms.steps,
+              c.valid ? "rejected" : "accepted");
+      ok = false;
+    }
+  }
+  return ok;
+}
+
+/*
+ * An empty loop is skipped within the enclosing body, and halts the program
+ * if it extends past it, which compile() cannot tell
+ */
+bool checkNesting(uint64_t seed) {
+  using Pattern = MotionPattern<8>;
+  using Segment = Pattern::MotionSegment;
+  const BStepper stepper;
+
+  if (!flash::sim::init(seed)) return false;
+
+  const Segment move{10'000, 100, BStepper::CW};
+  const struct {
+    uint16_t inner; /* Body of the empty loop, within a body of 2 */
+    size_t pc;      /* After the first action, 0 if HALT */
+  } cases[] = {{1, 4}, {2, 0}};
+
+  bool ok = true;
+  for (const auto &c : cases) {
+    Pattern mp(Sector, stepper);
+    mp.clear();
+    mp.pushBack({2, 2, BStepper::CCW, Pattern::REPEAT});
+    mp.pushBack({0, c.inner, BStepper::CCW, Pattern::REPEAT});
+    for (int i = 0; i < 3; ++i) mp.pushBack(move);
+
+    MotionVM vm(mp);
+    const auto action = vm.next();
+    const auto pc = action.kind == MotionVM<Pattern>::HALT ? 0 : vm.pc();
+    if (mp.size() != 5 || pc != c.pc) {
+      fprintf(stderr, "Empty loop of %u in a body of 2: pc %zu, not %zu\n",
+              c.inner, pc, c.pc);
+      ok = false;
+    }
+  }
+  return ok;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  const uint64_t iterations =
+      argc > 1 ? strtoull(argv[1], nullptr, 0) : 100'000;
+  const uint64_t seed = argc > 2 ? strtoull(argv[2], nullptr, 0) : 1;
+
+  printf("%4s %9s %7s %6s | %13s | %13s | %13s | %17s | %17s | %16s\n", "",
+         "", "", "", "commit [us]", "batch [us]", "edit [us]", "clear [us]",
+         "boot [us]", "boot, host [ns]");
+  printf("%4s %9s %7s %6s | %6s %6s | %6s %6s | %6s %6s | %8s %8s | %8s %8s |"
+         " %7s %8s\n",
+         "N", "programs", "erases", "cuts", "mean", "max", "mean", "max",
+         "mean", "max", "mean", "max", "mean", "max", "mean", "max");
+
+  bool ok = checkFormat(seed);
+  ok &= checkOperands(seed);
+  ok &= checkNesting(seed);
+  ok &= fuzz<1>(iterations, seed);
+  ok &= fuzz<4>(iterations, seed);
+  ok &= fuzz<8>(iterations, seed);
+  ok &= fuzz<32>(iterations, seed);
+  ok &= fuzz<8, true>(iterations, seed);
+  ok &= fuzz<256, true>(iterations, seed);
+
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,237 @@
+/**
+ * @file     tim_sim.cpp
+ * @author   Fabio Scatozza <s315216@studenti.polito.it>
+ * @date     18.10.2026
+ *
+ * Host implementation of the emulated timers, over the core emulator
+ */
+
+#include "TimSim.h"
+#include "stm32f4xx.h"
+#include "tim.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace {
+
+using Clock = core::sim::Clock;
+
+constexpr size_t N_CHANNELS = 4;
+constexpr uint32_t SR_CC = TIM_SR_CC1IF * ((1U << N_CHANNELS) - 1);
+constexpr uint32_t EGR_CC = TIM_EGR_CC1G * ((1U << N_CHANNELS) - 1);
+
+struct Timer {
+  uintptr_t base;
+  bool attached;
+  uint32_t max;          /* Counter width */
+  uint32_t psc;          /* Active prescaler, loaded at the update event */
+  Clock::time_point t0;  /* Counting since */
+  uint64_t done;         /* Ticks since t0, applied to CNT */
+};
+
+Timer timers_[] = {{TIM2_BASE}, {TIM3_BASE},  {TIM4_BASE},  {TIM5_BASE},
+                   {TIM1_BASE}, {TIM9_BASE},  {TIM10_BASE}, {TIM11_BASE}};
+
+uint32_t &reg(const Timer &t, size_t offset) {
+  return *reinterpret_cast<uint32_t *>(t.base + offset);
+}
+
+Timer &find(const uint32_t *addr) {
+  const auto a = reinterpret_cast<uintptr_t>(addr);
+  const auto it = std::find_if(std::begin(timers_), std::end(timers_),
+                               [a](const Timer &t) {
+                                 return t.attached && a >= t.base &&
+                                        a < t.base + sizeof(TIM_TypeDef);
+                               });
+  if (it == std::end(timers_)) {
+    fprintf(stderr, "tim::sim: %p is not an attached timer\n", addr);
+    abort();
+  }
+  return *it;
+}
+
+/* Host time of the tick since t0, at the prescaled clock */
+Clock::time_point timeOf(const Timer &t, uint64_t ticks) {
+  const auto ns = (static_cast<unsigned __int128>(ticks) * (t.psc + 1ULL) *
+                       1'000'000'000U +
+                   SystemCoreClock - 1) /
+                  SystemCoreClock;
+  return t.t0 + std::chrono::nanoseconds(static_cast<int64_t>(ns));
+}
+
+void restart(Timer &t) {
+  t.t0 = Clock::now();
+  t.done = 0;
+}
+
+/* Ticks from CNT to the match of CCRx, within a period */
+uint64_t toMatch(const Timer &t, size_t ch) {
+  const uint64_t period = uint64_t{reg(t, offsetof(TIM_TypeDef, ARR))} + 1;
+  const uint64_t cnt = reg(t, offsetof(TIM_TypeDef, CNT));
+  const uint64_t ccr = reg(t, tim::ccrAddr(0, ch)) & t.max;
+
+  if (ccr >= period) return std::numeric_limits<uint64_t>::max();
+  return ccr > cnt ? ccr - cnt : ccr + period - cnt;
+}
+
+/* Bring CNT and the flags up to date */
+void sync(Timer &t) {
+  auto &cnt = reg(t, offsetof(TIM_TypeDef, CNT));
+  auto &sr = reg(t, offsetof(TIM_TypeDef, SR));
+
+  if (!(reg(t, offsetof(TIM_TypeDef, CR1)) & TIM_CR1_CEN)) {
+    restart(t);
+    return;
+  }
+
+  const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                      Clock::now() - t.t0)
+                      .count();
+  const uint64_t total = static_cast<unsigned __int128>(ns) * SystemCoreClock /
+                         ((t.psc + 1ULL) * 1'000'000'000U);
+  const auto n = total - t.done;
+  if (!n) return;
+  t.done = total;
+
+  for (size_t ch = 0; ch < N_CHANNELS; ++ch)
+    if (toMatch(t, ch) <= n) sr |= TIM_SR_CC1IF << ch;
+
+  const uint64_t period = uint64_t{reg(t, offsetof(TIM_TypeDef, ARR))} + 1;
+  if (n >= period - cnt) sr |= TIM_SR_UIF;
+  cnt = (cnt + n) % period;
+}
+
+void isr(void *ctx);
+
+/* Interrupt line, and the host timer up to the next interrupting flag */
+void update(Timer &t) {
+  const auto sr = reg(t, offsetof(TIM_TypeDef, SR));
+  const auto dier = reg(t, offsetof(TIM_TypeDef, DIER));
+  const auto irqn = tim::getIRQn(t.base);
+
+  core::sim::setIrqLevel(irqn, sr & dier & (TIM_SR_UIF | SR_CC));
+
+  auto next = std::numeric_limits<uint64_t>::max();
+  if (reg(t, offsetof(TIM_TypeDef, CR1)) & TIM_CR1_CEN) {
+    if ((dier & TIM_DIER_UIE) && !(sr & TIM_SR_UIF)) {
+      next = uint64_t{reg(t, offsetof(TIM_TypeDef, ARR))} + 1 -
+             reg(t, offsetof(TIM_TypeDef, CNT));
+    }
+    for (size_t ch = 0; ch < N_CHANNELS; ++ch) {
+      if ((dier & (TIM_DIER_CC1IE << ch)) && !(sr & (TIM_SR_CC1IF << ch)))
+        next = std::min(next, toMatch(t, ch));
+    }
+  }
+
+  if (next == std::numeric_limits<uint64_t>::max())
+    core::sim::clearTimer(&t);
+  else
+    core::sim::setTimer(timeOf(t, t.done + next), isr, &t);
+}
+
+void isr(void *ctx) {
+  auto &t = *static_cast<Timer *>(ctx);
+  sync(t);
+  update(t);
+}
+
+} // namespace
+
+namespace tim::sim {
+
+uint32_t read(const uint32_t *addr) {
+  auto &t = find(addr);
+  sync(t);
+  update(t);
+  return *addr;
+}
+
+void write(uint32_t *addr, uint32_t value) {
+  auto &t = find(addr);
+  sync(t);
+
+  switch (reinterpret_cast<uintptr_t>(addr) - t.base) {
+    case offsetof(TIM_TypeDef, SR):
+      *addr &= value;
+      break;
+
+    case offsetof(TIM_TypeDef, EGR):
+      if (value & TIM_EGR_UG) {
+        t.psc = reg(t, offsetof(TIM_TypeDef, PSC));
+        reg(t, offsetof(TIM_TypeDef, CNT)) = 0;
+        restart(t);
+        if (!(reg(t, offsetof(TIM_TypeDef, CR1)) & TIM_CR1_URS))
+          reg(t, offsetof(TIM_TypeDef, SR)) |= TIM_SR_UIF;
+      }
+      reg(t, offsetof(TIM_TypeDef, SR)) |= value & EGR_CC;
+      break;
+
+    case offsetof(TIM_TypeDef, CR1):
+      if (!(*addr & TIM_CR1_CEN)) restart(t);
+      *addr = value;
+      break;
+
+    case offsetof(TIM_TypeDef, CNT):
+      *addr = value & t.max;
+      restart(t);
+      break;
+
+    case offsetof(TIM_TypeDef, PSC):
+      *addr = value & 0xFFFF;
+      break;
+
+    case offsetof(TIM_TypeDef, ARR):
+      *addr = value & t.max;
+      break;
+
+    default:
+      *addr = value;
+  }
+
+  update(t);
+}
+
+void attach(uintptr_t base) {
+  const auto it =
+      std::find_if(std::begin(timers_), std::end(timers_),
+                   [base](const Timer &t) { return t.base == base; });
+  if (it == std::end(timers_)) {
+    fprintf(stderr, "tim::sim: no timer at %#lx\n", base);
+    abort();
+  }
+
+  /* The instances of a bus share pages */
+  const auto page_size = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+  const auto page = base & ~(page_size - 1);
+  const auto map = mmap(reinterpret_cast<void *>(page), page_size,
+                        PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1,
+                        0);
+  if (map != reinterpret_cast<void *>(page) &&
+      std::none_of(std::begin(timers_), std::end(timers_),
+                   [page, page_size](const Timer &t) {
+                     return t.attached && (t.base & ~(page_size - 1)) == page;
+                   })) {
+    fprintf(stderr, "tim::sim: can't map %#lx\n", page);
+    abort();
+  }
+
+  /* Reset state */
+  auto &t = *it;
+  t.max = tim::is32Bit(base) ? 0xFFFF'FFFFU : 0xFFFFU;
+  t.psc = 0;
+  std::fill_n(reinterpret_cast<uint32_t *>(base),
+              sizeof(TIM_TypeDef) / sizeof(uint32_t), 0);
+  reg(t, offsetof(TIM_TypeDef, ARR)) = t.max;
+  restart(t);
+  t.attached = true;
+}
+
+} // namespace tim::sim